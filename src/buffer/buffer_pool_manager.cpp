@@ -19,6 +19,7 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  StopPrefetch();
   delete[] pages_;
   delete replacer_;
 }
@@ -46,6 +47,16 @@ void BufferPoolManager::ChangePage(Page *page, page_id_t new_page_id, frame_id_t
   page->page_id_ = new_page_id;
 }
 
+std::unordered_map<page_id_t, frame_id_t>::iterator BufferPoolManager::FindPage(std::unique_lock<std::mutex> *lock,
+                                                                                page_id_t page_id) {
+  auto iter = page_table_.find(page_id);
+  while (iter != page_table_.end() && reading_frames_.count(iter->second) != 0) {
+    io_cv_.wait(*lock);
+    iter = page_table_.find(page_id);
+  }
+  return iter;
+}
+
 Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
@@ -55,17 +66,25 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   std::unique_lock<std::mutex> lock{latch_};
-  auto iter = page_table_.find(page_id);
-  if (iter != page_table_.end()) {
-    frame_id_t frame_id = iter->second;
-    Page *page = &pages_[frame_id];
-    replacer_->Pin(frame_id);
-    page->pin_count_++;
-    return page;
-  }
   frame_id_t frame_id = -1;
-  if (!Victim(&frame_id)) {
-    return nullptr;
+  while (true) {
+    auto iter = FindPage(&lock, page_id);
+    if (iter != page_table_.end()) {
+      frame_id = iter->second;
+      Page *page = &pages_[frame_id];
+      replacer_->Pin(frame_id);
+      page->pin_count_++;
+      return page;
+    }
+    if (Victim(&frame_id)) {
+      break;
+    }
+    if (reading_frames_.empty()) {
+      return nullptr;
+    }
+    // frames being read ahead become free once the read completes, the page
+    // may also have been read ahead meanwhile
+    io_cv_.wait(lock);
   }
   Page *page = &pages_[frame_id];
   ChangePage(page, page_id, frame_id);
@@ -101,7 +120,7 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
   std::unique_lock<std::mutex> lock{latch_};
 
-  auto iter = page_table_.find(page_id);
+  auto iter = FindPage(&lock, page_id);
   if (iter == page_table_.end()) {
     return false;
   }
@@ -120,8 +139,11 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   // 4.   Set the page ID output parameter. Return a pointer to P.
   std::unique_lock<std::mutex> lock{latch_};
   frame_id_t frame_id = -1;
-  if (!Victim(&frame_id)) {
-    return nullptr;
+  while (!Victim(&frame_id)) {
+    if (reading_frames_.empty()) {
+      return nullptr;
+    }
+    io_cv_.wait(lock);
   }
   *page_id = disk_manager_->AllocatePage();
   Page *page = &pages_[frame_id];
@@ -139,7 +161,7 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
   std::unique_lock<std::mutex> lock{latch_};
-  auto iter = page_table_.find(page_id);
+  auto iter = FindPage(&lock, page_id);
   if (iter == page_table_.end()) {
     return true;
   }
@@ -167,4 +189,81 @@ void BufferPoolManager::FlushAllPagesImpl() {
   }
 }
 
+void BufferPoolManager::PrefetchPage(page_id_t page_id, int depth, prefetch_next_fn next) {
+  if (page_id == INVALID_PAGE_ID || depth <= 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock{latch_};
+  if (prefetch_stop_ || page_table_.count(page_id) != 0 || prefetch_queue_.size() >= PREFETCH_QUEUE_SIZE) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new std::thread(&BufferPoolManager::RunPrefetch, this);
+  }
+  prefetch_queue_.push_back(PrefetchRequest{page_id, depth, next});
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::StopPrefetch() {
+  std::thread *prefetch_thread;
+  {
+    std::unique_lock<std::mutex> lock{latch_};
+    prefetch_stop_ = true;
+    prefetch_queue_.clear();
+    prefetch_thread = prefetch_thread_;
+    prefetch_thread_ = nullptr;
+  }
+  if (prefetch_thread != nullptr) {
+    prefetch_cv_.notify_all();
+    prefetch_thread->join();
+    delete prefetch_thread;
+  }
+}
+
+/*
+ * The frame is claimed and pinned under latch_, then read without it so
+ * FetchPage of other pages is not held up by the disk. Fetching the page
+ * being read waits on io_cv_ until its content is in place.
+ */
+void BufferPoolManager::RunPrefetch() {
+  std::unique_lock<std::mutex> lock{latch_};
+  while (true) {
+    prefetch_cv_.wait(lock, [&] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    auto request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    if (page_table_.count(request.page_id_) != 0) {
+      continue;
+    }
+    // leave most of the unpinned frames to the callers pinning pages
+    frame_id_t frame_id = -1;
+    if ((free_list_.empty() && replacer_->Size() <= pool_size_ / 4) || !Victim(&frame_id)) {
+      continue;
+    }
+    Page *page = &pages_[frame_id];
+    ChangePage(page, request.page_id_, frame_id);
+    replacer_->Pin(frame_id);
+    page->pin_count_ = 1;
+    reading_frames_.insert(frame_id);
+    lock.unlock();
+
+    disk_manager_->ReadPage(request.page_id_, page->data_);
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (request.depth_ > 1 && request.next_ != nullptr) {
+      next_page_id = request.next_(page->data_);
+    }
+
+    lock.lock();
+    reading_frames_.erase(frame_id);
+    page->pin_count_ = 0;
+    replacer_->Unpin(frame_id);
+    io_cv_.notify_all();
+    if (next_page_id != INVALID_PAGE_ID) {
+      prefetch_queue_.push_front(PrefetchRequest{next_page_id, request.depth_ - 1, request.next_});
+    }
+  }
+}
+
 }  // namespace bustub
\ No newline at end of file
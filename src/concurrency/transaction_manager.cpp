@@ -45,6 +45,9 @@ void TransactionManager::Commit(Transaction *txn) {
     if (item.wtype_ == WType::DELETE) {
       // Note that this also releases the lock when holding the page latch.
       table->ApplyDelete(item.rid_, txn);
+    } else if (item.wtype_ == WType::UPDATE) {
+      // The old version is gone for good, and so are its values in overflow pages.
+      table->ReleaseOverflowPages(item.tuple_);
     }
     write_set->pop_back();
   }
@@ -0,0 +1,320 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'ExtendibleHashTable' BufferPoolManager::NewPage FAIL!");
+  }
+  // a new page is zeroed, the directory starts with a global depth of 0
+  auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  dir_page->SetPageId(directory_page_id_);
+
+  page_id_t bucket_page_id;
+  if (buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'ExtendibleHashTable' BufferPoolManager::NewPage FAIL!");
+  }
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->RLatch();
+  bool found = reinterpret_cast<BucketPage *>(page->GetData())->GetValue(key, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+  bool inserted = bucket_page->Insert(key, value, comparator_);
+  bool full = !inserted && bucket_page->IsFull();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (full) {
+    return SplitInsert(transaction, key, value);
+  }
+  return inserted;
+}
+
+/*
+ * A split moves the pairs whose hash has the bit after the local depth set
+ * to a new bucket. All the pairs may end up on the same side, so the bucket
+ * of the key is split until it has room. No split separates a bucket full
+ * of pairs with the hash of the key, that insert fails right away.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    // the table latch keeps everybody else away from the buckets
+    Page *page = FetchBucketPage(bucket_page_id);
+    auto bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+    if (!bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+
+    bool same_hash = true;
+    uint32_t hash = Hash(key);
+    for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && same_hash; i++) {
+      same_hash = !bucket_page->IsReadable(i) || Hash(bucket_page->KeyAt(i)) == hash;
+    }
+    if (same_hash) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      table_latch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_RANGE, "more pairs share a hash than an extendible hash bucket holds");
+    }
+
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    page_id_t image_page_id = INVALID_PAGE_ID;
+    Page *image = nullptr;
+    if (local_depth < HASH_TABLE_DIRECTORY_MAX_DEPTH) {
+      image = buffer_pool_manager_->NewPage(&image_page_id);
+    }
+    if (image == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+      table_latch_.WUnlock();
+      if (local_depth == HASH_TABLE_DIRECTORY_MAX_DEPTH) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "extendible hash table directory is full");
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'SplitInsert' BufferPoolManager::NewPage FAIL!");
+    }
+    if (local_depth == dir_page->GetGlobalDepth()) {
+      dir_page->IncrGlobalDepth();
+    }
+
+    auto image_page = reinterpret_cast<BucketPage *>(image->GetData());
+    uint32_t split_bit = 1U << local_depth;
+    for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && bucket_page->IsOccupied(i); i++) {
+      if (bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & split_bit) != 0) {
+        image_page->Insert(bucket_page->KeyAt(i), bucket_page->ValueAt(i), comparator_);
+        bucket_page->RemoveAt(i);
+      }
+    }
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      if ((i & (split_bit - 1)) == (bucket_idx & (split_bit - 1))) {
+        dir_page->SetLocalDepth(i, local_depth + 1);
+        if ((i & split_bit) != 0) {
+          dir_page->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  bool empty = removed && bucket_page->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (empty) {
+    Merge(transaction, key);
+  }
+  return removed;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+/*
+ * A bucket can only be merged with a split image of the same local depth,
+ * then the merged bucket may in turn be merged with its own split image.
+ * The directory shrinks for as long as no bucket needs its last bit.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
+  bool merged = false;
+  while (true) {
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = dir_page->GetSplitImageIndex(bucket_idx);
+    if (dir_page->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    // another insert may have refilled the bucket in the meantime
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = dir_page->GetBucketPageId(image_idx);
+    bool bucket_empty = IsBucketEmpty(bucket_page_id);
+    if (!bucket_empty && !IsBucketEmpty(image_page_id)) {
+      break;
+    }
+
+    page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+    for (uint32_t i = 0; i < dir_page->Size(); i++) {
+      page_id_t page_id = dir_page->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        dir_page->SetBucketPageId(i, kept_page_id);
+        dir_page->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_empty ? bucket_page_id : image_page_id);
+    merged = true;
+  }
+  while (dir_page->CanShrink()) {
+    dir_page->DecrGlobalDepth();
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, merged);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  table_latch_.RLock();
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  dir_page->VerifyIntegrity();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::KeyToDirectoryIndex(const KeyType &key, HashTableDirectoryPage *dir_page) {
+  return Hash(key) & dir_page->GetGlobalDepthMask();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectoryPage() {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FetchDirectoryPage' BufferPoolManager::FetchPage FAIL!");
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::IsBucketEmpty(page_id_t bucket_page_id) {
+  Page *page = FetchBucketPage(bucket_page_id);
+  bool empty = reinterpret_cast<BucketPage *>(page->GetData())->IsEmpty();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  return empty;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FetchBucketPage' BufferPoolManager::FetchPage FAIL!");
+  }
+  return page;
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
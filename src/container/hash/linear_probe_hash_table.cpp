@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +27,137 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  header_page_id_ = CreateTable(num_buckets);
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  bool found = false;
+  ProbeSlots(header_page, hash_fn_.GetHash(key), false, false,
+             [&](BlockPage *block_page, size_t block_index, slot_offset_t offset) {
+               if (block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0) {
+                 result->push_back(block_page->ValueAt(offset));
+                 found = true;
+               }
+               return true;
+             });
+  buffer_pool_manager_->UnpinPage(header_page->GetPageId(), false);
+  table_latch_.RUnlock();
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
+/*
+ * A pair that is already there is not inserted again. A table that is too
+ * full is rebuilt first.
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  std::lock_guard<std::mutex> guard(insert_latches_[hash_fn_.GetHash(key) % INSERT_LATCH_STRIPES]);
+  while (true) {
+    writers_latch_.RLock();
+    table_latch_.RLock();
+    page_id_t header_page_id = header_page_id_;
+    size_t num_buckets;
+    InsertResult result;
+    try {
+      result = InsertInto(header_page_id, key, value, &num_buckets);
+    } catch (Exception &e) {
+      table_latch_.RUnlock();
+      writers_latch_.RUnlock();
+      throw;
+    }
+    table_latch_.RUnlock();
+    writers_latch_.RUnlock();
+    if (result != InsertResult::FULL) {
+      return result == InsertResult::INSERTED;
+    }
+    Rebuild(header_page_id, num_buckets);
+  }
+}
+
+/*
+ * The pair goes into the first tombstone of its probe sequence, or else the
+ * empty slot that ends it. A tombstone in an earlier block is only taken
+ * after the rest of the sequence was checked for the pair; if another insert
+ * took it meanwhile, the probe starts over.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename HASH_TABLE_TYPE::InsertResult HASH_TABLE_TYPE::InsertInto(page_id_t header_page_id, const KeyType &key,
+                                                                   const ValueType &value, size_t *num_buckets) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  *num_buckets = header_page->GetSize();
+  if ((header_page->GetLiveCount() + header_page->GetTombstoneCount() + 1) * 100 > *num_buckets * MAX_LOAD_PERCENT) {
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+    return InsertResult::FULL;
+  }
+  uint64_t hash = hash_fn_.GetHash(key);
+  uint8_t fingerprint = BlockPage::Fingerprint(hash);
+  InsertResult result = InsertResult::FULL;
+  bool has_tombstone = true;
+  try {
+    while (result == InsertResult::FULL && has_tombstone) {
+      has_tombstone = false;
+      size_t tombstone_block_index = 0;
+      slot_offset_t tombstone_offset = 0;
+      ProbeSlots(header_page, hash, true, true, [&](BlockPage *block_page, size_t block_index, slot_offset_t offset) {
+        if (block_page->IsReadable(offset)) {
+          if (comparator_(block_page->KeyAt(offset), key) == 0 && block_page->ValueAt(offset) == value) {
+            result = InsertResult::DUPLICATE;
+            return false;
+          }
+          return true;
+        }
+        if (block_page->IsOccupied(offset)) {
+          if (!has_tombstone) {
+            has_tombstone = true;
+            tombstone_block_index = block_index;
+            tombstone_offset = offset;
+          }
+          return true;
+        }
+        // the sequence ends here, the tombstone is still latched if it is in this block
+        if (has_tombstone && block_index == tombstone_block_index && !block_page->IsReadable(tombstone_offset)) {
+          offset = tombstone_offset;
+          header_page->UpdateCounts(0, -1);
+        } else if (has_tombstone) {
+          return true;
+        }
+        block_page->Insert(offset, key, value, fingerprint);
+        header_page->UpdateCounts(1, 0);
+        result = InsertResult::INSERTED;
+        return false;
+      });
+      if (result == InsertResult::FULL && has_tombstone) {
+        page_id_t block_page_id = header_page->GetBlockPageId(tombstone_block_index);
+        Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "'InsertInto' BufferPoolManager::FetchPage FAIL!");
+        }
+        page->WLatch();
+        auto block_page = reinterpret_cast<BlockPage *>(page->GetData());
+        bool inserted = block_page->Insert(tombstone_offset, key, value, fingerprint);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(block_page_id, inserted);
+        if (inserted) {
+          header_page->UpdateCounts(1, -1);
+          result = InsertResult::INSERTED;
+        }
+      }
+    }
+  } catch (Exception &e) {
+    buffer_pool_manager_->UnpinPage(header_page_id, result == InsertResult::INSERTED);
+    throw;
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, result == InsertResult::INSERTED);
+  return result;
 }
 
 /*****************************************************************************
@@ -48,21 +165,241 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  writers_latch_.RLock();
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  bool removed = false;
+  ProbeSlots(header_page, hash_fn_.GetHash(key), true, false,
+             [&](BlockPage *block_page, size_t block_index, slot_offset_t offset) {
+               if (block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0 &&
+                   block_page->ValueAt(offset) == value) {
+                 block_page->Remove(offset);
+                 header_page->UpdateCounts(-1, 1);
+                 removed = true;
+                 return false;
+               }
+               return true;
+             });
+  buffer_pool_manager_->UnpinPage(header_page->GetPageId(), removed);
+  table_latch_.RUnlock();
+  writers_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  Rebuild(INVALID_PAGE_ID, 2 * initial_size);
+}
+
+/*
+ * Copy the pairs into a new table, inserts and removes wait for the copy but
+ * lookups keep reading the old table until the switch. If the copy fails the
+ * new table is dropped and the old one stays in use.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Rebuild(page_id_t header_page_id, size_t min_buckets) {
+  writers_latch_.WLock();
+  // another insert may have rebuilt the table while this one waited
+  if (header_page_id != INVALID_PAGE_ID && header_page_id != header_page_id_) {
+    writers_latch_.WUnlock();
+    return;
+  }
+  page_id_t new_header_page_id = INVALID_PAGE_ID;
+  try {
+    HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+    size_t live_count = header_page->GetLiveCount();
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    new_header_page_id = CreateTable(std::max(min_buckets, (live_count + 1) * 100 / REBUILD_LOAD_PERCENT));
+    CopyTable(header_page_id_, new_header_page_id);
+  } catch (Exception &e) {
+    if (new_header_page_id != INVALID_PAGE_ID) {
+      try {
+        DeleteTable(new_header_page_id);
+      } catch (Exception &delete_error) {
+        LOG_WARN("Rebuild could not free the pages of the new table: %s", delete_error.what());
+      }
+    }
+    writers_latch_.WUnlock();
+    throw;
+  }
+
+  table_latch_.WLock();
+  page_id_t old_header_page_id = header_page_id_;
+  header_page_id_ = new_header_page_id;
+  table_latch_.WUnlock();
+  // lookups hold table_latch_, none of them is left in the old table
+  DeleteTable(old_header_page_id);
+  writers_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page;
+  try {
+    header_page = FetchHeaderPage(header_page_id_);
+  } catch (Exception &e) {
+    table_latch_.RUnlock();
+    throw;
+  }
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::CreateTable(size_t num_buckets) {
+  num_buckets = std::max<size_t>(num_buckets, 1);
+  size_t num_blocks = (num_buckets - 1) / BLOCK_ARRAY_SIZE + 1;
+  if (num_blocks > HASH_TABLE_HEADER_MAX_BLOCKS) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "hash table header page has no room for the blocks");
+  }
+
+  page_id_t header_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'CreateTable' BufferPoolManager::NewPage FAIL!");
+  }
+  auto header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page->SetPageId(header_page_id);
+  header_page->SetSize(num_buckets);
+  for (size_t block_index = 0; block_index < num_blocks; block_index++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      // drop the blocks allocated so far with the header
+      buffer_pool_manager_->UnpinPage(header_page_id, true);
+      DeleteTable(header_page_id);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'CreateTable' BufferPoolManager::NewPage FAIL!");
+    }
+    header_page->AddBlockPageId(block_page_id);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, true);
+  return header_page_id;
+}
+
+/*
+ * Every page pinned or latched here is released again before an exception
+ * leaves, so the caller only has to drop the target table.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::CopyTable(page_id_t from_header_page_id, page_id_t to_header_page_id) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(from_header_page_id);
+  try {
+    for (size_t block_index = 0; block_index < header_page->NumBlocks(); block_index++) {
+      page_id_t block_page_id = header_page->GetBlockPageId(block_index);
+      Page *page = buffer_pool_manager_->FetchPage(block_page_id);
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "'CopyTable' BufferPoolManager::FetchPage FAIL!");
+      }
+      auto block_page = reinterpret_cast<BlockPage *>(page->GetData());
+      page->RLatch();
+      try {
+        for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+          if (block_page->IsReadable(offset)) {
+            size_t num_buckets;
+            InsertInto(to_header_page_id, block_page->KeyAt(offset), block_page->ValueAt(offset), &num_buckets);
+          }
+        }
+      } catch (Exception &e) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(block_page_id, false);
+        throw;
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(block_page_id, false);
+    }
+  } catch (Exception &e) {
+    buffer_pool_manager_->UnpinPage(from_header_page_id, false);
+    throw;
+  }
+  buffer_pool_manager_->UnpinPage(from_header_page_id, false);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteTable(page_id_t header_page_id) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  for (size_t block_index = 0; block_index < header_page->NumBlocks(); block_index++) {
+    buffer_pool_manager_->DeletePage(header_page->GetBlockPageId(block_index));
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  buffer_pool_manager_->DeletePage(header_page_id);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void HASH_TABLE_TYPE::ProbeSlots(HashTableHeaderPage *header_page, uint64_t hash, bool exclusive, bool with_tombstones,
+                                 Visitor visitor) {
+  size_t num_buckets = header_page->GetSize();
+  uint8_t fingerprint = BlockPage::Fingerprint(hash);
+  size_t bucket = hash % num_buckets;
+  size_t remaining = num_buckets;
+  while (remaining > 0) {
+    size_t block_index = bucket / BLOCK_ARRAY_SIZE;
+    auto offset = static_cast<slot_offset_t>(bucket % BLOCK_ARRAY_SIZE);
+    // the last block may have more slots than the table
+    auto block_end = static_cast<slot_offset_t>(
+        std::min<size_t>(BLOCK_ARRAY_SIZE, num_buckets - block_index * BLOCK_ARRAY_SIZE));
+    Page *page = buffer_pool_manager_->FetchPage(header_page->GetBlockPageId(block_index));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'ProbeSlots' BufferPoolManager::FetchPage FAIL!");
+    }
+    exclusive ? page->WLatch() : page->RLatch();
+    auto block_page = reinterpret_cast<BlockPage *>(page->GetData());
+
+    bool done = false;
+    bool dirty = false;
+    while (!done && offset < block_end && remaining > 0) {
+      auto count = static_cast<slot_offset_t>(
+          std::min<size_t>({BLOCK_TAG_GROUP_SIZE, static_cast<size_t>(block_end - offset), remaining}));
+      uint32_t empty;
+      uint32_t match = block_page->MatchGroup(offset, count, fingerprint, &empty);
+      if (with_tombstones) {
+        uint32_t ignored;
+        match |= block_page->MatchGroup(offset, count, BlockPage::TOMBSTONE_TAG, &ignored);
+      }
+      // the probe sequence ends at the first empty slot
+      if (empty != 0) {
+        match &= (1U << __builtin_ctz(empty)) - 1;
+      }
+      for (; match != 0 && !done; match &= match - 1) {
+        done = !visitor(block_page, block_index, offset + __builtin_ctz(match));
+        dirty = done && exclusive;
+      }
+      if (!done && empty != 0) {
+        dirty = !visitor(block_page, block_index, offset + __builtin_ctz(empty)) && exclusive;
+        done = true;
+      }
+      offset += count;
+      remaining -= count;
+    }
+
+    exclusive ? page->WUnlatch() : page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+    if (done) {
+      return;
+    }
+    bucket = (block_index * BLOCK_ARRAY_SIZE + offset) % num_buckets;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(header_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FetchHeaderPage' BufferPoolManager::FetchPage FAIL!");
+  }
+  return reinterpret_cast<HashTableHeaderPage *>(page->GetData());
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
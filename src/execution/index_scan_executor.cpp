@@ -11,16 +11,110 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "storage/table/table_scan_cursor.h"
+
 namespace bustub {
+
+namespace {
+
+/** Hands out the RIDs of a whole table, for scans an unordered index can not narrow */
+class TableRangeCursor : public IndexRangeCursor {
+ public:
+  TableRangeCursor(TableHeap *table_heap, Transaction *txn) : cursor_(table_heap, txn) {}
+
+  bool Next(RID *rid) override {
+    if (!cursor_.Next()) {
+      return false;
+    }
+    *rid = cursor_.GetRid();
+    return true;
+  }
+
+ private:
+  TableScanCursor cursor_;
+};
+
+}  // namespace
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan), index_(nullptr), table_meta_(nullptr), table_heap_(nullptr) {}
 
 void IndexScanExecutor::Init() {
   auto index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
-  index_ = reinterpret_cast<BPlusTreeIndexType *>(index_info->index_.get());
-  iter_ = index_->GetBeginIterator();
+  index_ = index_info->index_.get();
   table_meta_ = exec_ctx_->GetCatalog()->GetTable(index_info->table_name_);
   table_heap_ = table_meta_->table_.get();
+
+  cursor_ = OpenPredicateRange();
+  if (cursor_ == nullptr && index_->SupportsRangeScan()) {
+    cursor_ = index_->OpenRange(nullptr, true, nullptr, true, ScanDirection::FORWARD, exec_ctx_->GetTransaction());
+  } else if (cursor_ == nullptr) {
+    // a hash index has no order to scan in, read the table instead
+    cursor_ = std::make_unique<TableRangeCursor>(table_heap_, exec_ctx_->GetTransaction());
+  }
+}
+
+std::unique_ptr<IndexRangeCursor> IndexScanExecutor::OpenPredicateRange() {
+  auto comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  if (comparison == nullptr || index_->GetIndexColumnCount() != 1) {
+    return nullptr;
+  }
+
+  auto comp_type = comparison->GetComparisonType();
+  auto column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr) {
+    // constant on the left, flip the comparison
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        comp_type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        comp_type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        comp_type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        comp_type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != index_->GetKeyAttrs()[0]) {
+    return nullptr;
+  }
+
+  auto key_schema = index_->GetKeySchema();
+  Value value = constant->Evaluate(nullptr, nullptr);
+  if (value.IsNull() || value.GetTypeId() != key_schema->GetColumn(0).GetType()) {
+    return nullptr;
+  }
+  Tuple key{{value}, key_schema};
+
+  auto txn = exec_ctx_->GetTransaction();
+  if (comp_type != ComparisonType::Equal && !index_->SupportsRangeScan()) {
+    return nullptr;
+  }
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return index_->OpenRange(&key, true, &key, true, ScanDirection::FORWARD, txn);
+    case ComparisonType::LessThan:
+    case ComparisonType::LessThanOrEqual:
+      return index_->OpenRange(nullptr, true, &key, comp_type == ComparisonType::LessThanOrEqual,
+                               ScanDirection::FORWARD, txn);
+    case ComparisonType::GreaterThan:
+    case ComparisonType::GreaterThanOrEqual:
+      return index_->OpenRange(&key, comp_type == ComparisonType::GreaterThanOrEqual, nullptr, true,
+                               ScanDirection::FORWARD, txn);
+    default:
+      return nullptr;
+  }
 }
 
 void IndexScanExecutor::GetValue(Tuple* t) {
@@ -32,13 +126,12 @@ void IndexScanExecutor::GetValue(Tuple* t) {
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
-  while (iter_ != index_->GetEndIterator())
+  while (cursor_->Next(rid))
   {
-      *rid = (*iter_).second;
       bool ok = table_heap_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
-      ++iter_;
 
-      if (ok && (plan_->GetPredicate() != nullptr || plan_->GetPredicate()->Evaluate(tuple, &table_meta_->schema_).GetAs<bool>())) {
+      if (ok && (plan_->GetPredicate() == nullptr ||
+                 plan_->GetPredicate()->Evaluate(tuple, &table_meta_->schema_).GetAs<bool>())) {
         GetValue(tuple);
         return true;
       }
@@ -12,15 +12,51 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), child_exec_(std::move(child_executor)),  table_meta_(nullptr), idx_info_(nullptr) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_exec_(std::move(child_executor)),
+      table_meta_(nullptr),
+      idx_info_(nullptr),
+      outer_cursor_(0),
+      inner_cursor_(0) {}
 
 void NestIndexJoinExecutor::Init() {
+  child_exec_->Init();
   table_meta_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableOid());
   idx_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexName() , table_meta_->name_);
+  outer_tuples_.clear();
+  inner_rids_.clear();
+  outer_cursor_ = 0;
+  inner_cursor_ = 0;
+
+  // outer.x = inner.key on a single column index takes the key from x,
+  // otherwise the leading outer columns are the key
+  auto &key_attrs = idx_info_->index_->GetKeyAttrs();
+  outer_key_attrs_.clear();
+  auto comparison = dynamic_cast<const ComparisonExpression *>(plan_->Predicate());
+  if (comparison != nullptr && comparison->GetComparisonType() == ComparisonType::Equal && key_attrs.size() == 1) {
+    auto lhs = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+    auto rhs = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    if (lhs != nullptr && rhs != nullptr && lhs->GetTupleIdx() != rhs->GetTupleIdx()) {
+      auto outer = lhs->GetTupleIdx() == 0 ? lhs : rhs;
+      auto inner = lhs->GetTupleIdx() == 0 ? rhs : lhs;
+      if (inner->GetColIdx() == key_attrs[0]) {
+        outer_key_attrs_.push_back(outer->GetColIdx());
+      }
+    }
+  }
+  if (outer_key_attrs_.empty()) {
+    for (uint32_t i = 0; i < key_attrs.size(); i++) {
+      outer_key_attrs_.push_back(i);
+    }
+  }
 }
 
 Tuple NestIndexJoinExecutor::IndexJoin(Tuple* l, Tuple* r) {
@@ -33,6 +69,26 @@ Tuple NestIndexJoinExecutor::IndexJoin(Tuple* l, Tuple* r) {
   return Tuple{values, GetOutputSchema()};
 }
 
+bool NestIndexJoinExecutor::ProbeNextBatch() {
+  outer_tuples_.clear();
+  outer_cursor_ = 0;
+  inner_cursor_ = 0;
+
+  Tuple outer_tuple;
+  RID outer_rid;
+  std::vector<Tuple> keys;
+  while (outer_tuples_.size() < PROBE_BATCH_SIZE && child_exec_->Next(&outer_tuple, &outer_rid)) {
+    keys.push_back(
+        outer_tuple.KeyFromTuple(*plan_->OuterTableSchema(), idx_info_->key_schema_, outer_key_attrs_));
+    outer_tuples_.push_back(outer_tuple);
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
+
+  idx_info_->index_->ScanKeys(keys, &inner_rids_, exec_ctx_->GetTransaction());
+  return true;
+}
 
 bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
   /** Example
@@ -41,25 +97,35 @@ bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
     JOIN table2
     ON table1.column_name=table2.column_name;
  */
-  Tuple left_tuple, right_tuple;
+  Tuple right_tuple;
 
   while (true) {
-    if (!rids_.empty()) {
-      auto right_rid = rids_.back();
-      rids_.pop_back();
-      auto ok = table_meta_->table_->GetTuple(right_rid, &right_tuple, exec_ctx_->GetTransaction());
-      if (!ok) {
-        return false;
+    if (outer_cursor_ < outer_tuples_.size()) {
+      auto &rids = inner_rids_[outer_cursor_];
+      auto &left_tuple = outer_tuples_[outer_cursor_];
+      while (inner_cursor_ < rids.size()) {
+        auto right_rid = rids[inner_cursor_++];
+        if (!table_meta_->table_->GetTuple(right_rid, &right_tuple, exec_ctx_->GetTransaction())) {
+          continue;
+        }
+        if (plan_->Predicate() != nullptr &&
+            !plan_->Predicate()
+                 ->EvaluateJoin(&left_tuple, plan_->OuterTableSchema(), &right_tuple, plan_->InnerTableSchema())
+                 .GetAs<bool>()) {
+          continue;
+        }
+        *tuple = IndexJoin(&left_tuple , &right_tuple);
+        *rid = right_rid;
+        return true;
       }
-      *tuple = IndexJoin(&left_tuple , &right_tuple);
-      return ok;
+      outer_cursor_++;
+      inner_cursor_ = 0;
+      continue;
     }
 
-    if (!child_exec_->Next(&left_tuple, rid)) {
+    if (!ProbeNextBatch()) {
       return false;
     }
-
-    idx_info_->index_->ScanKey(left_tuple, &rids_, exec_ctx_->GetTransaction());
   }
 
   return false;
@@ -11,56 +11,151 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/seq_scan_executor.h"
 
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) :
       AbstractExecutor(exec_ctx),
       plan_(plan),
-      iter_(nullptr, RID{}, nullptr),
       table_heap_(nullptr)
 {}
 
 void SeqScanExecutor::Init() {
-  table_heap_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_.get();
-  auto bpm = exec_ctx_->GetBufferPoolManager();
-  auto first_pid = table_heap_->GetFirstPageId();
-  auto page = bpm->FetchPage(first_pid);
-  auto table_page = reinterpret_cast<TablePage*>(page);
-  RID rid;
-  table_page->GetFirstTupleRid(&rid);
-  bpm->UnpinPage(first_pid, false);
-  iter_ =  TableIterator{table_heap_, rid, exec_ctx_->GetTransaction()};
+  auto table_meta = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  table_heap_ = table_meta->table_.get();
+  table_schema_ = &table_meta->schema_;
+  cursor_ = std::make_unique<TableScanCursor>(table_heap_, exec_ctx_->GetTransaction(), table_schema_);
+  filter_ = nullptr;
+  read_columns_.clear();
+  PushDownPredicate();
+  PlanColumnReads();
+}
+
+void SeqScanExecutor::PlanColumnReads() {
+  if (table_heap_->GetFormat() != TableFormat::PAX || (plan_->GetPredicate() != nullptr && !filter_)) {
+    return;
+  }
+  for (auto &column : GetOutputSchema()->GetColumns()) {
+    auto column_value = dynamic_cast<const ColumnValueExpression *>(column.GetExpr());
+    if (column_value == nullptr || column_value->GetTupleIdx() != 0 ||
+        column_value->GetColIdx() >= table_schema_->GetColumnCount()) {
+      read_columns_.clear();
+      return;
+    }
+    read_columns_.push_back(column_value->GetColIdx());
+  }
+  // the column of the predicate comes last
+  if (filter_ && !read_columns_.empty()) {
+    read_columns_.push_back(filter_column_idx_);
+  }
+}
+
+void SeqScanExecutor::PushDownPredicate() {
+  auto comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  if (table_heap_->GetFormat() == TableFormat::ROW || comparison == nullptr) {
+    return;
+  }
+  // column <op> constant, or constant <op> column
+  bool constant_first = false;
+  auto column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    constant_first = true;
+  }
+  if (column == nullptr || constant == nullptr) {
+    return;
+  }
+  // The predicate reads the tuple through the output schema, the cursor the column of the table.
+  uint32_t col_idx = column->GetColIdx();
+  const Schema *output_schema = GetOutputSchema();
+  if (col_idx >= table_schema_->GetColumnCount() || col_idx >= output_schema->GetColumnCount() ||
+      output_schema->GetColumn(col_idx).GetOffset() != table_schema_->GetColumn(col_idx).GetOffset() ||
+      output_schema->GetColumn(col_idx).GetType() != table_schema_->GetColumn(col_idx).GetType()) {
+    return;
+  }
+
+  Value constant_value = constant->Evaluate(nullptr, nullptr);
+  ComparisonType comp_type = comparison->GetComparisonType();
+  filter_column_idx_ = col_idx;
+  filter_ = [=](const Value &value) {
+    const Value &lhs = constant_first ? constant_value : value;
+    const Value &rhs = constant_first ? value : constant_value;
+    CmpBool res = CmpBool::CmpFalse;
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        res = lhs.CompareEquals(rhs);
+        break;
+      case ComparisonType::NotEqual:
+        res = lhs.CompareNotEquals(rhs);
+        break;
+      case ComparisonType::LessThan:
+        res = lhs.CompareLessThan(rhs);
+        break;
+      case ComparisonType::LessThanOrEqual:
+        res = lhs.CompareLessThanEquals(rhs);
+        break;
+      case ComparisonType::GreaterThan:
+        res = lhs.CompareGreaterThan(rhs);
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        res = lhs.CompareGreaterThanEquals(rhs);
+        break;
+    }
+    // the same as the predicate, which also takes a null comparison for true
+    return ValueFactory::GetBooleanValue(res).GetAs<bool>();
+  };
+  cursor_->SetFilter(col_idx, filter_);
 }
 
-void SeqScanExecutor::GetValues(Tuple* t) {
+void SeqScanExecutor::GetValues(const Tuple &source, Tuple *output) {
   std::vector<Value> res;
-  auto table_meta = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  res.reserve(GetOutputSchema()->GetColumnCount());
   for (auto& i : plan_->OutputSchema()->GetColumns())
   {
-    res.push_back(i.GetExpr()->Evaluate(t, &table_meta->schema_));
+    res.push_back(i.GetExpr()->Evaluate(&source, table_schema_));
   }
-  *t = Tuple{res, GetOutputSchema()};
+  *output = Tuple{res, GetOutputSchema()};
 }
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
-  while (iter_ != table_heap_->End()){
-    *tuple = *iter_;
-    *rid = tuple->GetRid();
+  auto txn = exec_ctx_->GetTransaction();
+  while (cursor_->Next()) {
+    *rid = cursor_->GetRid();
 
-    if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
       LockTuple(*rid, false);
     }
 
-    bool ok = table_heap_->GetTuple(*rid, tuple, GetExecutorContext()->GetTransaction());
+    bool found = false;
+    if (!read_columns_.empty()) {
+      // PAX 页面按列读取, 不拼装整个元组
+      std::vector<Value> values;
+      found = cursor_->GetValues(read_columns_, &values) && (!filter_ || filter_(values.back()));
+      if (found) {
+        values.resize(GetOutputSchema()->GetColumnCount());
+        *tuple = Tuple{values, GetOutputSchema()};
+      }
+    } else {
+      // 在页面上直接判断谓词, 只有输出的列被拷贝出来
+      cursor_->View([&](const Tuple &view) {
+        if (plan_->GetPredicate() == nullptr ||
+            plan_->GetPredicate()->Evaluate(&view, plan_->OutputSchema()).GetAs<bool>()) {
+          GetValues(view, tuple);
+          found = true;
+        }
+      });
+    }
 
-    if (exec_ctx_->GetTransaction()->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    if (txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
       UnLockTuple(*rid);
     }
 
-    iter_++;
-    // 满足条件则返回 否则继续查找
-    if (ok && (plan_->GetPredicate() == nullptr ||plan_->GetPredicate()->Evaluate(tuple, plan_->OutputSchema()).GetAs<bool>())) {
-      GetValues(tuple);
+    if (found) {
       return true;
     }
   }
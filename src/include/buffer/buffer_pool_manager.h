@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 
 #include "common/logger.h"
 #include "buffer/lru_replacer.h"
@@ -26,11 +30,19 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * The first PrefetchPage starts a read ahead thread that reads through the
+ * DiskManager until StopPrefetch() or the destructor stops it. Once a pool
+ * has prefetched, destroy it (or call StopPrefetch()) before the DiskManager;
+ * the destructor itself never touches the DiskManager, so without read ahead
+ * the two can go in either order.
  */
 class BufferPoolManager {
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
+  /** Reads the id of the page to read ahead after a page from its data, INVALID_PAGE_ID to stop */
+  using prefetch_next_fn = page_id_t (*)(const char *page_data);
 
   /**
    * Creates a new BufferPoolManager.
@@ -41,7 +53,8 @@ class BufferPoolManager {
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
 
   /**
-   * Destroys an existing BufferPoolManager.
+   * Destroys an existing BufferPoolManager, stopping the read ahead thread first. Dirty pages are not written back,
+   * call FlushAllPages() for that.
    */
   ~BufferPoolManager();
 
@@ -95,6 +108,23 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Read a page into the buffer pool in the background, so a later FetchPage
+   * does not wait for the disk. This is only a hint, it is dropped when the
+   * page is already cached or the pool is short of unpinned frames.
+   * @param page_id id of the page to read ahead
+   * @param depth number of pages to read, each one after the first is found by next
+   * @param next gives the page to read after a page that was read, nullptr reads one page
+   */
+  void PrefetchPage(page_id_t page_id, int depth = 1, prefetch_next_fn next = nullptr);
+
+  /**
+   * Stop the read ahead thread and wait for the read in flight, later
+   * PrefetchPage calls are dropped. The destructor calls it too; an owner
+   * that tears down the DiskManager before the pool must call it first.
+   */
+  void StopPrefetch();
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
@@ -159,6 +189,21 @@ class BufferPoolManager {
   void ChangePage(Page *page, page_id_t new_page_id, frame_id_t new_frame_id);
   bool Victim(frame_id_t *frame_id);
 
+  /**
+   * Look up page_id in the page table, waiting for its read ahead to complete.
+   * @param lock the held latch_
+   */
+  std::unordered_map<page_id_t, frame_id_t>::iterator FindPage(std::unique_lock<std::mutex> *lock, page_id_t page_id);
+
+  /** Body of the read ahead thread, started by the first PrefetchPage */
+  void RunPrefetch();
+
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    int depth_;
+    prefetch_next_fn next_;
+  };
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
@@ -175,5 +220,16 @@ class BufferPoolManager {
   std::list<frame_id_t> free_list_;
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
   std::mutex latch_;
+
+  /** Pending read ahead, bounded by PREFETCH_QUEUE_SIZE. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  std::condition_variable prefetch_cv_;
+  std::thread *prefetch_thread_{nullptr};
+  bool prefetch_stop_{false};
+  /** Frames the read ahead thread is reading into, they are pinned and not yet readable. */
+  std::unordered_set<frame_id_t> reading_frames_;
+  /** Notified when a read ahead completes. */
+  std::condition_variable io_cv_;
+  static constexpr size_t PREFETCH_QUEUE_SIZE = 32;
 };
 }  // namespace bustub
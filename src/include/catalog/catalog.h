@@ -8,8 +8,12 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_link_tree_index.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -73,13 +77,16 @@ class Catalog {
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param format the page format of the new table, PAX for tables mostly scanned a few columns at a time, COMPRESSED
+   * for tables scanned with selective predicates or short of memory
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             TableFormat format = TableFormat::ROW) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
 
     table_oid_t table_oid = next_table_oid_++;
-    std::unique_ptr<TableHeap> table(new TableHeap(bpm_, lock_manager_, log_manager_, txn));
+    std::unique_ptr<TableHeap> table(new TableHeap(bpm_, lock_manager_, log_manager_, txn, format, &schema));
     std::unique_ptr<TableMetadata> table_meta_data_ptr(new TableMetadata(schema, table_name,
                                                                          std::move(table), table_oid));
     TableMetadata* table_meta = table_meta_data_ptr.get();
@@ -119,18 +126,38 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param is_unique false if several tuples may share the same key
+   * @param index_type BLINKTREE suits tables with heavy concurrent writes, ART
+   * memory-resident lookup tables, LINEAR_PROBE_HASH and
+   * EXTENDIBLE_HASH equality lookups only. EXTENDIBLE_HASH indexes must be
+   * unique, a bucket cannot hold more tuples of one key than fit in a page.
    * @return a pointer to the metadata of the new table
    */
 
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
+                         size_t keysize, bool is_unique = true, IndexType index_type = IndexType::BPLUSTREE) {
+    if (index_type == IndexType::EXTENDIBLE_HASH && !is_unique) {
+      throw bustub::Exception{ExceptionType::NOT_IMPLEMENTED, "EXTENDIBLE_HASH indexes must be unique"};
+    }
 
     index_oid_t index_oid = next_index_oid_++;
 
-    IndexMetadata * index_meta_data = new IndexMetadata{index_name, table_name, &schema, key_attrs};
-    std::unique_ptr<Index> index_ptr(new BPLUSTREE_INDEX_TYPE{index_meta_data, bpm_});
+    IndexMetadata * index_meta_data = new IndexMetadata{index_name, table_name, &schema, key_attrs, is_unique};
+    std::unique_ptr<Index> index_ptr;
+    if (index_type == IndexType::BLINKTREE) {
+      index_ptr.reset(new BLINKTREE_INDEX_TYPE{index_meta_data, bpm_});
+    } else if (index_type == IndexType::ART) {
+      index_ptr.reset(new ART_INDEX_TYPE{index_meta_data, bpm_});
+    } else if (index_type == IndexType::LINEAR_PROBE_HASH) {
+      index_ptr.reset(
+          new HASH_TABLE_INDEX_TYPE{index_meta_data, bpm_, HASH_TABLE_NUM_BUCKETS, HashFunction<KeyType>()});
+    } else if (index_type == IndexType::EXTENDIBLE_HASH) {
+      index_ptr.reset(new EXTENDIBLE_HASH_TABLE_INDEX_TYPE{index_meta_data, bpm_, HashFunction<KeyType>()});
+    } else {
+      index_ptr.reset(new BPLUSTREE_INDEX_TYPE{index_meta_data, bpm_});
+    }
     std::unique_ptr<IndexInfo> index_info_ptr(new IndexInfo{key_schema, index_name, std::move(index_ptr), index_oid, table_name, keysize});
     IndexInfo * index = index_info_ptr.get();
 
@@ -139,9 +166,25 @@ class Catalog {
     assert(iter != index_names_.end());
     iter->second.insert({index_name, index_oid});
 
+    if (!index->index_->IsPersistent()) {
+      RebuildIndex(txn, index);
+    }
     return index;
   }
 
+  /**
+   * Insert the key of every tuple of the table into the index. An index that
+   * is not persisted starts empty and is filled this way, at startup too.
+   */
+  void RebuildIndex(Transaction *txn, IndexInfo *index_info) {
+    TableMetadata *table_meta = GetTable(index_info->table_name_);
+    Index *index = index_info->index_.get();
+    for (auto iter = table_meta->table_->Begin(txn); iter != table_meta->table_->End(); ++iter) {
+      index->InsertEntry(iter->KeyFromTuple(table_meta->schema_, index_info->key_schema_, index->GetKeyAttrs()),
+                         iter->GetRid(), txn);
+    }
+  }
+
   IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
     auto search_table = index_names_.find(table_name);
     if (search_table == index_names_.end()){
@@ -183,6 +226,13 @@ class Catalog {
     return res;
   }
 
+  /** Persist the in-memory state of every index, called at checkpoint time. */
+  void Checkpoint() {
+    for (const auto &pair : indexes_) {
+      pair.second->index_->Checkpoint();
+    }
+  }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -43,6 +43,7 @@ class BustubInstance {
   }
 
   ~BustubInstance() {
+    buffer_pool_manager_->StopPrefetch();
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
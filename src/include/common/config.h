@@ -35,6 +35,10 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int INDEX_READ_AHEAD = 4;                                    // leaves an index scan reads ahead
+static constexpr int LAZY_MERGE_DIVISOR = 4;                                  // lazy b+ tree deletes merge below max/4
+static constexpr int HASH_TABLE_NUM_BUCKETS = 1024;                           // initial slots of a hash index
+static constexpr int TOAST_TUPLE_THRESHOLD = PAGE_SIZE / 4;                   // larger tuples move values out of line
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
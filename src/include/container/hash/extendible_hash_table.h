@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool
+ * manager. Non-unique keys are supported, but buckets have no overflow pages:
+ * an insert fails with OUT_OF_RANGE once BUCKET_ARRAY_SIZE pairs share the
+ * hash of its key. Supports insert and delete.
+ *
+ * The directory page maps the low bits of the hash of a key to a bucket
+ * page. A full bucket is split in two on the next bit of the hash, and the
+ * directory doubles only when that bit is beyond the global depth, so the
+ * table grows one bucket at a time without rehashing the other buckets. A
+ * bucket emptied by a remove is merged back into its split image.
+ *
+ * Lookups, inserts and removes hold the table latch shared and the latch of
+ * their bucket page; splits and merges hold the table latch exclusive.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false otherwise
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+  /**
+   * Asserts the invariants of the directory, see
+   * HashTableDirectoryPage::VerifyIntegrity
+   */
+  void VerifyIntegrity();
+
+ private:
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+  // the low 32 bits of the hash, enough for any directory
+  uint32_t Hash(const KeyType &key);
+
+  uint32_t KeyToDirectoryIndex(const KeyType &key, HashTableDirectoryPage *dir_page);
+
+  HashTableDirectoryPage *FetchDirectoryPage();
+  Page *FetchBucketPage(page_id_t bucket_page_id);
+  // only called under the exclusive table latch
+  bool IsBucketEmpty(page_id_t bucket_page_id);
+
+  // Split the bucket of key until it has room for the pair, then insert it
+  bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
+
+  // Merge the bucket of key with its split image while either of them is empty
+  void Merge(Transaction *transaction, const KeyType &key);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers includes inserts and removes, writers are splits and merges
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
@@ -13,11 +13,18 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
+#include "common/util/hash_util.h"
 #include "murmur3/MurmurHash3.h"
 
 namespace bustub {
 
+/**
+ * Hashes keys for the hash tables. Integer keys are mixed in a few
+ * instructions, GenericKey has its own specialization in generic_key.h, any
+ * other key is hashed with MurmurHash3.
+ */
 template <typename KeyType>
 class HashFunction {
  public:
@@ -26,6 +33,10 @@ class HashFunction {
    * @return the hashed value
    */
   virtual uint64_t GetHash(KeyType key) {
+    // an integer fits in one word, mixing its bits is enough
+    if constexpr (std::is_integral_v<KeyType> && sizeof(KeyType) <= sizeof(uint64_t)) {
+      return HashUtil::HashInteger(static_cast<uint64_t>(key));
+    }
     uint64_t hash[2];
     murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
                                  reinterpret_cast<void *>(&hash));
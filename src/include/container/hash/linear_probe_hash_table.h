@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -32,6 +33,17 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The header page lists the block pages, slot i of the table is slot
+ * i % BLOCK_ARRAY_SIZE of block i / BLOCK_ARRAY_SIZE. A probe latches one
+ * block at a time and compares whole groups of slot tags to the fingerprint
+ * of its key, so it only reads the keys that are likely to match. Removed
+ * pairs leave a tombstone that probes walk past and inserts reuse.
+ *
+ * The header page counts pairs and tombstones. Once they would fill more
+ * than MAX_LOAD_PERCENT of the slots, the table is rebuilt without its
+ * tombstones, sized so that its pairs fill at most REBUILD_LOAD_PERCENT of
+ * it. A rebuild never shrinks the table.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -75,7 +87,8 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Rebuilds the table with at least twice the initial size provided, and
+   * more if its pairs need them.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -87,6 +100,50 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  using BlockPage = HashTableBlockPage<KeyType, ValueType, KeyComparator>;
+
+  enum class InsertResult { INSERTED, DUPLICATE, FULL };
+
+  // pairs and tombstones may fill this share of the slots, in percent
+  static constexpr size_t MAX_LOAD_PERCENT = 70;
+  // share of the slots the pairs fill after a rebuild, in percent
+  static constexpr size_t REBUILD_LOAD_PERCENT = 50;
+  // inserts of keys hashing to the same stripe run one at a time
+  static constexpr size_t INSERT_LATCH_STRIPES = 64;
+
+  // Allocate the header and block pages of a table of num_buckets slots
+  page_id_t CreateTable(size_t num_buckets);
+
+  /*
+   * Replace the table of header_page_id, or the current one if it is
+   * INVALID_PAGE_ID, by a copy of at least min_buckets slots without
+   * tombstones. Does nothing if the table was replaced already.
+   */
+  void Rebuild(page_id_t header_page_id, size_t min_buckets);
+
+  // Insert the pairs of one table into another
+  void CopyTable(page_id_t from_header_page_id, page_id_t to_header_page_id);
+
+  // Free the pages of a table nobody uses anymore
+  void DeleteTable(page_id_t header_page_id);
+
+  InsertResult InsertInto(page_id_t header_page_id, const KeyType &key, const ValueType &value,
+                          size_t *num_buckets);
+
+  /*
+   * Call visitor(block, block_index, offset) on the slots of the probe
+   * sequence of hash whose tag matches the fingerprint of hash, and on its
+   * tombstones if with_tombstones is set, one latched block at a time, until
+   * it returns false. The sequence ends with the first slot that was never
+   * occupied, which is visited too. The block the visitor stopped at is
+   * written back if the probe is exclusive.
+   */
+  template <typename Visitor>
+  void ProbeSlots(HashTableHeaderPage *header_page, uint64_t hash, bool exclusive, bool with_tombstones,
+                  Visitor visitor);
+
+  HashTableHeaderPage *FetchHeaderPage(page_id_t header_page_id);
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
@@ -94,6 +151,12 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
 
   // Readers includes inserts and removes, writer is only resize
   ReaderWriterLatch table_latch_;
+  // Inserts and removes hold it shared. Resize holds it exclusive while it
+  // copies the table, and holds table_latch_ only to switch to the copy.
+  ReaderWriterLatch writers_latch_;
+  // An insert checks the whole probe sequence for its pair before it takes
+  // a tombstone, no other insert of the pair may slip in meanwhile.
+  std::mutex insert_latches_[INSERT_LATCH_STRIPES];
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <vector>
+#include <memory>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
@@ -28,9 +28,6 @@ namespace bustub {
 
 class IndexScanExecutor : public AbstractExecutor {
  public:
-
-  using BPlusTreeIndexType =  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
-  using IndexIteratorType = IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
   /**
    * Creates a new index scan executor.
    * @param exec_ctx the executor context
@@ -47,10 +44,18 @@ class IndexScanExecutor : public AbstractExecutor {
   void GetValue(Tuple* t);
 
  private:
+  /**
+   * Narrow the scan to the key range of a predicate comparing the first key
+   * column against a constant, the predicate is still checked on each tuple.
+   * @return nullptr if the predicate can not bound the scan
+   */
+  std::unique_ptr<IndexRangeCursor> OpenPredicateRange();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
-  BPlusTreeIndexType * index_;
-  IndexIteratorType iter_;
+  Index *index_;
+  /** index entries in range, read as Next() advances */
+  std::unique_ptr<IndexRangeCursor> cursor_;
   TableMetadata* table_meta_;
   TableHeap* table_heap_;
 };
@@ -50,11 +50,27 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   Tuple IndexJoin(Tuple* l, Tuple* r);
 
  private:
+  /**
+   * Read the next batch of outer tuples and probe the index with all of their
+   * keys at once.
+   * @return false if the outer table is exhausted
+   */
+  bool ProbeNextBatch();
+
+  /** Outer tuples probed together, sorted probes share the descent of the index */
+  static constexpr size_t PROBE_BATCH_SIZE = 128;
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_exec_;
   TableMetadata* table_meta_;
   IndexInfo* idx_info_;
-  std::vector<RID> rids_;
+  /** Columns of the outer tuple forming the index key */
+  std::vector<uint32_t> outer_key_attrs_;
+  std::vector<Tuple> outer_tuples_;
+  /** inner_rids_[i] are the index matches of outer_tuples_[i] */
+  std::vector<std::vector<RID>> inner_rids_;
+  size_t outer_cursor_;
+  size_t inner_cursor_;
 };
 }  // namespace bustub
@@ -12,11 +12,14 @@
 
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_scan_cursor.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -39,11 +42,27 @@ class SeqScanExecutor : public AbstractExecutor {
 
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
-  void GetValues(Tuple* t);
+  /** Materialize the output columns of a table tuple */
+  void GetValues(const Tuple &source, Tuple *output);
  private:
+  /** Let the cursor skip tuples of compressed and PAX pages when the predicate compares a column with a constant */
+  void PushDownPredicate();
+
+  /**
+   * On a PAX table, read the output columns one by one from their minipages if they are all columns of the table and
+   * the predicate, if any, was pushed down
+   */
+  void PlanColumnReads();
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
-  TableIterator iter_;
+  std::unique_ptr<TableScanCursor> cursor_;
   TableHeap* table_heap_;
+  const Schema *table_schema_{nullptr};
+  /** The pushed down predicate on the column filter_column_idx_ of the table, empty if it was not pushed down */
+  std::function<bool(const Value &)> filter_;
+  uint32_t filter_column_idx_{0};
+  /** The table columns of the output, then the column of filter_, empty if the tuples are viewed whole */
+  std::vector<uint32_t> read_columns_;
 };
 }  // namespace bustub
@@ -18,6 +18,8 @@
 
 namespace bustub {
 
+class Catalog;
+
 /**
  * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
  */
@@ -34,10 +36,14 @@ class CheckpointManager {
   void BeginCheckpoint();
   void EndCheckpoint();
 
+  /** Catalog whose indexes persist their in-memory state, such as tree roots, at each checkpoint */
+  void SetCatalog(Catalog *catalog) { catalog_ = catalog; }
+
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
   BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  Catalog *catalog_{nullptr};
 };
 
 }  // namespace bustub
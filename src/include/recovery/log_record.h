@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +34,8 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Appending a batch of tuples to a table page. */
+  BULKINSERT,
 };
 
 /**
@@ -57,6 +61,10 @@ enum class LogRecordType {
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For bulk insert type log record, the tuples take the slots after the last one of the page
+ *------------------------------------------------------------------------------------
+ * | HEADER | page_id | tuple_count | tuple_size | tuple_data | ... | tuple_size | tuple_data |
+ *------------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -110,6 +118,21 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for BULKINSERT type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t page_id,
+            std::vector<Tuple> tuples)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        page_id_(page_id),
+        bulk_tuples_(std::move(tuples)) {
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(page_id_t) + sizeof(uint32_t);
+    for (const auto &tuple : bulk_tuples_) {
+      size_ += sizeof(int32_t) + tuple.GetLength();
+    }
+  }
+
   ~LogRecord() = default;
 
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
@@ -128,6 +151,10 @@ class LogRecord {
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetBulkInsertPageId() { return page_id_; }
+
+  inline std::vector<Tuple> &GetBulkInsertTuples() { return bulk_tuples_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -176,6 +203,9 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for bulk insert operation, page_id_ is the page the tuples went to
+  std::vector<Tuple> bulk_tuples_;
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
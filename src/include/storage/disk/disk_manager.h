@@ -15,6 +15,7 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
 
 #include "common/config.h"
@@ -107,6 +108,8 @@ class DiskManager {
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
+  // the buffer pool reads ahead from another thread, so page I/O on db_io_ is serialized
+  std::mutex db_io_latch_;
   std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+#define ART_TYPE AdaptiveRadixTree<KeyType, ValueType>
+
+/**
+ * In-memory adaptive radix tree (Leis et al.) over the raw bytes of a fixed
+ * size key, one byte per level.
+ *
+ * Inner nodes grow from 4 to 16, 48 and 256 children as they fill up, and
+ * keep the bytes every key below them shares as a compressed prefix. A leaf
+ * hangs as high as its key is unique (lazy expansion) and holds the values
+ * of its key; a non-unique tree keeps several values per leaf.
+ *
+ * Concurrency is optimistic lock coupling: every inner node has a version,
+ * readers validate the version of a node after reading it and restart from
+ * the root if it changed, writers upgrade to a lock on the nodes they change
+ * only. Leaves are immutable, a changed leaf is replaced in its parent.
+ * Replaced nodes are reclaimed by epochs: every operation announces the
+ * global epoch in a slot of its own while it runs, and a node retired in an
+ * epoch older than every announced one is freed. Inner nodes do not shrink
+ * when keys are removed.
+ *
+ * Key bytes are not ordered like the key values, so the tree only supports
+ * point operations.
+ */
+template <typename KeyType, typename ValueType>
+class AdaptiveRadixTree {
+ public:
+  explicit AdaptiveRadixTree(bool unique_key = true);
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  // Insert a key-value pair, false if the key (unique tree) or the pair is already there
+  bool Insert(const KeyType &key, const ValueType &value);
+
+  // Remove a key-value pair, a unique tree removes the key whatever its value
+  bool Remove(const KeyType &key, const ValueType &value);
+
+  // return the values associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result);
+
+  // number of replaced nodes that are not freed yet
+  size_t GetRetiredCount();
+
+ private:
+  static constexpr size_t KEY_SIZE = sizeof(KeyType);
+
+  // version bits of an inner node
+  static constexpr uint64_t OBSOLETE_BIT = 0b01;
+  static constexpr uint64_t LOCKED_BIT = 0b10;
+
+  // epoch slots, more running operations than slots wait for a free one
+  static constexpr size_t EPOCH_SLOTS = 64;
+  // epoch of a slot no operation runs in
+  static constexpr uint64_t IDLE_EPOCH = UINT64_MAX;
+  // retired nodes that make the operation ending try to free them
+  static constexpr size_t RECLAIM_THRESHOLD = 64;
+
+  enum class NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+    NodeType type_;
+  };
+
+  struct Leaf : public Node {
+    Leaf(const KeyType &key, std::vector<ValueType> values)
+        : Node(NodeType::LEAF), key_(key), values_(std::move(values)) {}
+    KeyType key_;
+    std::vector<ValueType> values_;
+  };
+
+  struct InnerNode : public Node {
+    explicit InnerNode(NodeType type) : Node(type) {}
+    std::atomic<uint64_t> version_{0};
+    uint16_t count_{0};
+    uint8_t prefix_len_{0};
+    uint8_t prefix_[KEY_SIZE];
+  };
+
+  // Node4 and Node16, children in insertion order
+  template <uint8_t Capacity>
+  struct LinearNode : public InnerNode {
+    LinearNode() : InnerNode(Capacity == 4 ? NodeType::NODE4 : NodeType::NODE16) {}
+    uint8_t keys_[Capacity];
+    Node *children_[Capacity];
+  };
+  using Node4 = LinearNode<4>;
+  using Node16 = LinearNode<16>;
+
+  struct Node48 : public InnerNode {
+    Node48() : InnerNode(NodeType::NODE48) {}
+    // slot of the child of each byte plus one, 0 if there is none
+    uint8_t child_index_[256]{};
+    Node *children_[48]{};
+  };
+
+  struct Node256 : public InnerNode {
+    Node256() : InnerNode(NodeType::NODE256) {}
+    Node *children_[256]{};
+  };
+
+  // Each slot on its own cache line, so operations of different threads do not contend
+  struct alignas(64) EpochSlot {
+    std::atomic<uint64_t> epoch_{IDLE_EPOCH};
+  };
+
+  // Keeps the nodes the operation may reach alive until it ends
+  class OperationGuard {
+   public:
+    explicit OperationGuard(AdaptiveRadixTree *tree) : tree_(tree), slot_(tree->EnterOperation()) {}
+    ~OperationGuard() { tree_->LeaveOperation(slot_); }
+
+   private:
+    AdaptiveRadixTree *tree_;
+    EpochSlot *slot_;
+  };
+
+  // Each Try* method returns false if the operation has to restart from the root
+  bool TryInsert(const KeyType &key, const ValueType &value, bool *inserted);
+  bool TryRemove(const KeyType &key, const ValueType &value, bool *removed);
+  bool TryGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found);
+
+  static const uint8_t *KeyBytes(const KeyType &key) { return reinterpret_cast<const uint8_t *>(&key); }
+
+  // first prefix byte of node that differs from the key bytes at depth
+  static size_t PrefixMismatch(const InnerNode *node, const uint8_t *bytes, size_t depth);
+
+  static Node *FindChild(const InnerNode *node, uint8_t byte);
+  static bool IsFull(const InnerNode *node);
+  // caller checks IsFull() first
+  static void AddChild(InnerNode *node, uint8_t byte, Node *child);
+  static void ChangeChild(InnerNode *node, uint8_t byte, Node *child);
+  static void RemoveChild(InnerNode *node, uint8_t byte);
+  // a copy of node with room for one more child
+  static InnerNode *Grow(const InnerNode *node);
+
+  // optimistic lock coupling, see the class comment
+  static bool ReadLock(const InnerNode *node, uint64_t *version);
+  static bool Validate(const InnerNode *node, uint64_t version);
+  static bool Upgrade(InnerNode *node, uint64_t version);
+  static void WriteUnlock(InnerNode *node);
+  static void WriteUnlockObsolete(InnerNode *node);
+
+  static void DeleteNode(Node *node);
+  static void DeleteTree(Node *node);
+
+  // Free node once every operation that could still reach it has ended
+  void Retire(Node *node);
+  // announce the current epoch in a free slot
+  EpochSlot *EnterOperation();
+  void LeaveOperation(EpochSlot *slot);
+  // advance the epoch and free the nodes no running operation can reach
+  void Reclaim();
+
+  bool unique_key_;
+  // root is never replaced, it has no prefix and room for every byte
+  Node256 *root_;
+
+  std::atomic<uint64_t> global_epoch_{0};
+  EpochSlot epoch_slots_[EPOCH_SLOTS];
+  // size of retired_, read without the latch to decide on Reclaim()
+  std::atomic<size_t> retired_count_{0};
+  std::mutex retired_latch_;
+  // retired nodes with the epoch they were unlinked in
+  std::vector<std::pair<uint64_t, Node *>> retired_;
+};
+
+}  // namespace bustub
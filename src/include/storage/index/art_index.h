@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/art_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define ART_INDEX_TYPE ArtIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * Index backed by an adaptive radix tree kept in memory, for lookup tables
+ * that fit in memory. Supports point lookups only. Nothing is persisted, the
+ * catalog fills the index from the table heap when it is created (see
+ * Catalog::RebuildIndex()).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ArtIndex : public Index {
+ public:
+  ArtIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  bool IsPersistent() const override { return false; }
+
+ protected:
+  // container
+  AdaptiveRadixTree<KeyType, ValueType> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/b_link_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "concurrency/transaction.h"
+#include "storage/index/index.h"
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+#define BLINKTREE_TYPE BLinkTree<KeyType, ValueType, KeyComparator>
+
+/**
+ * B-link tree (Lehman & Yao), a B+ tree whose nodes carry a high key and a
+ * link to their right sibling (see b_link_tree_page.h).
+ *
+ * Nothing is latch coupled on the way down: a search holds the latch of one
+ * node at a time, so it waits on a node being split like on any other
+ * write, but never on the rest of the split. When the key it looks for is at
+ * or past the high key of a node (the node was split after its parent was
+ * read) it recovers by following the right link. A split holds the latch of
+ * the split node only until its parent is latched, so writers take at most
+ * two latches, bottom up and left to right, and never deadlock.
+ *
+ * Entries are ordered by key, then by value (record ids are compared with
+ * RID::Get()), so a non-unique tree stores a duplicated key once per value.
+ * Removes never merge nodes; a drained node stays in place and keeps routing
+ * the searches of its range.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BLinkTree {
+  using Node = BLinkTreePage<KeyType, ValueType>;
+  using Entry = typename Node::Entry;
+
+ public:
+  explicit BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                     int leaf_max_size = B_LINK_TREE_PAGE_SIZE, int internal_max_size = B_LINK_TREE_PAGE_SIZE,
+                     bool unique_key = true);
+
+  // Returns true if this B-link tree has no keys and values.
+  bool IsEmpty() const;
+
+  // Insert a key-value pair into this B-link tree.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key-value pair from this B-link tree, a unique tree removes the key whatever its value.
+  bool Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  // Collect the values of every key between low and high in key order, a
+  // nullptr bound leaves that side of the range open
+  void ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high, bool high_inclusive,
+                 std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  page_id_t GetRootPageId() const { return root_page_id_.load(); }
+
+  // Persist the root page id into the header page, see BPlusTree::FlushRootPageId().
+  bool FlushRootPageId();
+
+ private:
+  /*
+   * What a search looks for: an entry, or with value == nullptr the position
+   * before every entry of key, or with key == nullptr the start of the tree.
+   */
+  struct Probe {
+    const KeyType *key;
+    const ValueType *value;
+  };
+
+  int Compare(const Probe &probe, const Entry &entry) const;
+
+  // first entry at or past probe
+  int LowerBound(const Node *node, const Probe &probe) const;
+
+  // first entry past probe
+  int UpperBound(const Node *node, const Probe &probe) const;
+
+  bool Covers(const Node *node, const Probe &probe) const;
+
+  Page *FetchNode(page_id_t page_id);
+
+  void Latch(Page *page, bool exclusive);
+
+  void Release(Page *page, bool exclusive, bool dirty);
+
+  // Give back a page taken with NewPage that was never written, nullptr is ignored
+  void DropNewPage(Page *page);
+
+  // Follow right links from the latched page until the node covers probe
+  Page *MoveRight(Page *page, const Probe &probe, bool exclusive);
+
+  // Return the latched node at level covering probe, path receives the
+  // internal nodes read above it, from the root down
+  Page *Descend(const Probe &probe, int level, bool exclusive, std::vector<page_id_t> *path);
+
+  // Create a leaf root holding entry, unless another insert did first
+  bool StartNewTree(const Entry &entry);
+
+  // Insert entry into the write latched node, splitting up the path as needed
+  void InsertIntoNode(Page *page, Entry entry, std::vector<page_id_t> *path);
+
+  // Write latch the parent of the node that was just split, or make root_page
+  // (taken before the split when path was empty) the new root above it and
+  // return nullptr. Releases the node if it throws.
+  Page *LatchParent(Page *page, const Entry &separator, std::vector<page_id_t> *path, Page *root_page);
+
+  void UpdateRootPageId() { root_page_id_dirty_ = true; }
+
+  // member variable
+  std::string index_name_;
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  int leaf_max_size_;
+  int internal_max_size_;
+  bool unique_key_;
+  // serializes root changes
+  std::mutex root_latch_;
+  // root_page_id_ changed since the last FlushRootPageId()
+  bool root_page_id_dirty_{false};
+};
+
+}  // namespace bustub
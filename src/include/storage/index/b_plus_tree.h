@@ -10,6 +10,10 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -18,11 +22,21 @@
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * When a delete merges or redistributes an underflowed page.
+ * EAGER keeps every non-root page at least half full. LAZY lets a page drain
+ * to a quarter of its max size (a leaf until it is empty, an internal page
+ * until it has one child) before the neighbours are touched, so deletes
+ * rarely latch the parent and keys that come back find room in their old
+ * leaf. Compact() brings the pages back to half full offline.
+ */
+enum class MergePolicy { EAGER, LAZY };
 
 
 /**
@@ -30,7 +44,8 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Unique key by default, a non-unique tree keeps the values of a
+ *     duplicated key in a posting list referenced from the leaf
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
@@ -40,6 +55,7 @@ INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using PostingPage = BPlusTreePostingPage<ValueType>;
 
   static constexpr int OperatorInsert = 0;
   static constexpr int OperatorDelete = 1;
@@ -66,9 +82,17 @@ class BPlusTree {
     return AsInternalPage(TreePage(p));
   }
 
+  inline PostingPage *PageAsPostingPage(Page* p) {
+    return reinterpret_cast<PostingPage *>(p->GetData());
+  }
+
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool unique_key = true, MergePolicy merge_policy = MergePolicy::EAGER);
+
+  // Unpins the cached internal root; the tree must go away before its buffer pool manager.
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -79,14 +103,38 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one key & value pair, other values of a duplicated key are kept.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Returns true if duplicated keys are rejected.
+  bool IsUniqueKey() const { return unique_key_; }
+
+  MergePolicy GetMergePolicy() const { return merge_policy_; }
+
+  // Persist the root page id into the header page, root changes are only
+  // kept in memory until then. Called at checkpoint time.
+  bool FlushRootPageId();
+
+  // Merge or redistribute every page left below half full by lazy deletes.
+  // Blocks every other operation on the tree while it runs.
+  void Compact(Transaction *transaction);
+
+  // return the value(s) associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // look up a batch of keys in key order, (*result)[i] receives the value(s) of keys[i]
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // iterate the keys between low and high, a nullptr bound is open. A forward
+  // scan stops at high, a backward one starts at high and stops at low
+  INDEXITERATOR_TYPE ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high, bool high_inclusive,
+                               ScanDirection direction = ScanDirection::FORWARD);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -107,10 +155,32 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  Page *FindLeafPage(const KeyType &key, bool leftMost = false, Transaction* t = nullptr, int op = OperatorFind);
+  page_id_t GetRootPageId() const { return root_page_id_; }
+  Page *FindLeafPage(const KeyType &key, bool leftMost = false, Transaction* t = nullptr, int op = OperatorFind,
+                     bool rightMost = false);
 
 
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  // Read latch the leaf for key without a transaction, nullptr if the tree is empty
+  Page *FindLeafPageRead(const KeyType &key, bool leftMost = false, bool rightMost = false);
+
+  // Move the read latch to the next leaf if key sorts after every key of page,
+  // nullptr if key is not in the next leaf either
+  Page *StepRightFor(Page *page, const KeyType &key);
+
+  // Point the leaf after a split or merge back at its new left neighbour, once
+  // the writer holds no latch, see ApplyPrevLinks()
+  void RelinkPrevPageId(page_id_t page_id, page_id_t old_prev_page_id, page_id_t prev_page_id);
+
+  // Apply the prev links queued by RelinkPrevPageId(), called without latches
+  void ApplyPrevLinks();
+
+  // Latched page of page_id / its parent on the path in the page set of t
+  Page *PathPageOf(page_id_t page_id, Transaction *t);
+  Page *ParentPageOf(page_id_t page_id, Transaction *t);
+
   inline void AddInToDeletePages(Transaction*t, page_id_t p)
   {
     t->AddIntoDeletedPageSet(p );
@@ -119,10 +189,18 @@ class BPlusTree {
   inline void DeleteAllOnSet(Transaction* t)
   {
     auto set_ptr = t->GetDeletedPageSet();
+    if (!set_ptr->empty()) {
+      // a queued prev link must not land on the page once it is reused
+      std::lock_guard<std::mutex> guard(prev_links_latch_);
+      prev_links_.erase(std::remove_if(prev_links_.begin(), prev_links_.end(),
+                                       [&](const PrevLink &link) { return set_ptr->count(link.page_id_) != 0; }),
+                        prev_links_.end());
+    }
     for (auto &i : *set_ptr)
     {
       buffer_pool_manager_->DeletePage(i);
     }
+    set_ptr->clear();
   }
 
   inline void ReleaseAllLatch(Transaction* t, int op, bool dirty)
@@ -141,19 +219,36 @@ class BPlusTree {
                     break;
                 }
               } else {
-                UnlatchPage(i, op);
+                ReleasePage(i, op, dirty);
               }
-
-
-          if (i != nullptr) {
-              buffer_pool_manager_->UnpinPage(i->GetPageId(), dirty);
-          } else {
-            LOG_DEBUG("Release root latch");
-          }
       }
       t->GetPageSet()->clear();
   }
 
+  // Unlatch and unpin a page reached on the way down. The cached root keeps
+  // its pin; it is recognised while still latched, so the root can't change
+  // in between.
+  inline void ReleasePage(Page *p, int op, bool dirty) {
+    bool cached = p == root_page_.load();
+    if (cached && dirty) {
+      p->SetDirty();
+    }
+    UnlatchPage(p, op);
+    if (!cached) {
+      buffer_pool_manager_->UnpinPage(p->GetPageId(), dirty);
+    }
+  }
+
+  // Start of every descent, called with the root latch held. An internal root
+  // is handed out without a buffer pool call.
+  inline Page *FetchRootPage() {
+    Page *root = root_page_.load();
+    return root != nullptr ? root : buffer_pool_manager_->FetchPage(root_page_id_);
+  }
+
+  // Keep the new root pinned after root_page_id_ changed
+  void CacheRootPage(Transaction *t);
+
   inline bool IsSafeOperation(BPlusTreePage* node, int op)
   {
       switch (op) {
@@ -162,15 +257,20 @@ class BPlusTree {
           case OperatorUpdate:
               return true;
           case OperatorDelete:
-              if (node->IsRootPage()) {
+              if (node->GetPageId() == root_page_id_) {
                 if (!node->IsLeafPage()) return node->GetSize() > 2;
                 else return node->GetSize() > 1;
+              } else if (merge_policy_ == MergePolicy::LAZY) {
+                return node->GetSize() > LazyMinSize(node);
               } else {
-                return node->GetSize() > node->GetMinSize() + 1;
+                return node->IsLeafPage() ? AsLeafPage(node)->IsSafeToRemove()
+                                          : AsInternalPage(node)->IsSafeToRemove();
               }
           case OperatorInsert:
               // 如果是node的size 是 MaxSize() -1， 再插入则会分裂
-              return node->GetSize() < node->GetMaxSize() - 1;
+              // 压缩后的 key 也可能因为字节不够而分裂
+              return node->IsLeafPage() ? AsLeafPage(node)->IsSafeToInsert()
+                                        : AsInternalPage(node)->IsSafeToInsert();
       }
       return false;
   }
@@ -214,19 +314,40 @@ class BPlusTree {
   template <typename N>
   N *Split(N *node);
 
+  // Lazy deletes keep a page until it has fewer pairs than this
+  inline int LazyMinSize(BPlusTreePage *node) const {
+    return std::max(node->IsLeafPage() ? 1 : 2, node->GetMaxSize() / LAZY_MERGE_DIVISOR);
+  }
+
+  // Whether node has to be merged or redistributed under policy
+  bool NeedsMerge(BPlusTreePage *node, MergePolicy policy);
+
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, MergePolicy policy, Transaction *transaction = nullptr);
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, bool on_left,Transaction *transaction = nullptr);
+                int index, bool on_left, MergePolicy policy, Transaction *transaction = nullptr);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index, bool on_left);
+  bool Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index, bool on_left);
+
+  KeyType ShortestSeparator(const KeyType &left_key, const KeyType &right_key) const;
 
   bool AdjustRoot(BPlusTreePage *node, Transaction* t);
 
-  void UpdateRootPageId(int insert_record = 0);
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  /* Posting list of a duplicated key, guarded by the latch of the owning leaf */
+  bool AppendToPostingList(LeafPage *leaf_node, int index, const ValueType &value);
+
+  bool RemoveFromPostingList(LeafPage *leaf_node, int index, const ValueType &value);
+
+  void CollectPostingList(page_id_t page_id, std::vector<ValueType> *result);
+
+  void DeletePostingList(page_id_t page_id);
+
+  void UpdateRootPageId();
 
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
@@ -236,12 +357,27 @@ class BPlusTree {
   // member variable
   std::string index_name_;
   page_id_t root_page_id_;
+  // root_page_id_ stays pinned here while it is an internal page
+  std::atomic<Page *> root_page_{nullptr};
+  // root_page_id_ changed since the last FlushRootPageId()
+  bool root_page_id_dirty_{false};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_key_;
+  MergePolicy merge_policy_;
 
   ReaderWriterLatch root_latch_;
+
+  // a leaf whose prev link still names old_prev_page_id_ gets prev_page_id_
+  struct PrevLink {
+    page_id_t page_id_;
+    page_id_t old_prev_page_id_;
+    page_id_t prev_page_id_;
+  };
+  std::mutex prev_links_latch_;
+  std::deque<PrevLink> prev_links_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -27,16 +28,35 @@ class BPlusTreeIndex : public Index {
  public:
   BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
 
+  ~BPlusTreeIndex() override;
+
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  void ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                 ScanDirection direction, std::vector<RID> *result, Transaction *transaction) override;
+
+  bool SupportsRangeScan() const override { return true; }
+
+  std::unique_ptr<IndexRangeCursor> OpenRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                              bool high_inclusive, ScanDirection direction,
+                                              Transaction *transaction) override;
+
+  void Checkpoint() override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
+  INDEXITERATOR_TYPE GetRangeIterator(const KeyType *low, bool low_inclusive, const KeyType *high,
+                                      bool high_inclusive, ScanDirection direction = ScanDirection::FORWARD);
+
   INDEXITERATOR_TYPE GetEndIterator();
 
  protected:
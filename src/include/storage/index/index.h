@@ -12,17 +12,56 @@
 
 #pragma once
 
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
 namespace bustub {
 
+/** Order in which a range scan returns the keys */
+enum class ScanDirection { FORWARD, BACKWARD };
+
+/**
+ * Hands out the RIDs of a range scan one at a time, see Index::OpenRange().
+ * A cursor holds no latches between calls, so the caller may modify the
+ * index while the scan is open.
+ */
+class IndexRangeCursor {
+ public:
+  virtual ~IndexRangeCursor() = default;
+
+  /** @return false once every RID of the range has been returned */
+  virtual bool Next(RID *rid) = 0;
+};
+
+/** Cursor over RIDs that were collected up front */
+class MaterializedRangeCursor : public IndexRangeCursor {
+ public:
+  explicit MaterializedRangeCursor(std::vector<RID> rids) : rids_(std::move(rids)) {}
+
+  bool Next(RID *rid) override {
+    if (cursor_ >= rids_.size()) {
+      return false;
+    }
+    *rid = rids_[cursor_++];
+    return true;
+  }
+
+ private:
+  std::vector<RID> rids_;
+  size_t cursor_{0};
+};
+
+/** Structure behind an index, see Catalog::CreateIndex() */
+enum class IndexType { BPLUSTREE, BLINKTREE, ART, LINEAR_PROBE_HASH, EXTENDIBLE_HASH };
+
 /**
  * class IndexMetadata - Holds metadata of an index object
  *
@@ -37,8 +76,11 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -60,6 +102,9 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns false if several tuples may share the same index key
+  inline bool IsUnique() const { return is_unique_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -67,6 +112,7 @@ class IndexMetadata {
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
        << "Type = B+Tree, "
+       << "Unique = " << is_unique_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -78,6 +124,8 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // false if duplicated keys are allowed
+  const bool is_unique_;
   // schema of the indexed key
   Schema *key_schema_;
 };
@@ -137,6 +185,63 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Look up a batch of keys, (*results)[i] receives the RIDs of keys[i]. The
+   * default probes the keys one at a time.
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), std::vector<RID>{});
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  /**
+   * Collect the RIDs of every key between low_key and high_key in the given
+   * direction. A nullptr bound leaves that side of the range open. Only
+   * ordered indexes support range scans.
+   */
+  virtual void ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                         ScanDirection direction, std::vector<RID> *result, Transaction *transaction) {
+    throw NotImplementedException("range scan is not supported by this index");
+  }
+
+  /**
+   * Open a cursor over the same RIDs ScanRange() returns. The default collects
+   * them all up front, ordered indexes read them lazily as the cursor moves.
+   * A range of a single key is looked up with ScanKey(), so every index
+   * serves it.
+   */
+  virtual std::unique_ptr<IndexRangeCursor> OpenRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                                      bool high_inclusive, ScanDirection direction,
+                                                      Transaction *transaction) {
+    std::vector<RID> rids;
+    if (low_key != nullptr && high_key != nullptr && low_inclusive && high_inclusive &&
+        low_key->GetLength() == high_key->GetLength() &&
+        memcmp(low_key->GetData(), high_key->GetData(), low_key->GetLength()) == 0) {
+      ScanKey(*low_key, &rids, transaction);
+    } else {
+      ScanRange(low_key, low_inclusive, high_key, high_inclusive, direction, &rids, transaction);
+    }
+    return std::make_unique<MaterializedRangeCursor>(std::move(rids));
+  }
+
+  /** @return true if ScanRange() and OpenRange() accept any range, not only a single key */
+  virtual bool SupportsRangeScan() const { return false; }
+
+  /**
+   * Persist what the index keeps in memory between checkpoints, such as the
+   * root page id of a tree. Called at checkpoint time.
+   */
+  virtual void Checkpoint() {}
+
+  /**
+   * @return false if the index only lives in memory, the catalog rebuilds it
+   * from the table heap when it is created
+   */
+  virtual bool IsPersistent() const { return true; }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
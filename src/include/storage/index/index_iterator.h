@@ -13,20 +13,42 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "storage/index/index.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Walks the leaf chain in either direction. A forward iterator may stop at an
+ * upper bound and a backward one at a lower bound; once the current leaf ends
+ * at or past the bound the next leaf is not read at all.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(Page* p, BufferPoolManager* bpm, int idx);
+  // Start at index of the read latched and pinned leaf p, an index past either
+  // end of the leaf continues in the neighbouring leaf
+  IndexIterator(Tree *tree, Page *p, int idx, ScanDirection direction = ScanDirection::FORWARD,
+                const KeyType *bound = nullptr, bool bound_inclusive = true);
   ~IndexIterator();
 
+  // The iterator owns the read latch and the pin of its leaf, so it can only be moved
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   bool isEnd();
 
   const MappingType &operator*();
@@ -45,13 +67,58 @@ class IndexIterator {
 
   inline bool is_same(const IndexIterator& itr) const {
     if (page_id_ == INVALID_PAGE_ID && itr.page_id_ == page_id_) return true;
-    return page_id_ == itr.page_id_ && index_at_page_ == itr.index_at_page_;
+    return page_id_ == itr.page_id_ && index_at_page_ == itr.index_at_page_ &&
+           PostingPageId() == itr.PostingPageId() && posting_index_ == itr.posting_index_;
+  }
+
+  inline page_id_t PostingPageId() const {
+    return posting_page_ == nullptr ? INVALID_PAGE_ID : posting_page_->GetPageId();
   }
 
+  inline LeafPage *Leaf() const { return reinterpret_cast<LeafPage *>(page_->GetData()); }
+
+  // Whether key is on the near side of the bound
+  bool InBound(const KeyType &key) const;
+
+  // Move index_at_page_ onto an entry of a leaf, stepping through the leaf
+  // chain if needed, or end the iteration
+  void Settle();
+
+  void NextLeaf();
+  void PrevLeaf();
+
+  // Read the next leaves in the scan direction in the background, unless the
+  // scan ends in the current leaf
+  void ReadAhead();
+
+  static page_id_t NextLeafPageId(const char *page_data);
+  static page_id_t PrevLeafPageId(const char *page_data);
+
+  // Pin the posting list of the current leaf entry, if it has one
+  void EnterEntry();
+
+  // Unlatch and unpin everything the iterator holds
+  void Release();
+
+  // Release and become the end iterator
+  void SetEnd();
+
+  Tree *tree_;
   BufferPoolManager* buffer_pool_;
   Page*page_;
   int index_at_page_;
   page_id_t page_id_;
+  // Posting page of the current entry of a duplicated key, protected by the leaf latch
+  Page *posting_page_;
+  int posting_index_;
+  MappingType item_;
+  ScanDirection direction_;
+  // upper bound of a forward scan, lower bound of a backward one
+  bool has_bound_;
+  KeyType bound_;
+  bool bound_inclusive_;
+  // leaf the last read ahead was issued from
+  page_id_t read_ahead_page_id_;
 };
 
 }  // namespace bustub
@@ -38,6 +38,9 @@ class LinearProbeHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  // The table is created anew with the index, see Catalog::RebuildIndex
+  bool IsPersistent() const override { return false; }
+
  protected:
   // comparator for key
   KeyComparator comparator_;
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_link_tree_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_LINK_TREE_PAGE_TYPE BLinkTreePage<KeyType, ValueType>
+#define B_LINK_TREE_PAGE_HEADER_SIZE 24
+#define B_LINK_TREE_ENTRY_SIZE (sizeof(KeyType) + sizeof(ValueType) + sizeof(page_id_t))
+// one entry of the page is taken by the high key
+#define B_LINK_TREE_PAGE_SIZE ((PAGE_SIZE - B_LINK_TREE_PAGE_HEADER_SIZE) / B_LINK_TREE_ENTRY_SIZE - 1)
+
+/**
+ * Node of a B-link tree (see b_link_tree.h), used for both leaves and
+ * internal nodes.
+ *
+ * Every node covers the entries from the separator its parent routes to it
+ * (excluded for the leftmost node of a level) up to its high key, and links
+ * to its right sibling on the same level, which covers the entries from that
+ * high key on. The rightmost node of a level has no right sibling and no high
+ * key. A node that was split keeps the left half, so whoever reached it
+ * before the split finds the rest through the right link.
+ *
+ * Entries are (key, value) pairs sorted by key, then by value. A leaf entry
+ * holds a record id; an internal entry also holds the child covering the
+ * entries from it up to the next entry. The key and value of the first
+ * internal entry are not used.
+ *
+ * Page format (entries are stored in order):
+ *  -----------------------------------------------------------------------
+ * | HEADER | HIGH_KEY | KEY(1) + VALUE(1) + CHILD(1) | ... | KEY(n) + VALUE(n) + CHILD(n)
+ *  -----------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 24 bytes in total):
+ *  -----------------------------------------------------------------------
+ * | LSN (4) | CurrentSize (4) | MaxSize (4) | PageId (4) | Level (4) | RightPageId (4) |
+ *  -----------------------------------------------------------------------
+ *
+ * Level is 0 for leaves and grows towards the root.
+ */
+template <typename KeyType, typename ValueType>
+class BLinkTreePage {
+ public:
+  struct Entry {
+    KeyType key;
+    ValueType value;
+    // child of an internal entry, unused in leaves
+    page_id_t child;
+  };
+
+  // After creating a new page from buffer pool, must call initialize
+  // method to set default values
+  void Init(page_id_t page_id, int level, int max_size = B_LINK_TREE_PAGE_SIZE);
+
+  page_id_t GetPageId() const;
+  int GetLevel() const;
+  bool IsLeafPage() const;
+
+  int GetSize() const;
+  int GetMaxSize() const;
+  bool IsFull() const;
+
+  page_id_t GetRightPageId() const;
+  // The high key is only valid if the node has a right sibling
+  bool HasHighKey() const;
+  const Entry &HighKey() const;
+
+  const Entry &EntryAt(int index) const;
+  void InsertAt(int index, const Entry &entry);
+  void RemoveAt(int index);
+
+  // Move the upper half of the entries to the new right sibling recipient,
+  // whose first entry becomes the high key of this node
+  void MoveHalfTo(BLinkTreePage *recipient);
+
+ private:
+  lsn_t lsn_ __attribute__((__unused__));
+  int size_;
+  int max_size_;
+  page_id_t page_id_;
+  int level_;
+  page_id_t right_page_id_;
+  Entry high_key_;
+  // Flexible array member for page data.
+  Entry array_[1];
+};
+
+}  // namespace bustub
@@ -11,13 +11,17 @@
 #pragma once
 
 #include <queue>
+#include <vector>
 
+#include "storage/page/b_plus_tree_key_codec.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_CAPACITY (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE)
+// a split always leaves both halves small enough to hold uncompressed keys
+#define INTERNAL_PAGE_SIZE (2 * (INTERNAL_PAGE_CAPACITY / sizeof(MappingType)) - 1)
 
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
@@ -27,19 +31,24 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
+ * Keys are packed like in the leaf page (see b_plus_tree_key_codec.h), the
+ * first key is packed as well and is kept close to its neighbours so it does
+ * not cut the shared prefix short.
+ *
  * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------------
+ * | HEADER | PREFIX | KEY_SUFFIX(1)+PAGE_ID(1) | ... | KEY_SUFFIX(n)+PAGE_ID(n) |
+ *  --------------------------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = INTERNAL_PAGE_SIZE);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
+  bool CanSetKeyAt(int index, const KeyType &key) const;
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
 
@@ -49,13 +58,18 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
+  // space accounting of the packed keys
+  bool HasRoomFor(const KeyType &key) const;
+  bool IsSafeToInsert() const;
+  bool IsSafeToRemove() const;
+  bool IsUnderflow() const;
+  bool CanMergeFrom(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const;
+
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                        BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                         BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  bool MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  bool MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
   /**
    * If sibling node is on left, return true
@@ -84,14 +98,13 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  using KeyCodec = BPlusTreeKeyCodec<KeyType, ValueType>;
 
+  KeyCodec Codec() const {
+    return KeyCodec(const_cast<BPlusTreeInternalPage *>(this), const_cast<char *>(data_), INTERNAL_PAGE_CAPACITY);
+  }
 
-
-
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  MappingType array[0];
-  
+  void CopyNFrom(const std::vector<MappingType> &items);
+  char data_[0];
 };
 }  // namespace bustub
@@ -0,0 +1,315 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_codec.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+/**
+ * Packs the key & value pairs of a leaf or internal page.
+ *
+ * Keys of one page usually share a long prefix (composite keys with the same
+ * leading columns) and end with zero padding (GenericKey<64> holding a short
+ * tuple). The bytes every key of the page starts with are stored once, and a
+ * slot only keeps the KeyWidth bytes after them; anything past
+ * KeyPrefixSize + KeyWidth is zero for every key of the page.
+ *
+ * Slot area format (slots are KeyWidth + sizeof(ValueType) bytes):
+ *  ---------------------------------------------------------------------
+ * | PREFIX | KEY_SUFFIX(1) + VALUE(1) | ... | KEY_SUFFIX(n) + VALUE(n)
+ *  ---------------------------------------------------------------------
+ *
+ * Adding a key the layout can not describe re-packs the page with a shorter
+ * prefix and/or a wider slot, which can run out of space before the page
+ * reaches its max size. Removing keys never re-packs, the layout stays valid.
+ */
+template <typename KeyType, typename ValueType>
+class BPlusTreeKeyCodec {
+ public:
+  BPlusTreeKeyCodec(BPlusTreePage *page, char *data, size_t capacity)
+      : page_(page), data_(data), capacity_(capacity) {}
+
+  // bytes taken by one slot of a page whose keys share nothing
+  static constexpr size_t FULL_SLOT_SIZE = sizeof(KeyType) + sizeof(ValueType);
+
+  size_t SlotSize() const { return page_->GetKeyWidth() + sizeof(ValueType); }
+  size_t UsedBytes() const { return page_->GetKeyPrefixSize() + page_->GetSize() * SlotSize(); }
+  size_t Capacity() const { return capacity_; }
+
+  KeyType KeyAt(int index) const {
+    KeyType key;
+    auto raw = reinterpret_cast<char *>(&key);
+    size_t prefix = page_->GetKeyPrefixSize();
+    size_t width = page_->GetKeyWidth();
+    memcpy(raw, data_, prefix);
+    memcpy(raw + prefix, Slot(index), width);
+    memset(raw + prefix + width, 0, sizeof(KeyType) - prefix - width);
+    return key;
+  }
+
+  /*
+   * Binary searches over the packed keys, the bounds of KeyComparator order:
+   * LowerBound is the first index from begin whose key is >= key, UpperBound
+   * the first one whose key is > key.
+   */
+  template <typename KeyComparator>
+  int LowerBound(int begin, const KeyType &key, const KeyComparator &comparator) const {
+    return Search(begin, SlotComparator<KeyComparator>(*this, key, comparator), false);
+  }
+
+  template <typename KeyComparator>
+  int UpperBound(int begin, const KeyType &key, const KeyComparator &comparator) const {
+    return Search(begin, SlotComparator<KeyComparator>(*this, key, comparator), true);
+  }
+
+  // comparator(KeyAt(index), key), without building the key when it holds the same bytes
+  template <typename KeyComparator>
+  int CompareAt(int index, const KeyType &key, const KeyComparator &comparator) const {
+    return SlotComparator<KeyComparator>(*this, key, comparator)(index);
+  }
+
+  ValueType ValueAt(int index) const {
+    ValueType value;
+    memcpy(reinterpret_cast<char *>(&value), Slot(index) + page_->GetKeyWidth(), sizeof(ValueType));
+    return value;
+  }
+
+  void SetValueAt(int index, const ValueType &value) {
+    memcpy(Slot(index) + page_->GetKeyWidth(), reinterpret_cast<const char *>(&value), sizeof(ValueType));
+  }
+
+  std::vector<MappingType> Items(int begin, int end) const {
+    std::vector<MappingType> items;
+    items.reserve(end - begin);
+    for (int i = begin; i < end; ++i) {
+      items.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    return items;
+  }
+
+  /*
+   * @return false if the page has no room for key, the page is left untouched
+   */
+  bool SetKeyAt(int index, const KeyType &key) {
+    if (Encodable(key)) {
+      WriteSlot(index, key, ValueAt(index));
+      return true;
+    }
+    auto items = Items(0, page_->GetSize());
+    items[index].first = key;
+    if (!Fits(items)) {
+      return false;
+    }
+    Assign(items);
+    return true;
+  }
+
+  bool CanSetKeyAt(int index, const KeyType &key) const {
+    if (Encodable(key)) {
+      return true;
+    }
+    auto items = Items(0, page_->GetSize());
+    items[index].first = key;
+    return Fits(items);
+  }
+
+  /*
+   * Conservative check, the exact layout computed by Insert() may be smaller
+   */
+  bool CanInsert(const KeyType &key) const {
+    size_t prefix = page_->GetKeyPrefixSize();
+    size_t size = page_->GetSize();
+    if (Encodable(key)) {
+      return prefix + (size + 1) * SlotSize() <= capacity_;
+    }
+    auto raw = reinterpret_cast<const char *>(&key);
+    size_t new_prefix = CommonPrefix(data_, raw, prefix);
+    size_t end = std::max(prefix + page_->GetKeyWidth(), SignificantSize(raw));
+    size_t new_width = std::max(end, new_prefix) - new_prefix;
+    return new_prefix + (size + 1) * (new_width + sizeof(ValueType)) <= capacity_;
+  }
+
+  /*
+   * Insert key & value pair at index, re-packing the page if needed
+   * @return false if the page has no room for the pair, the page is left untouched
+   */
+  bool Insert(int index, const KeyType &key, const ValueType &value) {
+    int size = page_->GetSize();
+    size_t slot_size = SlotSize();
+    if (Encodable(key) && UsedBytes() + slot_size <= capacity_) {
+      memmove(Slot(index) + slot_size, Slot(index), (size - index) * slot_size);
+      WriteSlot(index, key, value);
+      page_->IncreaseSize(1);
+      return true;
+    }
+    auto items = Items(0, size);
+    items.insert(items.begin() + index, MappingType{key, value});
+    if (!Fits(items)) {
+      return false;
+    }
+    Assign(items);
+    return true;
+  }
+
+  void Remove(int index) {
+    int size = page_->GetSize();
+    size_t slot_size = SlotSize();
+    memmove(Slot(index), Slot(index) + slot_size, (size - index - 1) * slot_size);
+    page_->IncreaseSize(-1);
+    if (size == 1) {
+      page_->SetKeyPrefixSize(0);
+      page_->SetKeyWidth(0);
+    }
+  }
+
+  bool Fits(const std::vector<MappingType> &items) const {
+    size_t prefix;
+    size_t width;
+    Layout(items, &prefix, &width);
+    return prefix + items.size() * (width + sizeof(ValueType)) <= capacity_;
+  }
+
+  /*
+   * Replace the content of the page with items, using the tightest layout.
+   * Caller checks Fits() first.
+   */
+  void Assign(const std::vector<MappingType> &items) {
+    size_t prefix;
+    size_t width;
+    Layout(items, &prefix, &width);
+    page_->SetKeyPrefixSize(static_cast<uint16_t>(prefix));
+    page_->SetKeyWidth(static_cast<uint16_t>(width));
+    page_->SetSize(static_cast<int>(items.size()));
+    if (!items.empty()) {
+      memcpy(data_, reinterpret_cast<const char *>(&items[0].first), prefix);
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+      WriteSlot(static_cast<int>(i), items[i].first, items[i].second);
+    }
+  }
+
+ private:
+  /*
+   * Compares the slots of the page with one search key. The prefix and the
+   * zero tail are written into a scratch key once, a slot then only copies its
+   * suffix in. A key encodable on the page whose suffix matches the slot bytes
+   * is equal without asking the comparator.
+   */
+  template <typename KeyComparator>
+  class SlotComparator {
+   public:
+    SlotComparator(const BPlusTreeKeyCodec &codec, const KeyType &key, const KeyComparator &comparator)
+        : codec_(codec), key_(key), comparator_(comparator), encodable_(codec.Encodable(key)) {
+      auto raw = reinterpret_cast<char *>(&scratch_);
+      size_t prefix = codec.page_->GetKeyPrefixSize();
+      size_t width = codec.page_->GetKeyWidth();
+      memcpy(raw, codec.data_, prefix);
+      memset(raw + prefix + width, 0, sizeof(KeyType) - prefix - width);
+    }
+
+    int operator()(int index) {
+      const char *slot = codec_.Slot(index);
+      size_t prefix = codec_.page_->GetKeyPrefixSize();
+      size_t width = codec_.page_->GetKeyWidth();
+      if (encodable_ && memcmp(reinterpret_cast<const char *>(&key_) + prefix, slot, width) == 0) {
+        return 0;
+      }
+      memcpy(reinterpret_cast<char *>(&scratch_) + prefix, slot, width);
+      return comparator_(scratch_, key_);
+    }
+
+   private:
+    const BPlusTreeKeyCodec &codec_;
+    const KeyType &key_;
+    const KeyComparator &comparator_;
+    bool encodable_;
+    KeyType scratch_;
+  };
+
+  template <typename Compare>
+  int Search(int begin, Compare compare, bool upper) const {
+    int low = begin;
+    int high = page_->GetSize();
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      int result = compare(mid);
+      if (result > 0 || (result == 0 && !upper)) {
+        high = mid;
+      } else {
+        low = mid + 1;
+      }
+    }
+    return low;
+  }
+
+  char *Slot(int index) const { return data_ + page_->GetKeyPrefixSize() + index * SlotSize(); }
+
+  void WriteSlot(int index, const KeyType &key, const ValueType &value) {
+    char *slot = Slot(index);
+    size_t width = page_->GetKeyWidth();
+    memcpy(slot, reinterpret_cast<const char *>(&key) + page_->GetKeyPrefixSize(), width);
+    memcpy(slot + width, reinterpret_cast<const char *>(&value), sizeof(ValueType));
+  }
+
+  // key starts with the page prefix and has nothing but zeros after the slot
+  bool Encodable(const KeyType &key) const {
+    auto raw = reinterpret_cast<const char *>(&key);
+    size_t prefix = page_->GetKeyPrefixSize();
+    return memcmp(raw, data_, prefix) == 0 && SignificantSize(raw) <= prefix + page_->GetKeyWidth();
+  }
+
+  static size_t CommonPrefix(const char *lhs, const char *rhs, size_t limit) {
+    size_t size = 0;
+    while (size < limit && lhs[size] == rhs[size]) {
+      ++size;
+    }
+    return size;
+  }
+
+  // number of bytes up to the last non-zero one
+  static size_t SignificantSize(const char *raw) {
+    size_t size = sizeof(KeyType);
+    while (size > 0 && raw[size - 1] == 0) {
+      --size;
+    }
+    return size;
+  }
+
+  static void Layout(const std::vector<MappingType> &items, size_t *prefix, size_t *width) {
+    if (items.empty()) {
+      *prefix = 0;
+      *width = 0;
+      return;
+    }
+    auto first = reinterpret_cast<const char *>(&items[0].first);
+    size_t common = sizeof(KeyType);
+    size_t end = 0;
+    for (const auto &item : items) {
+      auto raw = reinterpret_cast<const char *>(&item.first);
+      common = CommonPrefix(first, raw, common);
+      end = std::max(end, SignificantSize(raw));
+    }
+    *prefix = common;
+    *width = std::max(end, common) - common;
+  }
+
+  BPlusTreePage *page_;
+  char *data_;
+  size_t capacity_;
+};
+
+}  // namespace bustub
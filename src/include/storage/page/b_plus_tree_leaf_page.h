@@ -13,44 +13,68 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_key_codec.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_CAPACITY (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE)
+// a split always leaves both halves small enough to hold uncompressed keys
+#define LEAF_PAGE_SIZE (2 * (LEAF_PAGE_CAPACITY / sizeof(MappingType)) - 1)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within a leaf; a non-unique tree keeps the values of
+ * a duplicated key in a posting list (see b_plus_tree_posting_page.h) and
+ * stores a reference to it as the value.
+ *
+ * Keys are prefix compressed (see b_plus_tree_key_codec.h), so a page whose
+ * keys share a prefix or end with padding holds more than MaxSize / 2 pairs.
+ * A page can also run out of bytes before it reaches MaxSize, check
+ * HasRoomFor() before inserting.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ * | HEADER | PREFIX | KEY_SUFFIX(1) + RID(1) | ... | KEY_SUFFIX(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ---------------------------------------------------------------------------
+ * | PageId (4) | KeyPrefixSize (2) | KeyWidth (2) | NextPageId (4) | PrevPageId (4) |
+ *  ---------------------------------------------------------------------------
+ *
+ * Leaves are doubly linked so range scans can run backwards.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, int max_size = LEAF_PAGE_SIZE);
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  int CompareKeyAt(int index, const KeyType &key, const KeyComparator &comparator) const;
+  MappingType GetItem(int index) const;
+
+  // space accounting of the packed keys
+  bool HasRoomFor(const KeyType &key) const;
+  bool IsSafeToInsert() const;
+  bool IsSafeToRemove() const;
+  bool IsUnderflow() const;
+  bool CanMergeFrom(const BPlusTreeLeafPage *sibling) const;
 
   // insert and delete methods
   void Remove(int index);
@@ -61,15 +85,21 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  bool MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  bool MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
+  using KeyCodec = BPlusTreeKeyCodec<KeyType, ValueType>;
+
+  KeyCodec Codec() const {
+    return KeyCodec(const_cast<BPlusTreeLeafPage *>(this), const_cast<char *>(data_), LEAF_PAGE_CAPACITY);
+  }
 
-  void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  void CopyNFrom(const std::vector<MappingType> &items);
+  bool CopyLastFrom(const MappingType &item);
+  bool CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
-  MappingType array[0];
+  page_id_t prev_page_id_;
+  char data_[0];
 };
 }  // namespace bustub
@@ -37,13 +37,19 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | PageId(4) | KeyPrefixSize (2) | KeyWidth (2) |
  * ----------------------------------------------------------------------------
+ *
+ * KeyPrefixSize and KeyWidth describe how the keys of the page are packed,
+ * see b_plus_tree_key_codec.h.
+ *
+ * Pages keep no parent page id. Whoever splits or merges a page reaches it
+ * from the root and finds its parent on that path, so moving children to
+ * another internal page never has to rewrite the children.
  */
 class BPlusTreePage {
  public:
   bool IsLeafPage() const;
-  bool IsRootPage() const;
   void SetPageType(IndexPageType page_type);
 
   int GetSize() const;
@@ -54,22 +60,26 @@ class BPlusTreePage {
   void SetMaxSize(int max_size);
   int GetMinSize() const;
 
-  page_id_t GetParentPageId() const;
-  void SetParentPageId(page_id_t parent_page_id);
-
   page_id_t GetPageId() const;
   void SetPageId(page_id_t page_id);
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  uint16_t GetKeyPrefixSize() const;
+  void SetKeyPrefixSize(uint16_t prefix_size);
+
+  uint16_t GetKeyWidth() const;
+  void SetKeyWidth(uint16_t width);
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
   lsn_t lsn_ __attribute__((__unused__));
   int size_ __attribute__((__unused__));
   int max_size_ __attribute__((__unused__));
-  page_id_t parent_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
+  uint16_t key_prefix_size_ __attribute__((__unused__));
+  uint16_t key_width_ __attribute__((__unused__));
 };
 
 }  // namespace bustub
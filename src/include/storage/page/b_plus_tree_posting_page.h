@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <climits>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_POSTING_PAGE_TYPE BPlusTreePostingPage<ValueType>
+#define POSTING_PAGE_HEADER_SIZE 20
+#define POSTING_PAGE_SIZE ((PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / sizeof(ValueType))
+
+/**
+ * Slot number used by a leaf value that does not point at a tuple but at the
+ * first page of a posting list. Real tuples never use this slot.
+ */
+static constexpr uint32_t POSTING_LIST_SLOT = UINT32_MAX;
+
+/** @return true if the leaf value refers to a posting list instead of a tuple */
+inline bool IsPostingList(const RID &value) { return value.GetSlotNum() == POSTING_LIST_SLOT; }
+
+/** @return the leaf value that refers to the posting list starting at page_id */
+inline RID MakePostingListValue(page_id_t page_id) { return RID{page_id, POSTING_LIST_SLOT}; }
+
+/** @return the first page of the posting list the leaf value refers to */
+inline page_id_t PostingListPageId(const RID &value) { return value.GetPageId(); }
+
+/** Order of the values inside a posting list */
+inline bool PostingValueLess(const RID &left, const RID &right) { return left.Get() < right.Get(); }
+
+/**
+ * Overflow page holding all values of one duplicated key in a non-unique
+ * B+ tree. The leaf keeps the key once and stores a reference to the first
+ * posting page instead of a single value; hot keys chain more pages through
+ * NextPageId. Posting pages are protected by the latch of the owning leaf.
+ *
+ * Values are kept sorted across the whole chain: every value of a page is
+ * smaller than every value of the next one, so lookups stop at the first page
+ * whose last value is not smaller than the value searched for. The head page
+ * also remembers the last page of the chain (TailPageId) so that values
+ * arriving in increasing order are appended without walking the chain.
+ *
+ * Posting page format (values are sorted):
+ *  -----------------------------------------------------------
+ * | HEADER | VALUE(1) | VALUE(2) | ... | VALUE(n)
+ *  -----------------------------------------------------------
+ *
+ *  Header format (size in byte, 20 bytes in total):
+ *  -----------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | TailPageId (4) | CurrentSize (4) | MaxSize (4) |
+ *  -----------------------------------------------------------------------------
+ */
+template <typename ValueType>
+class BPlusTreePostingPage {
+ public:
+  // must call initialize method after "create" a new posting page
+  void Init(page_id_t page_id, int max_size = POSTING_PAGE_SIZE);
+
+  page_id_t GetPageId() const;
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  // only meaningful on the head page of a chain
+  page_id_t GetTailPageId() const;
+  void SetTailPageId(page_id_t tail_page_id);
+
+  int GetSize() const;
+  int GetMaxSize() const;
+  bool IsFull() const;
+
+  ValueType ValueAt(int index) const;
+  int ValueIndex(const ValueType &value) const;
+  // index of the first value not smaller than value
+  int LowerBound(const ValueType &value) const;
+
+  // append a value larger than every stored one, caller checks IsFull() first
+  void Append(const ValueType &value);
+  // insert value at its sorted position, caller checks IsFull() first
+  void Insert(const ValueType &value);
+  // remove the value at index, keeping the rest sorted
+  void Remove(int index);
+  // move the upper half of the values to the (empty) page following this one
+  void MoveHalfTo(BPlusTreePostingPage *recipient);
+
+ private:
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  page_id_t tail_page_id_;
+  int size_;
+  int max_size_;
+  ValueType array_[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,281 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page.h
+//
+// Identification: src/include/storage/page/compressed_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/page/page.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** How a column of a CompressedPage is encoded */
+enum class ColumnEncoding : uint8_t {
+  /** the fixed-size values one after the other */
+  PLAIN = 0,
+  /** integers stored as codes relative to the smallest value of the page (frame of reference) */
+  FRAME_OF_REFERENCE = 1,
+  /** varchars stored as codes into a dictionary of the distinct values of the page */
+  DICTIONARY = 2,
+};
+
+/** How the codes of a FRAME_OF_REFERENCE or DICTIONARY column are stored */
+enum class CodeLayout : uint8_t {
+  /** each code in the bits needed by the largest one */
+  PACKED = 0,
+  /** runs of rows with the same code (run-length encoding) */
+  RUNS = 1,
+};
+
+/**
+ * Compressed page format: the tuples of the page are stored column by column, each column with the lightest encoding
+ * that fits its values. Integer columns (BOOLEAN to BIGINT) use frame-of-reference codes, varchar columns codes into a
+ * per-page dictionary, and the codes are bit-packed or run-length encoded, whichever is smaller. The other columns
+ * are stored plain.
+ *  ------------------------------------------------------------------
+ *  | HEADER | ROW STATUS | COLUMN(1) | ... | COLUMN(n) | FREE SPACE |
+ *  ------------------------------------------------------------------
+ *
+ *  Header format (size in bytes), the first 16 bytes are laid out like the header of a TablePage:
+ *  -------------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| TupleCount (4) | ColumnCount (4) | Size (4) |
+ *  -------------------------------------------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ *  | Flags (4) | Col_1 type (4) | Col_1 width (4) | Col_1 offset (4) | ... |
+ *  ----------------------------------------------------------------------------------------------
+ *
+ * The row status of a slot is one byte: free, live, or marked as deleted. Slot numbers stay stable, so a change of
+ * the rows re-encodes the whole page: an insert decodes the page, adds the row and encodes it again, and fails if the
+ * encoded rows do not fit anymore. The page is then sealed until a delete is applied. Loading a table with
+ * TableHeap::BulkInsert encodes a page once per batch instead.
+ *
+ * Column blocks (size in bytes):
+ *  PLAIN:              | Encoding (1) | pad (3) | values ... |
+ *  FRAME_OF_REFERENCE: | Encoding (1) | Layout (1) | Bits (1) | pad (1) | Base (8) | codes ... |
+ *  DICTIONARY:         | Encoding (1) | Layout (1) | Bits (1) | pad (1) | Count (4) | CodesOffset (4) |
+ *                      | entry offsets (4 * Count) | entries ... | codes ... |
+ * A dictionary entry is a varchar payload as in Tuple (length and bytes). Packed codes take Bits bits each. Runs are
+ * | RunCount (4) | then per run | End (2) | code (ceil(Bits / 8)) |, End being the slot after the run.
+ */
+class CompressedPage : public Page {
+ public:
+  /**
+   * Initialize the CompressedPage header.
+   * @param page_id the page ID of this table page
+   * @param page_size the size of this table page
+   * @param prev_page_id the previous table page ID
+   * @param log_manager the log manager in use
+   * @param txn the transaction that this page is created in
+   * @param column_types the type of each column
+   */
+  void Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager, Transaction *txn,
+            const std::vector<TypeId> &column_types);
+
+  /** @return the type of each column of the schema */
+  static std::vector<TypeId> ColumnTypes(const Schema &schema);
+
+  /** @return the page ID of this table page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the previous table page */
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  /** @return the page ID of the next table page */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the previous page in the table. */
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of columns of the tuples */
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  /** @return the type of a column */
+  TypeId GetColumnType(uint32_t column_idx) {
+    return static_cast<TypeId>(*reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * column_idx));
+  }
+
+  /** @return the encoding of a column */
+  ColumnEncoding GetColumnEncoding(uint32_t column_idx) {
+    return static_cast<ColumnEncoding>(*GetColumnBlock(column_idx));
+  }
+
+  /** @return the layout of the codes of a FRAME_OF_REFERENCE or DICTIONARY column */
+  CodeLayout GetCodeLayout(uint32_t column_idx) { return static_cast<CodeLayout>(GetColumnBlock(column_idx)[1]); }
+
+  /**
+   * @note the slots past it are all free, but slots before it may be free too
+   * @return the number of slots in use
+   */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /** @return the number of bytes of the page in use */
+  uint32_t GetSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_SIZE); }
+
+  /** @return true if the slot holds a tuple that is not marked as deleted */
+  bool IsVisible(uint32_t slot_num) { return slot_num < GetTupleCount() && GetStatus(slot_num) == STATUS_LIVE; }
+
+  /**
+   * Read one column of a tuple without assembling the tuple.
+   * @param slot_num a visible slot
+   * @param column_idx the column to read
+   * @return the value of the column
+   */
+  Value GetValue(uint32_t slot_num, uint32_t column_idx);
+
+  /**
+   * Evaluate a predicate on one column of all the visible tuples of the page. The predicate is evaluated once per
+   * dictionary entry, per run or per code when the encoding of the column allows it, instead of once per tuple.
+   * @param column_idx the column
+   * @param match the predicate on the value of the column, which may borrow a varchar from the page for the call
+   * @param[out] matches whether each slot of the page is visible and matches
+   */
+  void MatchColumn(uint32_t column_idx, const std::function<bool(const Value &)> &match, std::vector<bool> *matches);
+
+  /** @see TablePage::InsertTuple */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::BulkInsertTuples */
+  size_t BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::MarkDelete */
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::UpdateTuple */
+  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::ApplyDelete, the values of the freed slot stay encoded until the page is compacted */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple = nullptr);
+
+  /** @see TablePage::RollbackDelete */
+  void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+
+  /** @see TablePage::Compact, the page is encoded again without the values of the freed slots */
+  bool Compact();
+
+  /** @see TablePage::GetTuple */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+
+  /** @see TablePage::GetTupleView, the tuple is decoded, so the view is a copy */
+  bool GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+    return GetTuple(rid, tuple, txn, lock_manager);
+  }
+
+  /** @see TablePage::GetFirstTupleRid */
+  bool GetFirstTupleRid(RID *first_rid);
+
+  /** @see TablePage::GetNextTupleRid */
+  bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
+
+  /**
+   * @return the room left in the page, 0 once the page is sealed. Encoding a tuple may take more room than the
+   * tuple, so an insert into the page may still fail, and then seals the page.
+   */
+  uint32_t GetInsertableSize();
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 16;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 20;
+  static constexpr size_t OFFSET_SIZE = 24;
+  static constexpr size_t OFFSET_FLAGS = 28;
+  static constexpr size_t OFFSET_COLUMNS = 32;
+  static constexpr size_t SIZE_COLUMN = 12;
+  static constexpr size_t SIZE_BLOCK_HEADER = 4;
+
+  static constexpr uint8_t STATUS_FREE = 0;
+  static constexpr uint8_t STATUS_LIVE = 1;
+  static constexpr uint8_t STATUS_DELETED = 2;
+
+  static constexpr uint32_t FLAG_SEALED = 1;
+
+  /** The tuples of a page decoded column by column, which the page is encoded from */
+  struct Rows {
+    std::vector<uint8_t> status_;
+    // per column, the one matching its encoding: the integers, the varchar payloads or the plain values
+    std::vector<std::vector<int64_t>> integers_;
+    std::vector<std::vector<std::string>> payloads_;
+    std::vector<std::string> plain_;
+  };
+
+  static size_t HeaderSize(size_t column_count) { return OFFSET_COLUMNS + SIZE_COLUMN * column_count; }
+
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+  void SetSize(uint32_t size) { memcpy(GetData() + OFFSET_SIZE, &size, sizeof(uint32_t)); }
+  uint32_t GetFlags() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FLAGS); }
+  void SetFlags(uint32_t flags) { memcpy(GetData() + OFFSET_FLAGS, &flags, sizeof(uint32_t)); }
+  uint32_t GetColumnWidth(uint32_t column_idx) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * column_idx + sizeof(uint32_t));
+  }
+  const char *GetColumnBlock(uint32_t column_idx) {
+    return GetData() +
+           *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * column_idx + 2 * sizeof(uint32_t));
+  }
+  uint8_t GetStatus(uint32_t slot_num) {
+    return *reinterpret_cast<uint8_t *>(GetData() + HeaderSize(GetColumnCount()) + slot_num);
+  }
+  void SetStatus(uint32_t slot_num, uint8_t status) {
+    *reinterpret_cast<uint8_t *>(GetData() + HeaderSize(GetColumnCount()) + slot_num) = status;
+  }
+
+  /** @return the code of a slot in a FRAME_OF_REFERENCE or DICTIONARY column */
+  uint64_t GetCode(uint32_t column_idx, uint32_t slot_num);
+
+  /** @return the start of the codes of a FRAME_OF_REFERENCE or DICTIONARY column */
+  const char *GetCodes(uint32_t column_idx);
+
+  /** @return the varchar payload of a slot, in the dictionary */
+  const char *GetPayload(uint32_t column_idx, uint32_t slot_num);
+
+  /** Copy the fixed-size value of a slot, as stored in a tuple */
+  void GetFixedValue(uint32_t column_idx, uint32_t slot_num, char *value);
+
+  /** @return all the tuples of the page */
+  Rows Decode();
+
+  /** Write a tuple into slot_num of rows, growing them if the slot is past the end */
+  void SetRow(Rows *rows, uint32_t slot_num, const Tuple &tuple);
+
+  /**
+   * Encode rows into the page.
+   * @return false if they do not fit, the page is then unchanged
+   */
+  bool Encode(const Rows &rows);
+
+  /** @return the first free slot, GetTupleCount() if there is none */
+  uint32_t FindFreeSlot();
+
+  /** Read a slot into a tuple */
+  void ReadRow(uint32_t slot_num, Tuple *tuple);
+};
+
+}  // namespace bustub
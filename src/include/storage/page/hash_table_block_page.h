@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -21,17 +21,31 @@
 #include "storage/page/hash_table_page_defs.h"
 
 namespace bustub {
+
+// number of slot tags MatchGroup compares at once
+#if defined(__AVX2__)
+#define BLOCK_TAG_GROUP_SIZE 32
+#else
+#define BLOCK_TAG_GROUP_SIZE 16
+#endif
+
 /**
  * Store indexed key and and value together within block page. Supports
  * non-unique keys.
  *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ * | TAG(1) | ... | TAG(n) | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ---------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
+ * The tag of a slot is EMPTY_TAG if it was never occupied, TOMBSTONE_TAG if
+ * its pair was removed, and the fingerprint of the hash of its key otherwise.
+ * A probe compares a whole group of tags to the fingerprint of its key with
+ * SIMD instructions and only reads the keys of the slots that match.
+ *
+ * The caller latches the page: readers shared, Insert and Remove exclusive.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -57,18 +71,15 @@ class HashTableBlockPage {
 
   /**
    * Attempts to insert a key and value into an index in the block.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
    *
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint Fingerprint() of the hash of key
    * @return If the value is inserted successfully, it returns true. If the
-   * index is marked as occupied before the key and value can be inserted,
-   * Insert returns false.
+   * index already holds a pair, Insert returns false; a tombstone is reused.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
 
   /**
    * Removes a key and value at index.
@@ -93,11 +104,29 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
- private:
-  std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  /**
+   * @param hash the hash of a key
+   * @return the tag of the slots holding the key, never EMPTY_TAG or TOMBSTONE_TAG
+   */
+  static uint8_t Fingerprint(uint64_t hash) { return static_cast<uint8_t>(0x80 | (hash >> 57)); }
 
-  // 0 if tombstone/brand new (never occupied), 1 otherwise.
-  std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  /**
+   * Compares the tags of the slots [start, start + count) to a fingerprint.
+   *
+   * @param start first index of the group
+   * @param count size of the group, at most BLOCK_TAG_GROUP_SIZE
+   * @param fingerprint the fingerprint to look for
+   * @param[out] empty bit i is set if index start + i is empty
+   * @return bit i is set if the tag of index start + i is fingerprint
+   */
+  uint32_t MatchGroup(slot_offset_t start, slot_offset_t count, uint8_t fingerprint, uint32_t *empty) const;
+
+  static constexpr uint8_t EMPTY_TAG = 0;
+  static constexpr uint8_t TOMBSTONE_TAG = 1;
+
+ private:
+  // a new page is zeroed, so all of its slots are empty
+  uint8_t tags_[BLOCK_ARRAY_SIZE];
   MappingType array_[0];
 };
 
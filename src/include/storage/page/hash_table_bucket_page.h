@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Store indexed key and and value together within bucket page of the
+ * extendible hash table. Supports non-unique keys, but not duplicate
+ * (key, value) pairs.
+ *
+ * Bucket page format (pairs are not stored in order):
+ *  ----------------------------------------------------------------
+ * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------
+ *
+ *  Here '+' means concatenation.
+ *
+ * A bucket is only read or written under its page latch. Removed pairs
+ * leave their slot occupied but not readable, and the slot is reused by
+ * the next insert. Scans stop at the first slot that was never occupied.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Scan the bucket and collect values that have the matching key
+   *
+   * @return true if at least one key matched
+   */
+  bool GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) const;
+
+  /**
+   * Attempts to insert a key and value in the bucket.
+   *
+   * @param key key to insert
+   * @param value value to insert
+   * @param cmp the comparator to use
+   * @return true if inserted, false if the pair is already there or the
+   * bucket is full
+   */
+  bool Insert(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Removes a key and value.
+   *
+   * @return true if removed, false if not found
+   */
+  bool Remove(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Gets the key at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the key at
+   * @return key at index bucket_idx of the bucket
+   */
+  KeyType KeyAt(slot_offset_t bucket_idx) const;
+
+  /**
+   * Gets the value at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the value at
+   * @return value at index bucket_idx of the bucket
+   */
+  ValueType ValueAt(slot_offset_t bucket_idx) const;
+
+  /**
+   * Remove the KV pair at bucket_idx
+   */
+  void RemoveAt(slot_offset_t bucket_idx);
+
+  /**
+   * Returns whether or not an index is occupied (key/value pair or tombstone)
+   *
+   * @param bucket_idx index to look at
+   * @return true if the index is occupied, false otherwise
+   */
+  bool IsOccupied(slot_offset_t bucket_idx) const;
+
+  /**
+   * Returns whether or not an index is readable (valid key/value pair)
+   *
+   * @param bucket_idx index to look at
+   * @return true if the index is readable, false otherwise
+   */
+  bool IsReadable(slot_offset_t bucket_idx) const;
+
+  /**
+   * @return the number of readable elements, i.e. current size
+   */
+  uint32_t NumReadable() const;
+
+  /**
+   * @return whether the bucket is full
+   */
+  bool IsFull() const;
+
+  /**
+   * @return whether the bucket is empty
+   */
+  bool IsEmpty() const;
+
+ private:
+  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+
+  // 0 if tombstone/brand new (never occupied), 1 otherwise.
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+// the directory has room for 2^HASH_TABLE_DIRECTORY_MAX_DEPTH buckets
+#define HASH_TABLE_DIRECTORY_MAX_DEPTH 9
+#define DIRECTORY_ARRAY_SIZE (1 << HASH_TABLE_DIRECTORY_MAX_DEPTH)
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * Entry i of the directory points to the bucket holding the keys whose
+ * hash ends with the GlobalDepth low bits of i. A bucket of local depth d is
+ * pointed to by every entry sharing its d low bits, 2^(GlobalDepth - d) of
+ * them.
+ *
+ * Directory format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId (4) | GlobalDepth (4) | LocalDepths (512) | BucketPageIds (4 * 512) |
+ * --------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of low hash bits the directory indexes by
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return a mask of the GlobalDepth low bits
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Doubles the directory, the upper half points to the same buckets as the
+   * lower half
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, caller checks CanShrink() first
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if every bucket has a local depth below the global depth
+   */
+  bool CanShrink() const;
+
+  /**
+   * @return the number of entries of the directory, 2^GlobalDepth
+   */
+  uint32_t Size() const;
+
+  /**
+   * @param bucket_idx directory entry
+   * @return the page id of the bucket the entry points to
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx directory entry
+   * @param bucket_page_id page id of the bucket the entry points to
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @param bucket_idx directory entry
+   * @return the local depth of the bucket the entry points to
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx directory entry
+   * @param local_depth local depth of the bucket the entry points to
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /**
+   * @param bucket_idx directory entry
+   * @return a mask of the LocalDepth low bits of the bucket the entry points to
+   */
+  uint32_t GetLocalDepthMask(uint32_t bucket_idx) const;
+
+  /**
+   * The split image of a bucket is the bucket it was split from, or split
+   * into: its entries differ in the highest bit of the local depth.
+   *
+   * @param bucket_idx directory entry of a bucket with a local depth above 0
+   * @return a directory entry of the split image
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  /**
+   * Asserts the invariants of the directory:
+   *  - no local depth is above the global depth
+   *  - a bucket of local depth d is pointed to by 2^(GlobalDepth - d) entries
+   *  - every entry pointing to a bucket has the same local depth
+   */
+  void VerifyIntegrity() const;
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "the directory does not fit in a page");
+
+}  // namespace bustub
@@ -22,14 +22,24 @@
 
 namespace bustub {
 
+#define HASH_TABLE_HEADER_PAGE_HEADER_SIZE 48
+// number of block page ids the header page has room for
+#define HASH_TABLE_HEADER_MAX_BLOCKS ((PAGE_SIZE - HASH_TABLE_HEADER_PAGE_HEADER_SIZE) / sizeof(page_id_t))
+
 /**
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 48 bytes in total with padding):
+ * -----------------------------------------------------------------------------------------
+ * | LSN (4) | Size (8) | PageId(4) | NextBlockIndex(8) | LiveCount(8) | TombstoneCount(8)
+ * -----------------------------------------------------------------------------------------
+ *
+ * followed by the page ids of the blocks. A new page is zeroed, so a fresh
+ * header page has no blocks and no pairs.
+ *
+ * The counts are changed atomically while the page is only pinned, inserts
+ * and removes into different blocks do not latch the header.
  */
 class HashTableHeaderPage {
  public:
@@ -89,11 +99,31 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * @return the number of slots holding a pair
+   */
+  size_t GetLiveCount() const;
+
+  /**
+   * @return the number of slots holding a tombstone
+   */
+  size_t GetTombstoneCount() const;
+
+  /**
+   * Atomically adds to the counts of pairs and tombstones
+   *
+   * @param live_delta change of the number of pairs
+   * @param tombstone_delta change of the number of tombstones
+   */
+  void UpdateCounts(int64_t live_delta, int64_t tombstone_delta);
+
  private:
   __attribute__((unused)) lsn_t lsn_;
   __attribute__((unused)) size_t size_;
   __attribute__((unused)) page_id_t page_id_;
   __attribute__((unused)) size_t next_ind_;
+  size_t live_count_;
+  size_t tombstone_count_;
   __attribute__((unused)) page_id_t block_page_ids_[0];
 };
 
@@ -14,11 +14,18 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
+/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page. Each pair comes with a
+ * one byte tag telling whether the slot is empty, a tombstone, or the fingerprint of the hash of its key, so
+ * PAGE_SIZE / (sizeof (MappingType) + 1). */
+#define BLOCK_ARRAY_SIZE (PAGE_SIZE / (sizeof(MappingType) + 1))
+
+#define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a bucket page. It is an approximate
  * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
  * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
  * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
  * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
-#define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.h
+//
+// Identification: src/include/storage/page/overflow_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * Overflow pages hold a value too large to stay in its tuple. The bytes of the value are split over a chain of
+ * overflow pages, and the tuple only keeps the id of the first one, see TableHeap.
+ *
+ *  Page format (size in bytes):
+ *  ----------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| NextPageId (4)| DataSize (4)| DATA ... |
+ *  ----------------------------------------------------------------
+ */
+class OverflowPage : public Page {
+ public:
+  /** Number of bytes of the value a page holds */
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - 16;
+
+  /**
+   * Initialize the OverflowPage.
+   * @param page_id the page ID of this page
+   * @param next_page_id the next page of the chain, INVALID_PAGE_ID for the last one
+   * @param data the bytes of the value the page holds
+   * @param size the number of bytes, at most CAPACITY
+   */
+  void Init(page_id_t page_id, page_id_t next_page_id, const char *data, uint32_t size);
+
+  /** @return the page ID of the next page of the chain */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** @return the number of bytes of the value the page holds */
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /** @return the bytes of the value the page holds */
+  const char *GetValueData() { return GetData() + OFFSET_DATA; }
+
+  /**
+   * Store a value in a new chain of overflow pages.
+   * @return the id of the first page of the chain, INVALID_PAGE_ID if the pages could not be created
+   */
+  static page_id_t WriteChain(BufferPoolManager *buffer_pool_manager, const char *data, uint32_t size);
+
+  /**
+   * Read back a value stored by WriteChain.
+   * @param[out] data receives the size bytes of the value
+   * @return false if a page of the chain could not be fetched
+   */
+  static bool ReadChain(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, char *data, uint32_t size);
+
+  /** Delete the pages of a chain */
+  static void DeleteChain(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+ private:
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_DATA_SIZE = 12;
+  static constexpr size_t OFFSET_DATA = 16;
+};
+
+}  // namespace bustub
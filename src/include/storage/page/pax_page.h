@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/page/page.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** Room a PAX page sets aside per row for each variable-length column when it picks its number of rows */
+static constexpr uint32_t PAX_VARLEN_RESERVE = 32;
+
+/**
+ * PAX page format: the fixed-size part of each column of the tuples of the page is stored in its own minipage, so a
+ * scan over a few columns only reads their minipages. The variable-length payloads of a tuple are stored together,
+ * growing from the end of the page like the tuples of a slotted page.
+ *  -------------------------------------------------------------------------------------------------
+ *  | HEADER | ROWS | MINIPAGE(1) | ... | MINIPAGE(n) | ... FREE SPACE ... | ... VARLEN PAYLOADS ... |
+ *  -------------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes), the first 16 bytes are laid out like the header of a TablePage:
+ *  ----------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  ----------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------------------------------------
+ *  | TupleCount (4) | Capacity (4) | FixedLength (4) | ColumnCount (4) | Col_1 width (4) | Col_1 offset (4) | ... |
+ *  --------------------------------------------------------------------------------------------------------
+ *
+ * A page has room for Capacity rows. Row i holds the tuple size (with the same deleted flag as TablePage, 0 for a
+ * free row) and the offset of its variable-length payload, and its columns are the i-th entries of the minipages.
+ * The tuples keep the format of Tuple: a column is FixedLength bytes in total, and the offset an uninlined column
+ * stores is relative to the start of the tuple.
+ */
+class PaxPage : public Page {
+ public:
+  /**
+   * Initialize the PaxPage header.
+   * @param page_id the page ID of this table page
+   * @param page_size the size of this table page
+   * @param prev_page_id the previous table page ID
+   * @param log_manager the log manager in use
+   * @param txn the transaction that this page is created in
+   * @param column_widths the fixed size of each column, see ColumnWidths
+   * @param capacity the number of rows of the page, see ComputeCapacity
+   */
+  void Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager, Transaction *txn,
+            const std::vector<uint32_t> &column_widths, uint32_t capacity);
+
+  /** @return the fixed size of each column of the schema */
+  static std::vector<uint32_t> ColumnWidths(const Schema &schema);
+
+  /** @return the number of rows of a page for the schema, leaving PAX_VARLEN_RESERVE bytes per varlen column */
+  static uint32_t ComputeCapacity(const Schema &schema);
+
+  /** @return the page ID of this table page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the previous table page */
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  /** @return the page ID of the next table page */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the previous page in the table. */
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of rows of the page */
+  uint32_t GetCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CAPACITY); }
+
+  /** @return the number of columns of the tuples */
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  /** @return the fixed size of a column */
+  uint32_t GetColumnWidth(uint32_t column_idx) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * column_idx);
+  }
+
+  /**
+   * @note the rows past it are all free, but rows before it may be free too
+   * @return the number of rows in use
+   */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /** @return true if the row holds a tuple that is not marked as deleted */
+  bool IsVisible(uint32_t slot_num) { return slot_num < GetTupleCount() && !IsDeleted(GetRowSize(slot_num)); }
+
+  /** @return the minipage of a column, the entry of row i is at i * GetColumnWidth(column_idx) */
+  const char *GetColumnData(uint32_t column_idx) { return GetData() + GetColumnOffset(column_idx); }
+
+  /**
+   * Read one column of a tuple without assembling the tuple.
+   * @param schema the schema of the tuples
+   * @param slot_num a visible row
+   * @param column_idx the column to read
+   * @return the value of the column
+   */
+  Value GetValue(const Schema *schema, uint32_t slot_num, uint32_t column_idx);
+
+  /**
+   * Read some columns of a tuple without assembling it, with the checks and the lock of GetTuple.
+   * @param schema the schema of the tuples
+   * @param rid the tuple to read
+   * @param column_idxs the columns to read
+   * @param[out] values the values of the columns, in the order of column_idxs
+   * @return true if the tuple exists
+   */
+  bool GetValues(const Schema *schema, const RID &rid, const std::vector<uint32_t> &column_idxs,
+                 std::vector<Value> *values, Transaction *txn, LockManager *lock_manager);
+
+  /** @see TablePage::InsertTuple */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::BulkInsertTuples */
+  size_t BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::MarkDelete */
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::UpdateTuple */
+  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager);
+
+  /** @see TablePage::ApplyDelete */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple = nullptr);
+
+  /** @see TablePage::RollbackDelete */
+  void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+
+  /** @see TablePage::Compact */
+  bool Compact();
+
+  /** @see TablePage::GetTuple */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+
+  /**
+   * @see TablePage::GetTupleView, the columns of a tuple are apart in the page, so the view is a copy; readers of a
+   * few columns use GetValues instead
+   */
+  bool GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+    return GetTuple(rid, tuple, txn, lock_manager);
+  }
+
+  /** @see TablePage::GetFirstTupleRid */
+  bool GetFirstTupleRid(RID *first_rid);
+
+  /** @see TablePage::GetNextTupleRid */
+  bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
+
+  /** @return the size of the largest tuple InsertTuple has room for, 0 if there is none */
+  uint32_t GetInsertableSize();
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_FREE_SPACE = 16;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
+  static constexpr size_t OFFSET_CAPACITY = 24;
+  static constexpr size_t OFFSET_FIXED_LENGTH = 28;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 32;
+  static constexpr size_t OFFSET_COLUMNS = 36;
+  static constexpr size_t SIZE_COLUMN = 8;
+  static constexpr size_t SIZE_ROW = 8;
+
+  static size_t HeaderSize(size_t column_count) { return OFFSET_COLUMNS + SIZE_COLUMN * column_count; }
+
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+  uint32_t GetFixedLength() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FIXED_LENGTH); }
+  uint32_t GetColumnOffset(uint32_t column_idx) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * column_idx + sizeof(uint32_t));
+  }
+
+  /** @return the end of the last minipage, where the free space starts */
+  uint32_t GetMinipagesEnd() {
+    return HeaderSize(GetColumnCount()) + GetCapacity() * (SIZE_ROW + GetFixedLength());
+  }
+  uint32_t GetFreeSpaceRemaining() { return GetFreeSpacePointer() - GetMinipagesEnd(); }
+
+  /** @return true if rid is a live tuple the transaction holds a lock on, taking a shared lock if it has none */
+  bool LockRow(const RID &rid, Transaction *txn, LockManager *lock_manager);
+
+  uint32_t GetRowSize(uint32_t slot_num) {
+    return *reinterpret_cast<uint32_t *>(GetData() + HeaderSize(GetColumnCount()) + SIZE_ROW * slot_num);
+  }
+  void SetRowSize(uint32_t slot_num, uint32_t size) {
+    memcpy(GetData() + HeaderSize(GetColumnCount()) + SIZE_ROW * slot_num, &size, sizeof(uint32_t));
+  }
+  uint32_t GetVarlenOffset(uint32_t slot_num) {
+    return *reinterpret_cast<uint32_t *>(GetData() + HeaderSize(GetColumnCount()) + SIZE_ROW * slot_num +
+                                         sizeof(uint32_t));
+  }
+  void SetVarlenOffset(uint32_t slot_num, uint32_t offset) {
+    memcpy(GetData() + HeaderSize(GetColumnCount()) + SIZE_ROW * slot_num + sizeof(uint32_t), &offset,
+           sizeof(uint32_t));
+  }
+  /** @return the size of the variable-length payload of a row, 0 for a free row */
+  uint32_t GetVarlenSize(uint32_t slot_num) {
+    uint32_t size = UnsetDeletedFlag(GetRowSize(slot_num));
+    return size == 0 ? 0 : size - GetFixedLength();
+  }
+
+  /** @return the first free row, GetCapacity() if there is none */
+  uint32_t FindFreeRow();
+
+  /** Copy a tuple into a row, the caller checked that the payload fits */
+  void WriteRow(uint32_t slot_num, const Tuple &tuple);
+
+  /** Give back the payload of a row, moving the payloads stored before it */
+  void FreeVarlen(uint32_t slot_num);
+
+  static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
+  static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
+  static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
+};
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
@@ -83,6 +84,20 @@ class TablePage : public Page {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Append tuples to the page in new slots after the last one, as many as fit, with one log record for all of them.
+   * Free slots are not reused, this is meant for filling fresh pages.
+   * @param tuples the tuples to insert
+   * @param begin index in tuples of the first tuple to insert
+   * @param[out] rids the rids of the inserted tuples are appended to it
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return index in tuples of the first tuple that was not inserted
+   */
+  size_t BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager);
+
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
@@ -106,12 +121,22 @@ class TablePage : public Page {
   bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                    LockManager *lock_manager, LogManager *log_manager);
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert.
+   * @param[out] deleted_tuple if not null, receives the deleted tuple
+   */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple = nullptr);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * Compact the page: drop the free slots at the end of the slot array and slide the tuples against the end of the
+   * page. The other slots stay where they are, so the rids of the tuples do not change.
+   * @return true if the page holds no tuple anymore, counting the ones marked as deleted
+   */
+  bool Compact();
+
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
@@ -122,6 +147,17 @@ class TablePage : public Page {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Read a tuple from a table without copying it: the tuple points into the page, so it is only valid while the
+   * caller keeps the page pinned and latched. Same checks and locking as GetTuple.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the view of the tuple
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  bool GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+
   /** @return the rid of the first tuple in this page */
 
   /**
@@ -137,6 +173,12 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /** @return the size of the largest tuple InsertTuple has room for, 0 if there is none */
+  uint32_t GetInsertableSize() {
+    uint32_t free_space = GetFreeSpaceRemaining();
+    return free_space > SIZE_TUPLE ? free_space - SIZE_TUPLE : 0;
+  }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Free space is tracked in steps of FSM_CATEGORY_SIZE bytes, one byte per page. */
+static constexpr uint32_t FSM_CATEGORY_SIZE = PAGE_SIZE / 256;
+
+/**
+ * FreeSpaceMap records how large a tuple each page of a table heap has room
+ * for, so that an insert goes straight to a page that fits its tuple instead
+ * of walking the page chain.
+ *
+ * The room of a page is rounded down to a category of FSM_CATEGORY_SIZE
+ * bytes. The categories are the leaves of a max tree, so finding the first
+ * page with enough room takes a descent from the root.
+ *
+ * A page can be claimed by one inserting thread, which then keeps inserting
+ * into it; other threads do not find it until it is released.
+ *
+ * The map lives in memory. The room it records is a hint: the caller checks
+ * it under the page latch and reports the actual room back with Update.
+ */
+class FreeSpaceMap {
+ public:
+  FreeSpaceMap() = default;
+
+  /**
+   * Records the room of a page, adding the page if the map does not know it.
+   * @param page_id the page
+   * @param insertable_size size of the largest tuple the page has room for
+   */
+  void Update(page_id_t page_id, uint32_t insertable_size);
+
+  /**
+   * @param tuple_size size of the tuple to insert
+   * @return the first page, in the order of the map, recorded with room for
+   * the tuple, INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPage(uint32_t tuple_size);
+
+  /**
+   * Like FindPage, and hide the page from FindPage and Claim until Release.
+   */
+  page_id_t Claim(uint32_t tuple_size);
+
+  /** Add a claimed page, for a page the caller creates to insert into */
+  void AddClaimed(page_id_t page_id, uint32_t insertable_size);
+
+  /** Make a claimed page available to other inserts again */
+  void Release(page_id_t page_id);
+
+  /** Forget a page that was freed, its place goes to the next page added */
+  void Remove(page_id_t page_id);
+
+  /** @return the number of pages in the map */
+  size_t GetNumPages();
+
+ private:
+  // room of a page, rounded down so the page is sure to have it
+  static uint8_t ToCategory(uint32_t insertable_size);
+  // room a tuple needs, rounded up for the same reason
+  static uint32_t ToNeededCategory(uint32_t tuple_size);
+
+  void Add(page_id_t page_id, uint8_t category, bool claimed);
+  page_id_t FindPosition(uint32_t tuple_size, size_t *position);
+  // a claimed page shows as full in the tree
+  void UpdateLeaf(size_t position);
+
+  std::mutex latch_;
+  // pages in the order of the map, with their category and claim; a page is
+  // added at the end or in the place of a removed one
+  std::vector<page_id_t> pages_;
+  std::vector<uint8_t> categories_;
+  std::vector<bool> claimed_;
+  std::unordered_map<page_id_t, size_t> positions_;
+  // places of removed pages
+  std::vector<size_t> free_positions_;
+  // tree_[1] is the root, the children of i are 2i and 2i + 1, the leaves
+  // start at capacity_
+  std::vector<uint8_t> tree_;
+  size_t capacity_{0};
+};
+
+}  // namespace bustub
@@ -12,20 +12,59 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
 #include "recovery/log_manager.h"
+#include "storage/page/compressed_page.h"
+#include "storage/page/overflow_page.h"
+#include "storage/page/pax_page.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+/**
+ * Page format of a table heap: ROW stores tuples in slotted TablePages, PAX column by column in PaxPages, COMPRESSED
+ * column by column with lightweight encodings in CompressedPages
+ */
+enum class TableFormat { ROW, PAX, COMPRESSED };
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * A free space map remembers which pages have room, so an insert does not
+ * walk the list. It is filled as the table grows, and for an opened table as
+ * inserts first walk the existing pages.
+ *
+ * Each inserting thread keeps its own target page claimed from the free
+ * space map, so concurrent inserts fill different pages instead of queueing
+ * on the latch of the same one. A target page that has no room for a tuple
+ * goes back to the free space map.
+ *
+ * Deleting tuples leaves pages empty; Vacuum removes them from the list, so
+ * scans do not walk them anymore.
+ *
+ * All the pages of a table have the format it was created with, every page
+ * access goes through WithPage to reach the page class of that format.
+ *
+ * A row table created with its schema stores tuples larger than
+ * TOAST_TUPLE_THRESHOLD with their largest varchar values in overflow pages,
+ * so a tuple may be larger than a page. The tuples it reads load such values
+ * when they are asked for, see Tuple. The overflow pages of a tuple are freed
+ * along with it, and those of the old version of an updated tuple on commit.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class TableScanCursor;
 
  public:
   ~TableHeap() = default;
@@ -36,9 +75,12 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param format the page format the table was created with
+   * @param schema the schema of the tuples, needed by the row format to move large values to overflow pages and to
+   * free them again; without it the table neither moves nor frees them
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, TableFormat format = TableFormat::ROW, const Schema *schema = nullptr);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,12 +88,16 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param format the page format of the table
+   * @param schema the schema of the tuples, needed by the PAX and compressed formats, and by the row format to move
+   * large values to overflow pages
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, TableFormat format = TableFormat::ROW, const Schema *schema = nullptr);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size) once its large values are moved to
+   * overflow pages, return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +105,23 @@ class TableHeap {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
+  /**
+   * Append a batch of tuples to the end of the table, packed densely into the last page and then fresh pages, with
+   * one page fetch, latch and log record per page.
+   *
+   * Nothing is inserted if a tuple is too large (>= page_size) once its large values are moved, or if moving the
+   * large values to overflow pages fails; the overflow pages written so far are freed and the transaction is aborted.
+   * The batch can also stop partway: when an encoded tuple does not fit even a fresh page (compressed and PAX
+   * tables), or no new page can be allocated. Then the tuples before it stay inserted, their rids are appended to
+   * rids and put in the write set, the overflow pages of the rest are freed, and the transaction is aborted, so the
+   * rollback removes the inserted part.
+   * @param tuples tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in the order of tuples, are appended to it
+   * @param txn the transaction performing the insert
+   * @return true iff all the tuples were inserted
+   */
+  bool BulkInsert(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -90,6 +153,12 @@ class TableHeap {
    */
   void RollbackDelete(const RID &rid, Transaction *txn);
 
+  /**
+   * Free the overflow pages of the values of a tuple. Called on commit for the old version of an updated tuple.
+   * @param tuple a tuple read from the table
+   */
+  void ReleaseOverflowPages(const Tuple &tuple);
+
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
@@ -99,6 +168,34 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read a tuple without copying it out of its page (a PAX tuple is assembled, see PaxPage::GetTupleView).
+   * @param rid rid of the tuple to read
+   * @param txn transaction performing the read
+   * @param fn called with the view of the tuple, which points into the page and is only valid until fn returns;
+   * the page stays pinned and read latched meanwhile, so fn must not access the table
+   * @return true if the read was successful (i.e. the tuple exists), fn is only called then
+   */
+  template <typename Fn>
+  bool ViewTuple(const RID &rid, Transaction *txn, Fn &&fn) {
+    auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
+    // If the page could not be found, then abort the transaction.
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    bool res = ViewTupleOnPage(page, rid, txn, std::forward<Fn>(fn));
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    return res;
+  }
+
+  /**
+   * Compact every page of the table, then unlink the pages left empty from the page list and free them. The first
+   * page always stays. Must not run concurrently with other operations on the table.
+   * @return the number of pages freed
+   */
+  size_t Vacuum();
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,11 +205,125 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the page format of this table */
+  inline TableFormat GetFormat() const { return format_; }
+
  private:
+  /** size of the payload of a value stored in overflow pages: its length and the id of the first page */
+  static constexpr uint32_t EXTERNAL_PAYLOAD_SIZE = sizeof(uint32_t) + sizeof(page_id_t);
+
+  /** number of insert target pages, threads beyond it share them */
+  static constexpr size_t INSERT_TARGET_SLOTS = 16;
+
+  /** Target page of the inserts of one or more threads */
+  struct alignas(64) InsertTarget {
+    std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  };
+
+  /** @return the insert target of the calling thread */
+  InsertTarget *GetInsertTarget();
+
+  /**
+   * Claim a page with room for a tuple of tuple_size bytes. Pages the free
+   * space map does not know yet are added first, then a new page is appended.
+   * @param[out] new_page_size set to the room in the page if it is a new one, 0 otherwise
+   * @return the page id, INVALID_PAGE_ID if no page could be created
+   */
+  page_id_t ClaimOrAppendPage(uint32_t tuple_size, Transaction *txn, uint32_t *new_page_size);
+
+  /**
+   * Walk from last_page_id_ to the end of the table, adding the pages on the way to the free space map.
+   * The caller holds append_latch_.
+   * @return the last page, pinned and write latched, nullptr if it could not be fetched
+   */
+  Page *LatchLastPage();
+
+  /**
+   * Append a new page behind last_page, which the caller holds write latched along with append_latch_.
+   * last_page is unlatched and unpinned either way.
+   * @return the new page, pinned and write latched, nullptr if it could not be created
+   */
+  Page *AppendPage(Page *last_page, Transaction *txn);
+
+  /** @return fn called with page as a TablePage, a PaxPage or a CompressedPage, depending on the table format */
+  template <typename Fn>
+  auto WithPage(Page *page, Fn &&fn) {
+    if (format_ == TableFormat::PAX) {
+      return fn(static_cast<PaxPage *>(page));
+    }
+    if (format_ == TableFormat::COMPRESSED) {
+      return fn(static_cast<CompressedPage *>(page));
+    }
+    return fn(static_cast<TablePage *>(page));
+  }
+
+  /** ViewTuple on a page the caller holds pinned */
+  template <typename Fn>
+  bool ViewTupleOnPage(Page *page, const RID &rid, Transaction *txn, Fn &&fn) {
+    Tuple view;
+    view.buffer_pool_manager_ = buffer_pool_manager_;
+    page->RLatch();
+    bool res =
+        WithPage(page, [&](auto *table_page) { return table_page->GetTupleView(rid, &view, txn, lock_manager_); });
+    if (res) {
+      fn(static_cast<const Tuple &>(view));
+    }
+    page->RUnlatch();
+    return res;
+  }
+
+  /**
+   * Read some columns of a tuple on a page the caller holds pinned. The columns of a PAX tuple are read from their
+   * minipages, the tuples of the other formats are viewed in place.
+   * @param schema the schema of the tuples
+   * @param column_idxs the columns to read
+   * @param[out] values the values of the columns, in the order of column_idxs
+   * @return true if the tuple exists
+   */
+  bool GetValuesOnPage(Page *page, const RID &rid, Transaction *txn, const Schema *schema,
+                       const std::vector<uint32_t> &column_idxs, std::vector<Value> *values);
+
+  /** Initialize a new page of the table format */
+  void InitPage(Page *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn);
+
+  page_id_t GetNextPageId(Page *page) {
+    return WithPage(page, [](auto *table_page) { return table_page->GetNextPageId(); });
+  }
+
+  /** Record the room left in a page the caller holds latched */
+  void UpdateFreeSpace(Page *page);
+
+  /**
+   * Move the largest varchar values of a tuple larger than TOAST_TUPLE_THRESHOLD to overflow pages.
+   * @param tuple the tuple to store
+   * @param[out] toasted receives the tuple pointing to the overflow pages, if any value is moved
+   * @return the tuple to store, tuple or toasted, nullptr if the overflow pages could not be created
+   */
+  const Tuple *Toast(const Tuple &tuple, Tuple *toasted);
+
+  /** @return where the tuples of schema store the offset of each varchar payload */
+  static std::vector<uint32_t> VarlenColumns(const Schema &schema);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  TableFormat format_;
+  // layout of the pages of a PAX table
+  std::vector<uint32_t> pax_column_widths_;
+  uint32_t pax_capacity_{0};
+  // column types of the pages of a compressed table
+  std::vector<TypeId> column_types_;
+  // where the tuples of a row table store the offset of each varchar payload, empty if values are never moved
+  std::vector<uint32_t> varlen_columns_;
+
+  FreeSpaceMap free_space_map_;
+  // Serializes appending pages. last_page_id_ is the last page known to the
+  // free space map, every page before it is known too.
+  std::mutex append_latch_;
+  page_id_t last_page_id_{};
+
+  std::array<InsertTarget, INSERT_TARGET_SLOTS> insert_targets_;
 };
 
 }  // namespace bustub
@@ -24,6 +24,7 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ * Advancing only moves to the next rid, the tuple is read when the iterator is dereferenced.
  */
 class TableIterator {
   friend class Cursor;
@@ -32,7 +33,7 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), loaded_(other.loaded_), txn_(other.txn_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -44,6 +45,9 @@ class TableIterator {
 
   Tuple *operator->();
 
+  /** @return the rid of the current tuple, without reading the tuple */
+  inline RID GetRid() const { return tuple_->rid_; }
+
   TableIterator &operator++();
 
   TableIterator operator++(int);
@@ -51,13 +55,19 @@ class TableIterator {
   TableIterator &operator=(const TableIterator &other) {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
+    loaded_ = other.loaded_;
     txn_ = other.txn_;
     return *this;
   }
 
  private:
+  /** Read the current tuple if it was not yet */
+  void Load();
+
   TableHeap *table_heap_;
   Tuple *tuple_;
+  // whether tuple_ holds the current tuple, or only its rid
+  bool loaded_{false};
   Transaction *txn_;
 };
 
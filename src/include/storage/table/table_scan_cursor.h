@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_scan_cursor.h
+//
+// Identification: src/include/storage/table/table_scan_cursor.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/page.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * TableScanCursor walks the tuples of a TableHeap one page at a time: a page is fetched and pinned once, its live
+ * slots are visited, then the cursor moves on to the next page. Unlike TableIterator, which goes through the buffer
+ * pool for every tuple, it only does so once per page.
+ *
+ * The page is only latched while the cursor looks at it, so the caller may take tuple locks between two calls.
+ *
+ *   TableScanCursor cursor(table_heap, txn);
+ *   while (cursor.Next()) {
+ *     cursor.View([&](const Tuple &tuple) { ... });
+ *   }
+ *
+ * Given the schema of the tuples, the cursor also reads single columns: GetValues only reads their minipages on PAX
+ * pages, where View has to assemble the tuple.
+ */
+class TableScanCursor {
+ public:
+  /**
+   * Create a cursor positioned before the first tuple of the table.
+   * @param table_heap the table to scan
+   * @param txn the transaction performing the scan
+   * @param schema the schema of the tuples, needed by GetValues and to filter PAX pages
+   */
+  TableScanCursor(TableHeap *table_heap, Transaction *txn, const Schema *schema = nullptr);
+
+  ~TableScanCursor();
+
+  DISALLOW_COPY(TableScanCursor);
+
+  /**
+   * Move to the next live tuple of the table.
+   * @return false if there is none, the cursor then holds no page anymore
+   */
+  bool Next();
+
+  /**
+   * Skip the tuples whose column does not match a predicate. It is evaluated once per page: on the encoded column of a
+   * compressed page, see CompressedPage::MatchColumn, and on the minipage of the column of a PAX page if the cursor
+   * has the schema. Row pages ignore it, and a tuple may change between the page and the tuple being read, so the
+   * caller still evaluates its predicate on each tuple. Call it before the first Next.
+   * @param column_idx the column
+   * @param match the predicate on the value of the column
+   */
+  void SetFilter(uint32_t column_idx, std::function<bool(const Value &)> match) {
+    filter_column_idx_ = column_idx;
+    filter_ = std::move(match);
+  }
+
+  /** @return the rid of the current tuple */
+  inline RID GetRid() const { return rid_; }
+
+  /**
+   * Read the current tuple in place, see TableHeap::ViewTuple.
+   * @param fn called with the view of the tuple
+   * @return true if the tuple is still there, fn is only called then
+   */
+  template <typename Fn>
+  bool View(Fn &&fn) {
+    return table_heap_->ViewTupleOnPage(page_, rid_, txn_, std::forward<Fn>(fn));
+  }
+
+  /**
+   * Read some columns of the current tuple, see TableHeap::GetValuesOnPage. The cursor needs the schema.
+   * @param column_idxs the columns to read
+   * @param[out] values the values of the columns, in the order of column_idxs
+   * @return true if the tuple is still there
+   */
+  bool GetValues(const std::vector<uint32_t> &column_idxs, std::vector<Value> *values) {
+    return table_heap_->GetValuesOnPage(page_, rid_, txn_, schema_, column_idxs, values);
+  }
+
+ private:
+  /** Unpin the current page and pin the given one, nullptr if it is INVALID_PAGE_ID */
+  void MoveToPage(page_id_t page_id);
+
+  /** Evaluate the filter on the page the cursor just moved to, which the caller holds latched */
+  void MatchPage();
+
+  /** @return false if the filter skips the tuple */
+  bool Matches(const RID &rid) const { return rid.GetSlotNum() >= matches_.size() || matches_[rid.GetSlotNum()]; }
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  const Schema *schema_;
+  // the pinned page of the current tuple, nullptr once the scan is over
+  Page *page_{nullptr};
+  RID rid_;
+  // whether rid_ is a tuple of page_, or the cursor is before the first tuple of page_
+  bool on_page_{false};
+  uint32_t filter_column_idx_{0};
+  std::function<bool(const Value &)> filter_;
+  // whether each slot of a filtered page matches the filter, slots past it were added since and are not skipped
+  std::vector<bool> matches_;
+};
+
+}  // namespace bustub
@@ -21,20 +21,33 @@
 
 namespace bustub {
 
+class BufferPoolManager;
+
 /**
  * Tuple format:
  * ---------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
  * ---------------------------------------------------------------------
+ *
+ * The payload of a varchar is its length followed by its bytes. A table heap may move a large value to overflow
+ * pages, the payload then is the length with EXTERNAL_FLAG set followed by the id of the first overflow page. Such a
+ * value is only read when GetValue asks for it, from the buffer pool of the table the tuple was read from.
  */
 class Tuple {
   friend class TablePage;
 
+  friend class PaxPage;
+
+  friend class CompressedPage;
+
   friend class TableHeap;
 
   friend class TableIterator;
 
  public:
+  /** Set in the length of a varchar payload stored in overflow pages */
+  static constexpr uint32_t EXTERNAL_FLAG = 1U << 31;
+
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
 
@@ -92,10 +105,15 @@ class Tuple {
   // Get the starting storage address of specific column
   const char *GetDataPtr(const Schema *schema, uint32_t column_idx) const;
 
+  // Read a varchar value stored in overflow pages
+  Value GetExternalValue(TypeId column_type, const char *data_ptr) const;
+
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
   uint32_t size_{0};
   char *data_{nullptr};
+  // the buffer pool of the table the tuple was read from, for the values stored in overflow pages
+  BufferPoolManager *buffer_pool_manager_{nullptr};
 };
 
 }  // namespace bustub
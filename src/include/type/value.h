@@ -13,11 +13,13 @@
 #pragma once
 
 #include <cstring>
+#include <functional>
 #include <string>
 #include <utility>
 
 #include "type/limits.h"
 #include "type/type.h"
+#include "type/type_util.h"
 
 namespace bustub {
 
@@ -26,6 +28,14 @@ inline CmpBool GetCmpBool(bool boolean) { return boolean ? CmpBool::CmpTrue : Cm
 // A value is an abstract class that represents a view over SQL data stored in
 // some materialized state. All values have a type and comparison functions, but
 // subclasses implement other type-specific functionality.
+//
+// Comparisons of two non-null numeric, boolean, timestamp or varchar values are
+// done here with a switch on the type ids; the rest goes through Type.
+//
+// A varchar either borrows its data (manage_data_ is false) or manages it. A
+// managed varchar of at most sizeof(Val) bytes is stored in value_ itself, a
+// longer one in a buffer shared by the copies of the value, so copying a value
+// never copies its data.
 class Value {
   // Friend Type classes
   friend class Type;
@@ -89,20 +99,46 @@ class Value {
 
   inline Value CastAs(const TypeId type_id) const { return Type::GetInstance(type_id_)->CastAs(*this, type_id); }
   // Comparison Methods
-  inline CmpBool CompareEquals(const Value &o) const { return Type::GetInstance(type_id_)->CompareEquals(*this, o); }
+  inline CmpBool CompareEquals(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::equal_to<>>(o, &result)) {
+      return result;
+    }
+    return Type::GetInstance(type_id_)->CompareEquals(*this, o);
+  }
   inline CmpBool CompareNotEquals(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::not_equal_to<>>(o, &result)) {
+      return result;
+    }
     return Type::GetInstance(type_id_)->CompareNotEquals(*this, o);
   }
   inline CmpBool CompareLessThan(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::less<>>(o, &result)) {
+      return result;
+    }
     return Type::GetInstance(type_id_)->CompareLessThan(*this, o);
   }
   inline CmpBool CompareLessThanEquals(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::less_equal<>>(o, &result)) {
+      return result;
+    }
     return Type::GetInstance(type_id_)->CompareLessThanEquals(*this, o);
   }
   inline CmpBool CompareGreaterThan(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::greater<>>(o, &result)) {
+      return result;
+    }
     return Type::GetInstance(type_id_)->CompareGreaterThan(*this, o);
   }
   inline CmpBool CompareGreaterThanEquals(const Value &o) const {
+    CmpBool result;
+    if (CompareDirect<std::greater_equal<>>(o, &result)) {
+      return result;
+    }
     return Type::GetInstance(type_id_)->CompareGreaterThanEquals(*this, o);
   }
 
@@ -132,12 +168,107 @@ class Value {
     return Type::GetInstance(type_id)->DeserializeFrom(storage);
   }
 
+  // Deserialize a value like DeserializeFrom, but a varchar borrows its data
+  // from the storage space instead of copying it, so the value must not
+  // outlive the storage.
+  static Value ViewFrom(const char *storage, TypeId type_id);
+
   // Return a string version of this value
   inline std::string ToString() const { return Type::GetInstance(type_id_)->ToString(*this); }
   // Create a copy of this value
   inline Value Copy() const { return Type::GetInstance(type_id_)->Copy(*this); }
 
  protected:
+  // Compare two non-null values of the types compared here with Op.
+  // Returns false for the other values, which are compared by their Type.
+  template <class Op>
+  inline bool CompareDirect(const Value &o, CmpBool *result) const {
+    if (IsNull() || o.IsNull()) {
+      return false;
+    }
+    Op op;
+    if (type_id_ == o.type_id_) {
+      switch (type_id_) {
+        case TypeId::BOOLEAN:
+        case TypeId::TINYINT:
+          *result = GetCmpBool(op(value_.tinyint_, o.value_.tinyint_));
+          return true;
+        case TypeId::SMALLINT:
+          *result = GetCmpBool(op(value_.smallint_, o.value_.smallint_));
+          return true;
+        case TypeId::INTEGER:
+          *result = GetCmpBool(op(value_.integer_, o.value_.integer_));
+          return true;
+        case TypeId::BIGINT:
+          *result = GetCmpBool(op(value_.bigint_, o.value_.bigint_));
+          return true;
+        case TypeId::DECIMAL:
+          *result = GetCmpBool(op(value_.decimal_, o.value_.decimal_));
+          return true;
+        case TypeId::TIMESTAMP:
+          *result = GetCmpBool(op(value_.timestamp_, o.value_.timestamp_));
+          return true;
+        case TypeId::VARCHAR:
+          // the lengths include a terminating byte, see VarlenType
+          if (size_.len_ == 0 || o.size_.len_ == 0 || size_.len_ == BUSTUB_VARCHAR_MAX_LEN ||
+              o.size_.len_ == BUSTUB_VARCHAR_MAX_LEN) {
+            return false;
+          }
+          *result = GetCmpBool(
+              op(TypeUtil::CompareStrings(GetVarlen(), size_.len_ - 1, o.GetVarlen(), o.size_.len_ - 1), 0));
+          return true;
+        default:
+          return false;
+      }
+    }
+    // Mixed numeric types compare as the wider one, as the numeric types do.
+    if (!IsNumeric() || !o.IsNumeric()) {
+      return false;
+    }
+    if (type_id_ == TypeId::DECIMAL || o.type_id_ == TypeId::DECIMAL) {
+      *result = GetCmpBool(op(GetAsDouble(), o.GetAsDouble()));
+    } else {
+      *result = GetCmpBool(op(GetAsBigInt(), o.GetAsBigInt()));
+    }
+    return true;
+  }
+
+  inline bool IsNumeric() const {
+    return type_id_ == TypeId::TINYINT || type_id_ == TypeId::SMALLINT || type_id_ == TypeId::INTEGER ||
+           type_id_ == TypeId::BIGINT || type_id_ == TypeId::DECIMAL;
+  }
+
+  // The value of a numeric type other than DECIMAL
+  inline int64_t GetAsBigInt() const {
+    switch (type_id_) {
+      case TypeId::TINYINT:
+        return value_.tinyint_;
+      case TypeId::SMALLINT:
+        return value_.smallint_;
+      case TypeId::INTEGER:
+        return value_.integer_;
+      default:
+        return value_.bigint_;
+    }
+  }
+
+  // The value of a numeric type
+  inline double GetAsDouble() const {
+    return type_id_ == TypeId::DECIMAL ? value_.decimal_ : static_cast<double>(GetAsBigInt());
+  }
+
+  // Whether a managed varchar is stored in value_ itself
+  inline bool IsVarlenInlined() const { return manage_data_ && size_.len_ <= sizeof(Val); }
+
+  // The data of a varchar
+  inline const char *GetVarlen() const { return IsVarlenInlined() ? value_.inlined_ : value_.const_varlen_; }
+
+  // Store a copy of the data of a varchar, inlined or in a new shared buffer
+  void SetVarlen(const char *data, uint32_t len);
+
+  // Drop the reference of a managed varchar to its shared buffer
+  void ReleaseVarlen();
+
   // The actual value item
   union Val {
     int8_t boolean_;
@@ -149,6 +280,7 @@ class Value {
     uint64_t timestamp_;
     char *varlen_;
     const char *const_varlen_;
+    char inlined_[sizeof(int64_t)];
   } value_;
 
   union {
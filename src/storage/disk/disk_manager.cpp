@@ -81,6 +81,7 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  std::scoped_lock db_io_lock(db_io_latch_);
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
@@ -99,6 +100,7 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   int offset = page_id * PAGE_SIZE;
+  std::scoped_lock db_io_lock(db_io_latch_);
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
@@ -0,0 +1,694 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType>
+ART_TYPE::AdaptiveRadixTree(bool unique_key) : unique_key_(unique_key), root_(new Node256()) {}
+
+template <typename KeyType, typename ValueType>
+ART_TYPE::~AdaptiveRadixTree() {
+  DeleteTree(root_);
+  for (auto &retired : retired_) {
+    DeleteNode(retired.second);
+  }
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) {
+  OperationGuard guard(this);
+  bool found;
+  while (!TryGetValue(key, result, &found)) {
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::TryGetValue(const KeyType &key, std::vector<ValueType> *result, bool *found) {
+  const uint8_t *bytes = KeyBytes(key);
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_len = node->prefix_len_;
+    // a torn read of a node under change, the version check would fail
+    if (depth + prefix_len >= KEY_SIZE) {
+      return false;
+    }
+    if (PrefixMismatch(node, bytes, depth) < prefix_len) {
+      *found = false;
+      return Validate(node, version);
+    }
+    depth += prefix_len;
+    Node *child = FindChild(node, bytes[depth]);
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      *found = false;
+      return true;
+    }
+
+    if (child->type_ == NodeType::LEAF) {
+      auto leaf = static_cast<Leaf *>(child);
+      *found = memcmp(&leaf->key_, &key, KEY_SIZE) == 0;
+      if (*found) {
+        result->insert(result->end(), leaf->values_.begin(), leaf->values_.end());
+      }
+      return true;
+    }
+
+    auto inner_child = static_cast<InnerNode *>(child);
+    uint64_t child_version;
+    if (!ReadLock(inner_child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::Insert(const KeyType &key, const ValueType &value) {
+  OperationGuard guard(this);
+  bool inserted;
+  while (!TryInsert(key, value, &inserted)) {
+  }
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::TryInsert(const KeyType &key, const ValueType &value, bool *inserted) {
+  const uint8_t *bytes = KeyBytes(key);
+  InnerNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_len = node->prefix_len_;
+    if (depth + prefix_len >= KEY_SIZE) {
+      return false;
+    }
+    size_t mismatch = PrefixMismatch(node, bytes, depth);
+    if (mismatch < prefix_len) {
+      // the key leaves the compressed path, a Node4 takes over the shared part
+      // (never the root, it has no prefix)
+      if (!Upgrade(parent, parent_version)) {
+        return false;
+      }
+      if (!Upgrade(node, version)) {
+        WriteUnlock(parent);
+        return false;
+      }
+      auto split = new Node4();
+      split->prefix_len_ = static_cast<uint8_t>(mismatch);
+      memcpy(split->prefix_, node->prefix_, mismatch);
+      AddChild(split, node->prefix_[mismatch], node);
+      AddChild(split, bytes[depth + mismatch], new Leaf(key, {value}));
+      node->prefix_len_ = static_cast<uint8_t>(prefix_len - mismatch - 1);
+      memmove(node->prefix_, node->prefix_ + mismatch + 1, node->prefix_len_);
+      ChangeChild(parent, parent_byte, split);
+      WriteUnlock(node);
+      WriteUnlock(parent);
+      *inserted = true;
+      return true;
+    }
+    depth += prefix_len;
+    uint8_t byte = bytes[depth];
+    Node *child = FindChild(node, byte);
+    if (!Validate(node, version)) {
+      return false;
+    }
+
+    if (child == nullptr) {
+      if (IsFull(node)) {
+        // replace node by a bigger copy (never the root, it is never full)
+        if (!Upgrade(parent, parent_version)) {
+          return false;
+        }
+        if (!Upgrade(node, version)) {
+          WriteUnlock(parent);
+          return false;
+        }
+        InnerNode *bigger = Grow(node);
+        AddChild(bigger, byte, new Leaf(key, {value}));
+        ChangeChild(parent, parent_byte, bigger);
+        WriteUnlockObsolete(node);
+        WriteUnlock(parent);
+        Retire(node);
+      } else {
+        if (!Upgrade(node, version)) {
+          return false;
+        }
+        AddChild(node, byte, new Leaf(key, {value}));
+        WriteUnlock(node);
+      }
+      *inserted = true;
+      return true;
+    }
+
+    if (child->type_ == NodeType::LEAF) {
+      auto leaf = static_cast<Leaf *>(child);
+      if (!Upgrade(node, version)) {
+        return false;
+      }
+      if (memcmp(&leaf->key_, &key, KEY_SIZE) == 0) {
+        if (unique_key_ || std::find(leaf->values_.begin(), leaf->values_.end(), value) != leaf->values_.end()) {
+          WriteUnlock(node);
+          *inserted = false;
+          return true;
+        }
+        std::vector<ValueType> values = leaf->values_;
+        values.push_back(value);
+        ChangeChild(node, byte, new Leaf(key, std::move(values)));
+        WriteUnlock(node);
+        Retire(leaf);
+      } else {
+        // lazy expansion, both leaves go below a Node4 holding the bytes they share
+        const uint8_t *leaf_bytes = KeyBytes(leaf->key_);
+        size_t common = 0;
+        while (leaf_bytes[depth + 1 + common] == bytes[depth + 1 + common]) {
+          common++;
+        }
+        auto expanded = new Node4();
+        expanded->prefix_len_ = static_cast<uint8_t>(common);
+        memcpy(expanded->prefix_, bytes + depth + 1, common);
+        AddChild(expanded, leaf_bytes[depth + 1 + common], leaf);
+        AddChild(expanded, bytes[depth + 1 + common], new Leaf(key, {value}));
+        ChangeChild(node, byte, expanded);
+        WriteUnlock(node);
+      }
+      *inserted = true;
+      return true;
+    }
+
+    auto inner_child = static_cast<InnerNode *>(child);
+    uint64_t child_version;
+    if (!ReadLock(inner_child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::Remove(const KeyType &key, const ValueType &value) {
+  OperationGuard guard(this);
+  bool removed;
+  while (!TryRemove(key, value, &removed)) {
+  }
+  return removed;
+}
+
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::TryRemove(const KeyType &key, const ValueType &value, bool *removed) {
+  const uint8_t *bytes = KeyBytes(key);
+  InnerNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  size_t depth = 0;
+  while (true) {
+    size_t prefix_len = node->prefix_len_;
+    if (depth + prefix_len >= KEY_SIZE) {
+      return false;
+    }
+    if (PrefixMismatch(node, bytes, depth) < prefix_len) {
+      *removed = false;
+      return Validate(node, version);
+    }
+    depth += prefix_len;
+    uint8_t byte = bytes[depth];
+    Node *child = FindChild(node, byte);
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      *removed = false;
+      return true;
+    }
+
+    if (child->type_ == NodeType::LEAF) {
+      auto leaf = static_cast<Leaf *>(child);
+      auto position = std::find(leaf->values_.begin(), leaf->values_.end(), value);
+      if (memcmp(&leaf->key_, &key, KEY_SIZE) != 0 || (!unique_key_ && position == leaf->values_.end())) {
+        *removed = false;
+        return true;
+      }
+      if (!Upgrade(node, version)) {
+        return false;
+      }
+      if (unique_key_ || leaf->values_.size() == 1) {
+        RemoveChild(node, byte);
+      } else {
+        std::vector<ValueType> values(leaf->values_.begin(), position);
+        values.insert(values.end(), position + 1, leaf->values_.end());
+        ChangeChild(node, byte, new Leaf(key, std::move(values)));
+      }
+      WriteUnlock(node);
+      Retire(leaf);
+      *removed = true;
+      return true;
+    }
+
+    auto inner_child = static_cast<InnerNode *>(child);
+    uint64_t child_version;
+    if (!ReadLock(inner_child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    node = inner_child;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+size_t ART_TYPE::PrefixMismatch(const InnerNode *node, const uint8_t *bytes, size_t depth) {
+  size_t prefix_len = node->prefix_len_;
+  for (size_t i = 0; i < prefix_len; i++) {
+    if (node->prefix_[i] != bytes[depth + i]) {
+      return i;
+    }
+  }
+  return prefix_len;
+}
+
+template <typename KeyType, typename ValueType>
+typename ART_TYPE::Node *ART_TYPE::FindChild(const InnerNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<const Node4 *>(node);
+      for (int i = 0; i < std::min<int>(node4->count_, 4); i++) {
+        if (node4->keys_[i] == byte) {
+          return node4->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<const Node16 *>(node);
+      for (int i = 0; i < std::min<int>(node16->count_, 16); i++) {
+        if (node16->keys_[i] == byte) {
+          return node16->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE48: {
+      auto node48 = static_cast<const Node48 *>(node);
+      uint8_t slot = node48->child_index_[byte];
+      return slot == 0 ? nullptr : node48->children_[slot - 1];
+    }
+    case NodeType::NODE256:
+      return static_cast<const Node256 *>(node)->children_[byte];
+    default:
+      return nullptr;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::IsFull(const InnerNode *node) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+      return node->count_ == 4;
+    case NodeType::NODE16:
+      return node->count_ == 16;
+    case NodeType::NODE48:
+      return node->count_ == 48;
+    default:
+      return false;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::AddChild(InnerNode *node, uint8_t byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<Node4 *>(node);
+      node4->keys_[node4->count_] = byte;
+      node4->children_[node4->count_] = child;
+      break;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<Node16 *>(node);
+      node16->keys_[node16->count_] = byte;
+      node16->children_[node16->count_] = child;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto node48 = static_cast<Node48 *>(node);
+      uint8_t slot = 0;
+      while (node48->children_[slot] != nullptr) {
+        slot++;
+      }
+      node48->children_[slot] = child;
+      node48->child_index_[byte] = slot + 1;
+      break;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+      break;
+    default:
+      break;
+  }
+  node->count_++;
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::ChangeChild(InnerNode *node, uint8_t byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < node4->count_; i++) {
+        if (node4->keys_[i] == byte) {
+          node4->children_[i] = child;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<Node16 *>(node);
+      for (int i = 0; i < node16->count_; i++) {
+        if (node16->keys_[i] == byte) {
+          node16->children_[i] = child;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      auto node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1] = child;
+      break;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * Node4 and Node16 fill the hole with their last child, children are not
+ * kept in order
+ */
+template <typename KeyType, typename ValueType>
+void ART_TYPE::RemoveChild(InnerNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < node4->count_; i++) {
+        if (node4->keys_[i] == byte) {
+          node4->keys_[i] = node4->keys_[node4->count_ - 1];
+          node4->children_[i] = node4->children_[node4->count_ - 1];
+          break;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<Node16 *>(node);
+      for (int i = 0; i < node16->count_; i++) {
+        if (node16->keys_[i] == byte) {
+          node16->keys_[i] = node16->keys_[node16->count_ - 1];
+          node16->children_[i] = node16->children_[node16->count_ - 1];
+          break;
+        }
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      auto node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1] = nullptr;
+      node48->child_index_[byte] = 0;
+      break;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = nullptr;
+      break;
+    default:
+      break;
+  }
+  node->count_--;
+}
+
+template <typename KeyType, typename ValueType>
+typename ART_TYPE::InnerNode *ART_TYPE::Grow(const InnerNode *node) {
+  InnerNode *bigger;
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<const Node4 *>(node);
+      auto node16 = new Node16();
+      memcpy(node16->keys_, node4->keys_, sizeof(node4->keys_));
+      memcpy(node16->children_, node4->children_, sizeof(node4->children_));
+      bigger = node16;
+      break;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<const Node16 *>(node);
+      auto node48 = new Node48();
+      for (uint8_t i = 0; i < 16; i++) {
+        node48->child_index_[node16->keys_[i]] = i + 1;
+        node48->children_[i] = node16->children_[i];
+      }
+      bigger = node48;
+      break;
+    }
+    default: {
+      auto node48 = static_cast<const Node48 *>(node);
+      auto node256 = new Node256();
+      for (int byte = 0; byte < 256; byte++) {
+        if (node48->child_index_[byte] != 0) {
+          node256->children_[byte] = node48->children_[node48->child_index_[byte] - 1];
+        }
+      }
+      bigger = node256;
+      break;
+    }
+  }
+  bigger->count_ = node->count_;
+  bigger->prefix_len_ = node->prefix_len_;
+  memcpy(bigger->prefix_, node->prefix_, node->prefix_len_);
+  return bigger;
+}
+
+/*****************************************************************************
+ * OPTIMISTIC LOCK COUPLING
+ *****************************************************************************/
+/*
+ * @return: false if node is being changed or was replaced
+ */
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::ReadLock(const InnerNode *node, uint64_t *version) {
+  *version = node->version_.load();
+  return (*version & (LOCKED_BIT | OBSOLETE_BIT)) == 0;
+}
+
+/*
+ * @return: false if node changed since version was read
+ */
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::Validate(const InnerNode *node, uint64_t version) {
+  return node->version_.load() == version;
+}
+
+template <typename KeyType, typename ValueType>
+bool ART_TYPE::Upgrade(InnerNode *node, uint64_t version) {
+  return node->version_.compare_exchange_strong(version, version + LOCKED_BIT);
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::WriteUnlock(InnerNode *node) {
+  node->version_.fetch_add(LOCKED_BIT);
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::WriteUnlockObsolete(InnerNode *node) {
+  node->version_.fetch_add(LOCKED_BIT | OBSOLETE_BIT);
+}
+
+/*****************************************************************************
+ * MEMORY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType>
+void ART_TYPE::DeleteNode(Node *node) {
+  switch (node->type_) {
+    case NodeType::LEAF:
+      delete static_cast<Leaf *>(node);
+      break;
+    case NodeType::NODE4:
+      delete static_cast<Node4 *>(node);
+      break;
+    case NodeType::NODE16:
+      delete static_cast<Node16 *>(node);
+      break;
+    case NodeType::NODE48:
+      delete static_cast<Node48 *>(node);
+      break;
+    case NodeType::NODE256:
+      delete static_cast<Node256 *>(node);
+      break;
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::DeleteTree(Node *node) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < node4->count_; i++) {
+        DeleteTree(node4->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto node16 = static_cast<Node16 *>(node);
+      for (int i = 0; i < node16->count_; i++) {
+        DeleteTree(node16->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE48:
+      for (auto child : static_cast<Node48 *>(node)->children_) {
+        if (child != nullptr) {
+          DeleteTree(child);
+        }
+      }
+      break;
+    case NodeType::NODE256:
+      for (auto child : static_cast<Node256 *>(node)->children_) {
+        if (child != nullptr) {
+          DeleteTree(child);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+  DeleteNode(node);
+}
+
+template <typename KeyType, typename ValueType>
+size_t ART_TYPE::GetRetiredCount() {
+  return retired_count_.load();
+}
+
+/*
+ * The epoch read here is not older than the one any operation still able to
+ * reach node announced: node is already unlinked, an operation announcing a
+ * later epoch started after it was.
+ */
+template <typename KeyType, typename ValueType>
+void ART_TYPE::Retire(Node *node) {
+  std::lock_guard<std::mutex> guard(retired_latch_);
+  retired_.emplace_back(global_epoch_.load(), node);
+  retired_count_++;
+}
+
+/*
+ * A thread starts looking for a free slot at the same place every time, so
+ * it keeps reusing a slot whose cache line it already owns.
+ */
+template <typename KeyType, typename ValueType>
+typename ART_TYPE::EpochSlot *ART_TYPE::EnterOperation() {
+  static thread_local size_t slot_hint = std::hash<std::thread::id>{}(std::this_thread::get_id()) % EPOCH_SLOTS;
+  for (size_t i = slot_hint;; i = (i + 1) % EPOCH_SLOTS) {
+    auto slot = &epoch_slots_[i];
+    uint64_t idle = IDLE_EPOCH;
+    if (slot->epoch_.load(std::memory_order_relaxed) == IDLE_EPOCH &&
+        slot->epoch_.compare_exchange_strong(idle, global_epoch_.load())) {
+      slot_hint = i;
+      return slot;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType>
+void ART_TYPE::LeaveOperation(EpochSlot *slot) {
+  slot->epoch_.store(IDLE_EPOCH);
+  if (retired_count_.load(std::memory_order_relaxed) >= RECLAIM_THRESHOLD) {
+    Reclaim();
+  }
+}
+
+/*
+ * Operations that start after the epoch moved on announce the new epoch or a
+ * later one, so every node retired before is out of their reach. What the
+ * operations still running announced bounds the rest.
+ */
+template <typename KeyType, typename ValueType>
+void ART_TYPE::Reclaim() {
+  std::unique_lock<std::mutex> guard(retired_latch_, std::try_to_lock);
+  if (!guard.owns_lock()) {
+    return;
+  }
+  uint64_t min_epoch = ++global_epoch_;
+  for (auto &slot : epoch_slots_) {
+    min_epoch = std::min(min_epoch, slot.epoch_.load());
+  }
+  auto end = std::partition(retired_.begin(), retired_.end(),
+                            [min_epoch](const std::pair<uint64_t, Node *> &retired) {
+                              return retired.first >= min_epoch;
+                            });
+  for (auto iter = end; iter != retired_.end(); ++iter) {
+    DeleteNode(iter->second);
+  }
+  retired_.erase(end, retired_.end());
+  retired_count_.store(retired_.size());
+}
+
+template class AdaptiveRadixTree<GenericKey<4>, RID>;
+template class AdaptiveRadixTree<GenericKey<8>, RID>;
+template class AdaptiveRadixTree<GenericKey<16>, RID>;
+template class AdaptiveRadixTree<GenericKey<32>, RID>;
+template class AdaptiveRadixTree<GenericKey<64>, RID>;
+
+}  // namespace bustub
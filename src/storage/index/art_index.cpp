@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/art_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+namespace bustub {
+/*
+ * Constructor, the tree lives in memory and does not use the buffer pool
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ART_INDEX_TYPE::ArtIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata), container_(metadata->IsUnique()) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, rid);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void ART_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result);
+}
+
+template class ArtIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class ArtIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class ArtIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class ArtIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class ArtIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
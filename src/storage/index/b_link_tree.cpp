@@ -0,0 +1,452 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_link_tree.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/b_link_tree.h"
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_TYPE::BLinkTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                          int leaf_max_size, int internal_max_size, bool unique_key)
+    : index_name_(std::move(name)),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size),
+      unique_key_(unique_key) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::IsEmpty() const { return root_page_id_.load() == INVALID_PAGE_ID; }
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the values associated with input key, in value order.
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  size_t size = result->size();
+  ScanRange(&key, true, &key, true, result, transaction);
+  return result->size() > size;
+}
+
+/*
+ * Walk the leaf level through the right links. Only the current leaf is
+ * latched; a leaf split after it was read moves entries that were already
+ * collected, and the right link read with them skips the new sibling.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high, bool high_inclusive,
+                               std::vector<ValueType> *result, Transaction *transaction) {
+  Probe probe{low, nullptr};
+  Page *page = Descend(probe, 0, false, nullptr);
+  if (page == nullptr) {
+    return;
+  }
+
+  auto node = reinterpret_cast<Node *>(page->GetData());
+  int index = LowerBound(node, probe);
+  while (true) {
+    for (; index < node->GetSize(); ++index) {
+      const Entry &entry = node->EntryAt(index);
+      if (low != nullptr && !low_inclusive && comparator_(entry.key, *low) == 0) {
+        continue;
+      }
+      if (high != nullptr) {
+        int result_of_compare = comparator_(entry.key, *high);
+        if (result_of_compare > 0 || (result_of_compare == 0 && !high_inclusive)) {
+          Release(page, false, false);
+          return;
+        }
+      }
+      result->push_back(entry.value);
+    }
+    // the right sibling starts at the high key
+    if (!node->HasHighKey() || (high != nullptr && comparator_(node->HighKey().key, *high) > 0)) {
+      break;
+    }
+    page_id_t right_page_id = node->GetRightPageId();
+    Release(page, false, false);
+    page = FetchNode(right_page_id);
+    Latch(page, false);
+    node = reinterpret_cast<Node *>(page->GetData());
+    index = 0;
+  }
+  Release(page, false, false);
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert constant key & value pair into the B-link tree
+ * @return: false if the key is already there (unique tree), or the pair is
+ * already there (non-unique tree)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  Entry entry{key, value, INVALID_PAGE_ID};
+  Probe probe{&key, &value};
+  while (true) {
+    std::vector<page_id_t> path;
+    Page *page = Descend(probe, 0, true, &path);
+    if (page == nullptr) {
+      if (StartNewTree(entry)) {
+        return true;
+      }
+      // another insert created the root first
+      continue;
+    }
+
+    auto node = reinterpret_cast<Node *>(page->GetData());
+    int index = LowerBound(node, probe);
+    if (index < node->GetSize() && Compare(probe, node->EntryAt(index)) == 0) {
+      Release(page, true, false);
+      return false;
+    }
+    InsertIntoNode(page, entry, &path);
+    return true;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::StartNewTree(const Entry &entry) {
+  std::lock_guard<std::mutex> guard(root_latch_);
+  if (root_page_id_.load() != INVALID_PAGE_ID) {
+    return false;
+  }
+
+  page_id_t root_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'StartNewTree' BufferPoolManager::NewPage FAIL!");
+  }
+  auto root = reinterpret_cast<Node *>(page->GetData());
+  root->Init(root_page_id, 0, leaf_max_size_);
+  root->InsertAt(0, entry);
+  buffer_pool_manager_->UnpinPage(root_page_id, true);
+
+  root_page_id_.store(root_page_id);
+  UpdateRootPageId();
+  return true;
+}
+
+/*
+ * A full node hands its upper half to a new right sibling before the entry
+ * goes in, then the separator (the first entry of the sibling) goes up to
+ * the parent. Readers that reach the node meanwhile follow its right link.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::InsertIntoNode(Page *page, Entry entry, std::vector<page_id_t> *path) {
+  while (true) {
+    auto node = reinterpret_cast<Node *>(page->GetData());
+    Probe probe{&entry.key, &entry.value};
+    if (!node->IsFull()) {
+      node->InsertAt(node->IsLeafPage() ? LowerBound(node, probe) : UpperBound(node, probe), entry);
+      Release(page, true, true);
+      return;
+    }
+
+    // a node reached without a parent may be the root, which needs a new root
+    // above it; take that page now, a split cannot be undone when it fails
+    Page *root_page = nullptr;
+    if (path->empty()) {
+      page_id_t root_page_id;
+      root_page = buffer_pool_manager_->NewPage(&root_page_id);
+      if (root_page == nullptr) {
+        Release(page, true, false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "'InsertIntoNode' BufferPoolManager::NewPage FAIL!");
+      }
+    }
+    page_id_t sibling_page_id;
+    Page *sibling_page = buffer_pool_manager_->NewPage(&sibling_page_id);
+    if (sibling_page == nullptr) {
+      DropNewPage(root_page);
+      Release(page, true, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'InsertIntoNode' BufferPoolManager::NewPage FAIL!");
+    }
+    auto sibling = reinterpret_cast<Node *>(sibling_page->GetData());
+    sibling->Init(sibling_page_id, node->GetLevel(), node->GetMaxSize());
+    node->MoveHalfTo(sibling);
+    Entry separator = sibling->EntryAt(0);
+    separator.child = sibling_page_id;
+
+    Node *target = Compare(probe, separator) < 0 ? node : sibling;
+    target->InsertAt(target->IsLeafPage() ? LowerBound(target, probe) : UpperBound(target, probe), entry);
+    buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+
+    Page *parent = LatchParent(page, separator, path, root_page);
+    Release(page, true, true);
+    if (parent == nullptr) {
+      return;
+    }
+    page = parent;
+    entry = separator;
+  }
+}
+
+/*
+ * Latch the node the separator of the split page goes into, or turn root_page
+ * into a new root over the page. If this throws, the page is released first:
+ * the split is complete and the sibling reachable through the right link,
+ * only the separator is missing from the parent.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::LatchParent(Page *page, const Entry &separator, std::vector<page_id_t> *path,
+                                  Page *root_page) {
+  auto node = reinterpret_cast<Node *>(page->GetData());
+  Probe probe{&separator.key, &separator.value};
+  try {
+    if (!path->empty()) {
+      // the parent read on the way down, or a node right of it if it was split since
+      page_id_t parent_page_id = path->back();
+      path->pop_back();
+      Page *parent = FetchNode(parent_page_id);
+      Latch(parent, true);
+      return MoveRight(parent, probe, true);
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(root_latch_);
+      if (root_page_id_.load() == node->GetPageId()) {
+        page_id_t root_page_id = root_page->GetPageId();
+        auto root = reinterpret_cast<Node *>(root_page->GetData());
+        root->Init(root_page_id, node->GetLevel() + 1, internal_max_size_);
+        Entry first = separator;
+        first.child = node->GetPageId();
+        root->InsertAt(0, first);
+        root->InsertAt(1, separator);
+        buffer_pool_manager_->UnpinPage(root_page_id, true);
+
+        root_page_id_.store(root_page_id);
+        UpdateRootPageId();
+        return nullptr;
+      }
+    }
+
+    // the node was the root when it was reached, another split grew the tree since
+    DropNewPage(root_page);
+    return Descend(probe, node->GetLevel() + 1, true, path);
+  } catch (...) {
+    Release(page, true, true);
+    throw;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Delete the entry of key & value from the leaf covering it. Nodes are never
+ * merged, so only the leaf is latched.
+ * @return: false if there is no such entry
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  Probe probe{&key, &value};
+  Page *page = Descend(probe, 0, true, nullptr);
+  if (page == nullptr) {
+    return false;
+  }
+
+  auto node = reinterpret_cast<Node *>(page->GetData());
+  int index = LowerBound(node, probe);
+  bool found = index < node->GetSize() && Compare(probe, node->EntryAt(index)) == 0;
+  if (found) {
+    node->RemoveAt(index);
+  }
+  Release(page, true, found);
+  return found;
+}
+
+/*****************************************************************************
+ * UTILITIES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+int BLINKTREE_TYPE::Compare(const Probe &probe, const Entry &entry) const {
+  if (probe.key == nullptr) {
+    return -1;
+  }
+  int result = comparator_(*probe.key, entry.key);
+  if (result != 0) {
+    return result;
+  }
+  if (probe.value == nullptr) {
+    return -1;
+  }
+  if (unique_key_) {
+    return 0;
+  }
+  int64_t lhs = probe.value->Get();
+  int64_t rhs = entry.value.Get();
+  return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BLINKTREE_TYPE::LowerBound(const Node *node, const Probe &probe) const {
+  // the first internal entry has no key
+  int left = node->IsLeafPage() ? 0 : 1;
+  int right = node->GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (Compare(probe, node->EntryAt(mid)) > 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BLINKTREE_TYPE::UpperBound(const Node *node, const Probe &probe) const {
+  int left = node->IsLeafPage() ? 0 : 1;
+  int right = node->GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (Compare(probe, node->EntryAt(mid)) >= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::Covers(const Node *node, const Probe &probe) const {
+  return !node->HasHighKey() || Compare(probe, node->HighKey()) < 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::FetchNode(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FetchNode' BufferPoolManager::FetchPage FAIL!");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Latch(Page *page, bool exclusive) {
+  if (exclusive) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::Release(Page *page, bool exclusive, bool dirty) {
+  page_id_t page_id = page->GetPageId();
+  if (exclusive) {
+    page->WUnlatch();
+  } else {
+    page->RUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(page_id, dirty);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_TYPE::DropNewPage(Page *page) {
+  if (page != nullptr) {
+    page_id_t page_id = page->GetPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+/*
+ * Nodes are never deleted and a split only moves entries to the right, so the
+ * latch of the current node can be dropped before the right one is taken.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::MoveRight(Page *page, const Probe &probe, bool exclusive) {
+  auto node = reinterpret_cast<Node *>(page->GetData());
+  while (!Covers(node, probe)) {
+    page_id_t right_page_id = node->GetRightPageId();
+    Release(page, exclusive, false);
+    page = FetchNode(right_page_id);
+    Latch(page, exclusive);
+    node = reinterpret_cast<Node *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BLINKTREE_TYPE::Descend(const Probe &probe, int level, bool exclusive, std::vector<page_id_t> *path) {
+  page_id_t page_id = root_page_id_.load();
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+
+  while (true) {
+    Page *page = FetchNode(page_id);
+    // the level of a node never changes, it can be read before the latch
+    bool exclusive_latch = exclusive && reinterpret_cast<Node *>(page->GetData())->GetLevel() == level;
+    Latch(page, exclusive_latch);
+    page = MoveRight(page, probe, exclusive_latch);
+
+    auto node = reinterpret_cast<Node *>(page->GetData());
+    if (node->GetLevel() == level) {
+      return page;
+    }
+    if (path != nullptr) {
+      path->push_back(node->GetPageId());
+    }
+    page_id = node->EntryAt(UpperBound(node, probe) - 1).child;
+    Release(page, false, false);
+  }
+}
+
+/*
+ * Write the root page id into the header page if it changed since the last
+ * flush.
+ * @return: false if the header page has no room for a new record
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BLINKTREE_TYPE::FlushRootPageId() {
+  std::lock_guard<std::mutex> guard(root_latch_);
+  if (!root_page_id_dirty_) {
+    return true;
+  }
+
+  auto page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FlushRootPageId' BufferPoolManager::FetchPage FAIL!");
+  }
+  page->WLatch();
+  auto header_page = static_cast<HeaderPage *>(page);
+  page_id_t root_page_id = root_page_id_.load();
+  bool flushed = header_page->UpdateRecord(index_name_, root_page_id) || root_page_id == INVALID_PAGE_ID ||
+                 header_page->InsertRecord(index_name_, root_page_id);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, flushed);
+
+  root_page_id_dirty_ = !flushed;
+  return flushed;
+}
+
+template class BLinkTree<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTree<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTree<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/b_link_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/b_link_tree_index.h"
+
+#include <algorithm>
+
+#include "common/logger.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_INDEX_TYPE::BLinkTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata),
+      comparator_(metadata->GetKeySchema()),
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, B_LINK_TREE_PAGE_SIZE, B_LINK_TREE_PAGE_SIZE,
+                 metadata->IsUnique()) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct insert index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Insert(index_key, rid, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  // construct delete index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.Remove(index_key, rid, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  // construct scan index key
+  KeyType index_key;
+  index_key.SetFromKey(key);
+
+  container_.GetValue(index_key, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                     bool high_inclusive, ScanDirection direction, std::vector<RID> *result,
+                                     Transaction *transaction) {
+  // construct the bounds of the scan
+  KeyType low;
+  KeyType high;
+  if (low_key != nullptr) {
+    low.SetFromKey(*low_key);
+  }
+  if (high_key != nullptr) {
+    high.SetFromKey(*high_key);
+  }
+
+  // nodes only link to the right, a backward scan reverses a forward one
+  size_t begin = result->size();
+  container_.ScanRange(low_key != nullptr ? &low : nullptr, low_inclusive, high_key != nullptr ? &high : nullptr,
+                       high_inclusive, result, transaction);
+  if (direction == ScanDirection::BACKWARD) {
+    std::reverse(result->begin() + begin, result->end());
+  }
+}
+
+/*
+ * Root changes since the last checkpoint would be lost with the index, the
+ * header page may have no room left for them, which only a checkpoint reports
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BLINKTREE_INDEX_TYPE::~BLinkTreeIndex() {
+  try {
+    container_.FlushRootPageId();
+  } catch (Exception &e) {
+    LOG_WARN("root page id of %s not flushed: %s", GetName().c_str(), e.what());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BLINKTREE_INDEX_TYPE::Checkpoint() {
+  if (!container_.FlushRootPageId()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "header page has no room for the root of " + GetName());
+  }
+}
+
+template class BLinkTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class BLinkTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class BLinkTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class BLinkTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class BLinkTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
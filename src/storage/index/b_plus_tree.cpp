@@ -10,6 +10,9 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/index/b_plus_tree.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <string>
 #include "common/exception.h"
 #include "common/logger.h"
@@ -22,13 +25,24 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool unique_key, MergePolicy merge_policy)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      unique_key_(unique_key),
+      merge_policy_(merge_policy) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  // the cached root only picked up SetDirty() while the tree held it, so hand the flag back with the pin
+  Page *root_page = root_page_.exchange(nullptr);
+  if (root_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(root_page->GetPageId(), root_page->IsDirty());
+  }
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -39,8 +53,9 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID;
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
- * This method is used for point query
+ * Return the value(s) that associated with input key
+ * This method is used for point query, every value of a duplicated key is
+ * appended to result
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
@@ -60,7 +75,13 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   ValueType val;
   bool ok = PageAsLeafPage(leaf_page)->Lookup(key, &val, comparator_);
 
-  if (ok) result->push_back(val);
+  if (ok) {
+    if (IsPostingList(val)) {
+      CollectPostingList(PostingListPageId(val), result);
+    } else {
+      result->push_back(val);
+    }
+  }
 
   if (transaction) ReleaseAllLatch(transaction, OperatorFind, false);
   else  {
@@ -71,6 +92,78 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return ok;
 }
 
+/*
+ * Batched point query. The keys are probed in sorted order, so consecutive
+ * keys are mostly found in the leaf already latched or in the next one, and
+ * the tree is only descended again when a key lies further right.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result) {
+  result->assign(keys.size(), std::vector<ValueType>{});
+
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return comparator_(keys[lhs], keys[rhs]) < 0; });
+
+  Page *page = nullptr;
+  for (auto i : order) {
+    const KeyType &key = keys[i];
+    if (page != nullptr) {
+      page = StepRightFor(page, key);
+    }
+    if (page == nullptr) {
+      page = FindLeafPageRead(key);
+      if (page == nullptr) {
+        return;
+      }
+    }
+
+    ValueType val;
+    if (PageAsLeafPage(page)->Lookup(key, &val, comparator_)) {
+      if (IsPostingList(val)) {
+        CollectPostingList(PostingListPageId(val), &(*result)[i]);
+      } else {
+        (*result)[i].push_back(val);
+      }
+    }
+  }
+
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::StepRightFor(Page *page, const KeyType &key) {
+  auto leaf = PageAsLeafPage(page);
+  int size = leaf->GetSize();
+  auto next_page_id = leaf->GetNextPageId();
+  if (size == 0 || leaf->CompareKeyAt(size - 1, key, comparator_) >= 0 || next_page_id == INVALID_PAGE_ID) {
+    return page;
+  }
+
+  // latch to the right before releasing, as forward iterators do
+  auto next_page = buffer_pool_manager_->FetchPage(next_page_id);
+  if (next_page == nullptr) {
+    throw Exception{ExceptionType::OUT_OF_MEMORY, "StepRightFor Out Of Memory"};
+  }
+  next_page->RLatch();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+  auto next_leaf = PageAsLeafPage(next_page);
+  int next_size = next_leaf->GetSize();
+  if (next_leaf->GetNextPageId() == INVALID_PAGE_ID || next_size == 0 ||
+      next_leaf->CompareKeyAt(next_size - 1, key, comparator_) >= 0) {
+    return next_page;
+  }
+  next_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, false);
+  return nullptr;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -78,8 +171,9 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: false if a unique tree already holds key, whatever its value, or
+ * if a non-unique tree already holds this exact key & value pair; a
+ * non-unique tree adds a new value for an existing key and returns true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
@@ -102,7 +196,9 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 
   bool ret = InsertIntoLeaf(key, value, transaction);
 
-  ReleaseAllLatch(transaction, OperatorInsert, true);
+  // pages that changed are marked dirty on the way, the rest of the path stays clean
+  ReleaseAllLatch(transaction, OperatorInsert, false);
+  ApplyPrevLinks();
 
   return ret;
 }
@@ -124,11 +220,11 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   }
 
   root_page_id_ = page_id;
-  UpdateRootPageId(0);
+  UpdateRootPageId();
 
   auto leaf_page = AsLeafPage(TreePage(page));
   leaf_page->SetPageType(IndexPageType::LEAF_PAGE);
-  leaf_page->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf_page->Init(page_id, leaf_max_size_);
   leaf_page->Insert(key, value, comparator_);
   leaf_page->SetNextPageId(INVALID_PAGE_ID);
 
@@ -140,8 +236,11 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * A non-unique tree appends the value of an existing key to its posting list
+ * instead, so the leaf never splits because of duplicates.
+ * @return: for unique key, if user try to insert duplicate keys return false,
+ * for non-unique key, if the key & value pair already exists return false,
+ * otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
@@ -156,14 +255,20 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(page->GetData());
 
-  ValueType v{};
-  if (leaf_node->Lookup(key, &v, comparator_)) {
-      // Contain Key
+  int key_index = leaf_node->KeyIndex(key, comparator_);
+  if (key_index != -1 && leaf_node->CompareKeyAt(key_index, key, comparator_) == 0) {
+    // Contain Key
+    if (unique_key_ || !AppendToPostingList(leaf_node, key_index, value)) {
       return false;
+    }
+    page->SetDirty();
+    return true;
   }
 
-  int size = leaf_node->Insert(key, value, comparator_);
-  if (size >= leaf_node->GetMaxSize()) {
+  // A key that shares little with the page may not fit even below max size,
+  // then the page is split first and the key goes into the half covering it
+  bool inserted = leaf_node->HasRoomFor(key);
+  if (!inserted || leaf_node->Insert(key, value, comparator_) >= leaf_node->GetMaxSize()) {
     LeafPage *new_leaf_node = Split(leaf_node);
 
     if (new_leaf_node == nullptr) {
@@ -173,9 +278,17 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 
     leaf_node->MoveHalfTo(new_leaf_node);
     new_leaf_node->SetNextPageId(leaf_node->GetNextPageId());
+    new_leaf_node->SetPrevPageId(leaf_node->GetPageId());
+    RelinkPrevPageId(new_leaf_node->GetNextPageId(), leaf_node->GetPageId(), new_leaf_node->GetPageId());
     leaf_node->SetNextPageId(new_leaf_node->GetPageId());
 
-    InsertIntoParent(leaf_node, new_leaf_node->KeyAt(0), new_leaf_node, transaction);
+    if (!inserted) {
+      auto target = new_leaf_node->CompareKeyAt(0, key, comparator_) > 0 ? leaf_node : new_leaf_node;
+      target->Insert(key, value, comparator_);
+    }
+
+    auto separator = ShortestSeparator(leaf_node->KeyAt(leaf_node->GetSize() - 1), new_leaf_node->KeyAt(0));
+    InsertIntoParent(leaf_node, separator, new_leaf_node, transaction);
 
     buffer_pool_manager_->UnpinPage(new_leaf_node->GetPageId(), true);
   }
@@ -205,11 +318,11 @@ N *BPLUSTREE_TYPE::Split(N *node) {
   auto basic_node = reinterpret_cast<BPlusTreePage *>(node);
   if (basic_node->IsLeafPage()) {
     auto new_leaf_node = reinterpret_cast<N *>(page->GetData());
-    new_leaf_node->Init(page_id, basic_node->GetParentPageId(), leaf_max_size_);
+    new_leaf_node->Init(page_id, leaf_max_size_);
     new_leaf_node->SetPageType(IndexPageType::LEAF_PAGE);
   } else {
     auto new_internal_node = reinterpret_cast<N *>(page->GetData());
-    new_internal_node->Init(page_id, basic_node->GetParentPageId(), internal_max_size_);
+    new_internal_node->Init(page_id, internal_max_size_);
     new_internal_node->SetPageType(IndexPageType::INTERNAL_PAGE);
   }
 
@@ -224,33 +337,34 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is the page above old_node on the latched path, a page that may
+ * split never lets go of its parent while going down.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
   LOG_DEBUG("InsertInToParent old_node page_id{%d} new_node page_id{%d}", old_node->GetPageId(), new_node->GetPageId());
-  if (old_node->IsRootPage()) {
+  if (old_node->GetPageId() == root_page_id_) {
     LOG_DEBUG("old_node {%d} Is root page", old_node->GetPageId());
     page_id_t new_root_page_id = INVALID_PAGE_ID;
     Page *new_root_page = buffer_pool_manager_->NewPage(&new_root_page_id);
 
-    new_root_page->WLatch();
-
     if (new_root_page == nullptr) {
       throw bustub::Exception(ExceptionType::OUT_OF_MEMORY, "'InsertInToParent' new_root_page == nullptr");
     }
 
+    new_root_page->WLatch();
+
     auto new_root_internal_node = reinterpret_cast<InternalPage *>(new_root_page->GetData());
 
     TreePage(new_root_page)->SetPageType(IndexPageType::INTERNAL_PAGE);
-    new_root_internal_node->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    new_root_internal_node->Init(new_root_page_id, internal_max_size_);
 
-    old_node->SetParentPageId(new_root_page_id);
-    new_node->SetParentPageId(new_root_page_id);
     new_root_internal_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
 
     root_page_id_ = new_root_page_id;
-    UpdateRootPageId(0);
+    UpdateRootPageId();
+    CacheRootPage(transaction);
 
     new_root_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(new_root_page_id, true);
@@ -258,22 +372,23 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   }
 
 
-  auto parent_page_id = old_node->GetParentPageId();
-  auto parent_page = buffer_pool_manager_->FetchPage(parent_page_id, nullptr);
-
-  if (parent_page == nullptr) {
-    throw bustub::Exception(ExceptionType::OUT_OF_MEMORY, "'InsertIntoParent' BufferPoolManager::FetchPage FAIL");
-  }
-
-  // For debug :) assert(parent_page->IsLocked());
+  auto parent_page = ParentPageOf(old_node->GetPageId(), transaction);
 
   InternalPage *parent_internal_node = PageAsInternalPage(parent_page);
 
-  int size = parent_internal_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-
-  if (size >= parent_internal_node->GetMaxSize()) {
+  // Same as the leaf, split first if the key doesn't fit below max size
+  bool inserted = parent_internal_node->HasRoomFor(key);
+  if (!inserted || parent_internal_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId()) >=
+                       parent_internal_node->GetMaxSize()) {
     InternalPage *new_parent_internal_node = Split(parent_internal_node);
-    parent_internal_node->MoveHalfTo(new_parent_internal_node, buffer_pool_manager_);
+    parent_internal_node->MoveHalfTo(new_parent_internal_node);
+
+    if (!inserted) {
+      auto target = new_parent_internal_node->ValueIndex(old_node->GetPageId()) != -1 ? new_parent_internal_node
+                                                                                        : parent_internal_node;
+      target->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    }
+
     InsertIntoParent(parent_internal_node, new_parent_internal_node->KeyAt(0), new_parent_internal_node, transaction);
     buffer_pool_manager_->UnpinPage(new_parent_internal_node->GetPageId(), true);
   }
@@ -294,6 +409,25 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  RemoveEntry(key, nullptr, transaction);
+}
+
+/*
+ * Delete one key & value pair
+ * Other values of a duplicated key stay in the tree, the key itself is only
+ * removed from its leaf once its last value is gone. A unique tree ignores the
+ * value and behaves like Remove(key).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveEntry(key, &value, transaction);
+}
+
+/*
+ * Shared by both Remove(), value == nullptr means every value of key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
 
   LOG_DEBUG("Remove %ld", key.ToString());
 
@@ -309,45 +443,75 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
 
   auto index = leaf_node->KeyIndex(key, comparator_);
 
-  if (index == -1 || comparator_(key, leaf_node->KeyAt(index)) != 0) {
+  if (index == -1 || leaf_node->CompareKeyAt(index, key, comparator_) != 0) {
     LOG_DEBUG("Can't find key ");
     ReleaseAllLatch(transaction, OperatorDelete, false);
     return;
   }
 
+  auto stored = leaf_node->ValueAt(index);
+  if (IsPostingList(stored)) {
+    if (value != nullptr) {
+      // The key stays in the leaf while it still has values
+      bool removed = RemoveFromPostingList(leaf_node, index, *value);
+      ReleaseAllLatch(transaction, OperatorDelete, removed);
+      DeleteAllOnSet(transaction);
+      return;
+    }
+    DeletePostingList(PostingListPageId(stored));
+  } else if (value != nullptr && !unique_key_ && !(stored == *value)) {
+    ReleaseAllLatch(transaction, OperatorDelete, false);
+    return;
+  }
+
   leaf_node->Remove(index);
+  page->SetDirty();
 
-  if (leaf_node->GetSize() < leaf_node->GetMinSize()) {
-   CoalesceOrRedistribute(leaf_node, transaction);
+  if (NeedsMerge(leaf_node, merge_policy_)) {
+    CoalesceOrRedistribute(leaf_node, merge_policy_, transaction);
   }
 
-  ReleaseAllLatch(transaction, OperatorDelete, true);
+  ReleaseAllLatch(transaction, OperatorDelete, false);
   DeleteAllOnSet(transaction);
+  ApplyPrevLinks();
+}
+
+/*
+ * Whether node is underflowed under policy, the root is left to AdjustRoot()
+ * whatever the policy
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::NeedsMerge(BPlusTreePage *node, MergePolicy policy) {
+  if (policy == MergePolicy::LAZY && node->GetPageId() != root_page_id_) {
+    return node->GetSize() < LazyMinSize(node);
+  }
+  return node->IsLeafPage() ? AsLeafPage(node)->IsUnderflow() : AsInternalPage(node)->IsUnderflow();
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
+ * With packed keys the pairs may not fit into one page even below max size,
+ * and the page may have no room for a pair of the sibling, it then stays
+ * underflowed.
  * Using template N to represent either internal page or leaf page.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, MergePolicy policy, Transaction *transaction) {
   // root比较特殊 ：）
 
-  if (reinterpret_cast<BPlusTreePage *>(node)->IsRootPage()) {
+  if (node->GetPageId() == root_page_id_) {
     return AdjustRoot(node, transaction);
   }
 
   auto tree_node = reinterpret_cast<BPlusTreePage*>(node);
 
-  auto parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+  // an underflowed page was not safe on the way down, so its parent is still latched
+  auto parent_page = ParentPageOf(node->GetPageId(), transaction);
   auto parent_internal_node = PageAsInternalPage(parent_page);
-  if (parent_page == nullptr) {
-    throw Exception{ExceptionType::OUT_OF_MEMORY, "CoalesceOrRedistribute Out Of Memory at fetching parent_page"};
-  }
 
   auto neighbor_page_id = INVALID_PAGE_ID;
   KeyType mid_key{};
@@ -361,20 +525,33 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
   if (neighbor_page == nullptr) {
     throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "CoalesceOrRedistribute Out Of Memory at fetching neighbor_page"};
   }
+  // writers that went past the parent may still work on a safe neighbor
+  neighbor_page->WLatch();
 
   auto neighbor_node = TreePage(neighbor_page);
-  if (TreePage(neighbor_page)->GetSize() + tree_node->GetSize() < tree_node->GetMaxSize()) {
-    Coalesce(&neighbor_node, &tree_node, &parent_internal_node, index, on_left, transaction);
-    if (on_left) {
-      buffer_pool_manager_->UnpinPage(neighbor_page_id, true);
-    }
-    return on_left;
+  bool can_merge;
+  if (tree_node->IsLeafPage()) {
+    can_merge = on_left ? AsLeafPage(neighbor_node)->CanMergeFrom(AsLeafPage(tree_node))
+                        : AsLeafPage(tree_node)->CanMergeFrom(AsLeafPage(neighbor_node));
   } else {
-    Redistribute(neighbor_node, tree_node, index, on_left);
-    buffer_pool_manager_->UnpinPage(neighbor_page_id, true);
+    can_merge = on_left ? AsInternalPage(neighbor_node)->CanMergeFrom(AsInternalPage(tree_node), mid_key)
+                        : AsInternalPage(tree_node)->CanMergeFrom(AsInternalPage(neighbor_node), mid_key);
   }
 
-  return false;
+  bool ret = false;
+  if (can_merge) {
+    parent_page->SetDirty();
+    Coalesce(&neighbor_node, &tree_node, &parent_internal_node, index, on_left, policy, transaction);
+    ret = on_left;
+  } else if (Redistribute(neighbor_node, tree_node, parent_internal_node, index, on_left)) {
+    parent_page->SetDirty();
+  }
+  // the pages on the path are unpinned with the latches, the neighbor is not on it
+  PathPageOf(node->GetPageId(), transaction)->SetDirty();
+  neighbor_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(neighbor_page_id, true);
+
+  return ret;
 }
 
 /*
@@ -393,7 +570,7 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              bool on_left, Transaction *transaction) {
+                              bool on_left, MergePolicy policy, Transaction *transaction) {
   LOG_DEBUG("Coalesce neighbor_node {%d} node {%d} parent {%d}",(*neighbor_node)->GetPageId(), (*node)->GetPageId(), (*parent)->GetPageId());
   auto tree_node = reinterpret_cast<BPlusTreePage *>(*node);
   auto sibling_node = reinterpret_cast<BPlusTreePage *>(*neighbor_node);
@@ -403,20 +580,20 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
     if (on_left) {
       AsLeafPage(tree_node)->MoveAllTo(AsLeafPage(sibling_node));
       AsLeafPage(sibling_node)->SetNextPageId(AsLeafPage(tree_node)->GetNextPageId());
+      RelinkPrevPageId(AsLeafPage(sibling_node)->GetNextPageId(), tree_node->GetPageId(), sibling_node->GetPageId());
       AddInToDeletePages(transaction, tree_node->GetPageId());
     } else {
       AsLeafPage(sibling_node)->MoveAllTo(AsLeafPage(tree_node));
       AsLeafPage(tree_node)->SetNextPageId(AsLeafPage(sibling_node)->GetNextPageId());
+      RelinkPrevPageId(AsLeafPage(tree_node)->GetNextPageId(), sibling_node->GetPageId(), tree_node->GetPageId());
       AddInToDeletePages(transaction, sibling_node->GetPageId());
     }
   } else {
     if (on_left) {
-      AsInternalPage(tree_node)->MoveAllTo(AsInternalPage(sibling_node), parent_internal_node->KeyAt(index),
-                                           buffer_pool_manager_);
+      AsInternalPage(tree_node)->MoveAllTo(AsInternalPage(sibling_node), parent_internal_node->KeyAt(index));
       AddInToDeletePages(transaction, tree_node->GetPageId());
     } else {
-      AsInternalPage(sibling_node)
-          ->MoveAllTo(AsInternalPage(tree_node), parent_internal_node->KeyAt(index), buffer_pool_manager_);
+      AsInternalPage(sibling_node)->MoveAllTo(AsInternalPage(tree_node), parent_internal_node->KeyAt(index));
       AddInToDeletePages(transaction, sibling_node->GetPageId());
     }
   }
@@ -425,8 +602,8 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
 
   bool ret = false;
 
-  if (parent_internal_node->GetSize() < parent_internal_node->GetMinSize()) {
-    ret = CoalesceOrRedistribute(parent_internal_node, transaction);
+  if (NeedsMerge(parent_internal_node, policy)) {
+    ret = CoalesceOrRedistribute(parent_internal_node, policy, transaction);
   }
 
   return ret;
@@ -440,51 +617,72 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node"
+ * @return  false if node or parent has no room for the moved key, nothing is
+ * changed then
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, bool on_left) {
+bool BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index, bool on_left) {
   LOG_DEBUG("Redistribute neighbor_node {%d} node {%d} ",(neighbor_node)->GetPageId(), (node)->GetPageId());
 
   auto sibling_node = reinterpret_cast<BPlusTreePage *>(neighbor_node);
   auto tree_node = reinterpret_cast<BPlusTreePage *>(node);
-  auto parent_page = buffer_pool_manager_->FetchPage(tree_node->GetParentPageId());
+  auto parent_internal_node = parent;
 
-  if (parent_page == nullptr) {
-    throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "Out Of Memory Redistribute Fetch parent's page"};
+  // the key that replaces the separator in parent
+  KeyType new_mid_key;
+  if (tree_node->IsLeafPage()) {
+    new_mid_key = on_left ? AsLeafPage(sibling_node)->KeyAt(sibling_node->GetSize() - 1)
+                          : AsLeafPage(sibling_node)->KeyAt(1);
+  } else {
+    new_mid_key = on_left ? AsInternalPage(sibling_node)->KeyAt(sibling_node->GetSize() - 1)
+                          : AsInternalPage(sibling_node)->KeyAt(1);
   }
 
-  auto parent_internal_node = PageAsInternalPage(parent_page);
-
-  if (tree_node->IsLeafPage()) {
-    if (on_left) {
-      AsLeafPage(sibling_node)->MoveLastToFrontOf(AsLeafPage(tree_node));
-      auto idx =index;
-      parent_internal_node->SetKeyAt(idx, AsLeafPage(tree_node)->KeyAt(0));
+  bool moved = false;
+  if (parent_internal_node->CanSetKeyAt(index, new_mid_key)) {
+    if (tree_node->IsLeafPage()) {
+      moved = on_left ? AsLeafPage(sibling_node)->MoveLastToFrontOf(AsLeafPage(tree_node))
+                      : AsLeafPage(sibling_node)->MoveFirstToEndOf(AsLeafPage(tree_node));
     } else {
-      AsLeafPage(sibling_node)->MoveFirstToEndOf(AsLeafPage(tree_node));
-      auto idx = index;
-      parent_internal_node->SetKeyAt(idx, AsLeafPage(sibling_node)->KeyAt(0));
+      auto mid_key = parent_internal_node->KeyAt(index);
+      moved = on_left ? AsInternalPage(sibling_node)->MoveLastToFrontOf(AsInternalPage(tree_node), mid_key)
+                      : AsInternalPage(sibling_node)->MoveFirstToEndOf(AsInternalPage(tree_node), mid_key);
     }
+  }
 
-  } else {
-    if (on_left) {
-      auto idx = index;
-      auto mid_key = parent_internal_node->KeyAt(idx);
-      auto new_mid_key = AsInternalPage(sibling_node)->KeyAt(sibling_node->GetSize() - 1);
-      AsInternalPage(sibling_node)->MoveLastToFrontOf(AsInternalPage(tree_node), mid_key, buffer_pool_manager_);
-      parent_internal_node->SetKeyAt(idx, new_mid_key);
-    } else {
-      auto idx = index;
-      auto mid_key = parent_internal_node->KeyAt(idx);
-      auto new_mid_key = AsInternalPage(sibling_node)->KeyAt(1);
-      AsInternalPage(sibling_node)->MoveFirstToEndOf(AsInternalPage(tree_node), mid_key, buffer_pool_manager_);
-      parent_internal_node->SetKeyAt(idx, new_mid_key);
-    }
+  if (moved) {
+    parent_internal_node->SetKeyAt(index, new_mid_key);
   }
 
-  buffer_pool_manager_->UnpinPage(sibling_node->GetPageId(), true);
+  return moved;
 }
+
+/*
+ * Separator pushed up when a leaf splits: the shortest prefix of right_key,
+ * padded with zero bytes, that still sorts after left_key. Zero padding packs
+ * away in the parent, so short separators keep the internal pages wide.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::ShortestSeparator(const KeyType &left_key, const KeyType &right_key) const {
+  KeyType separator;
+  auto raw = reinterpret_cast<char *>(&separator);
+  auto right_raw = reinterpret_cast<const char *>(&right_key);
+  memset(raw, 0, sizeof(KeyType));
+  for (size_t size = 0; size < sizeof(KeyType); ++size) {
+    raw[size] = right_raw[size];
+    if (right_raw[size] == 0) {
+      continue;
+    }
+    // right_key always qualifies, the prefix must keep the order on both sides
+    if (comparator_(left_key, separator) < 0 && comparator_(separator, right_key) <= 0) {
+      return separator;
+    }
+  }
+  return right_key;
+}
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -513,18 +711,361 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, Transaction* t) {
       // 此时只剩下一个叶节点连着一个internal
         auto old_root_internal_node = AsInternalPage(old_root_node);
         child_page_id = old_root_internal_node->RemoveAndReturnOnlyChild();
-        auto new_root_page_ptr = buffer_pool_manager_->FetchPage(child_page_id);
-        auto new_root_ptr = PageAsInternalPage(new_root_page_ptr);
-        new_root_ptr->SetParentPageId(INVALID_PAGE_ID);
-        buffer_pool_manager_->UnpinPage(child_page_id, true);
         t->AddIntoDeletedPageSet(old_root_internal_node->GetPageId());
     }
     root_page_id_ = child_page_id;
-    UpdateRootPageId(0);
+    UpdateRootPageId();
+    CacheRootPage(t);
 
     return true;
 }
 
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+/*
+ * Merge or redistribute every non-root page below half full, what an eager
+ * delete would have done. Pages are collected level by level from the root
+ * and handled bottom up, so a leaf merge that underflows its parent is
+ * handled before the parent's own turn. Each page is reached again by a key
+ * that routes to it, with the whole path write latched; a page that a
+ * redistribution moved away from its key is left for the next pass.
+ * The root latch is held throughout, no other operation enters the tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  struct Target {
+    page_id_t page_id_;
+    // route by key, or always take the first child
+    bool left_most_;
+    KeyType key_;
+  };
+
+  root_latch_.WLock();
+  if (IsEmpty()) {
+    root_latch_.WUnlock();
+    return;
+  }
+
+  std::vector<std::vector<Target>> underflowed;
+  std::vector<Target> level{Target{root_page_id_, true, KeyType{}}};
+  while (!level.empty()) {
+    std::vector<Target> next_level;
+    underflowed.emplace_back();
+    for (const auto &target : level) {
+      auto page = buffer_pool_manager_->FetchPage(target.page_id_);
+      if (page == nullptr) {
+        root_latch_.WUnlock();
+        throw Exception{ExceptionType::OUT_OF_MEMORY, "Compact Out Of Memory"};
+      }
+      auto node = TreePage(page);
+      if (target.page_id_ != root_page_id_ && NeedsMerge(node, MergePolicy::EAGER)) {
+        underflowed.back().push_back(target);
+      }
+      if (!node->IsLeafPage()) {
+        auto internal_node = AsInternalPage(node);
+        next_level.push_back(Target{internal_node->ValueAt(0), target.left_most_, target.key_});
+        for (int i = 1; i < internal_node->GetSize(); ++i) {
+          next_level.push_back(Target{internal_node->ValueAt(i), false, internal_node->KeyAt(i)});
+        }
+      }
+      buffer_pool_manager_->UnpinPage(target.page_id_, false);
+    }
+    level = std::move(next_level);
+  }
+
+  for (auto it = underflowed.rbegin(); it != underflowed.rend(); ++it) {
+    for (const auto &target : *it) {
+      Page *page = nullptr;
+      auto page_id = root_page_id_;
+      while (true) {
+        page = page_id == root_page_id_ ? FetchRootPage() : buffer_pool_manager_->FetchPage(page_id);
+        if (page == nullptr) {
+          ReleaseAllLatch(transaction, OperatorDelete, false);
+          root_latch_.WUnlock();
+          throw Exception{ExceptionType::OUT_OF_MEMORY, "Compact Out Of Memory"};
+        }
+        page->WLatch();
+        transaction->AddIntoPageSet(page);
+        if (page_id == target.page_id_ || TreePage(page)->IsLeafPage()) {
+          break;
+        }
+        auto internal_node = PageAsInternalPage(page);
+        page_id = target.left_most_ ? internal_node->ValueAt(0) : internal_node->Lookup(target.key_, comparator_);
+      }
+
+      auto node = TreePage(page);
+      if (page_id == target.page_id_ && page_id != root_page_id_ && NeedsMerge(node, MergePolicy::EAGER)) {
+        if (node->IsLeafPage()) {
+          CoalesceOrRedistribute(AsLeafPage(node), MergePolicy::EAGER, transaction);
+        } else {
+          CoalesceOrRedistribute(AsInternalPage(node), MergePolicy::EAGER, transaction);
+        }
+      }
+      // the root latch is not on the path, it stays with us
+      ReleaseAllLatch(transaction, OperatorDelete, false);
+      DeleteAllOnSet(transaction);
+    }
+  }
+
+  root_latch_.WUnlock();
+  ApplyPrevLinks();
+}
+
+/*****************************************************************************
+ * POSTING LIST
+ *****************************************************************************/
+/*
+ * Add value to the values of the key stored at leaf_node[index]
+ * The first duplicate moves the inline value into a new posting page. Values
+ * larger than every stored one are appended to the tail page the head
+ * remembers; any other value walks the sorted chain only up to the page it
+ * belongs to, which is split in two when it is full.
+ * @return: false if the key & value pair already exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::AppendToPostingList(LeafPage *leaf_node, int index, const ValueType &value) {
+  auto stored = leaf_node->ValueAt(index);
+
+  if (!IsPostingList(stored)) {
+    if (stored == value) {
+      return false;
+    }
+    page_id_t page_id = INVALID_PAGE_ID;
+    auto page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'AppendToPostingList' BufferPoolManager::NewPage FAIL!");
+    }
+    auto posting_node = PageAsPostingPage(page);
+    posting_node->Init(page_id);
+    posting_node->Insert(stored);
+    posting_node->Insert(value);
+    leaf_node->SetValueAt(index, MakePostingListValue(page_id));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+  }
+
+  page_id_t head_page_id = PostingListPageId(stored);
+  auto head_page = buffer_pool_manager_->FetchPage(head_page_id);
+  if (head_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'AppendToPostingList' BufferPoolManager::FetchPage FAIL!");
+  }
+  auto head_node = PageAsPostingPage(head_page);
+
+  // find the page value belongs to: the tail if value is the largest one,
+  // otherwise the first page whose last value is not smaller than value
+  page_id_t page_id = head_node->GetTailPageId();
+  Page *page = head_page;
+  if (page_id != head_page_id) {
+    page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(head_page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'AppendToPostingList' BufferPoolManager::FetchPage FAIL!");
+    }
+  }
+  auto posting_node = PageAsPostingPage(page);
+  if (!PostingValueLess(posting_node->ValueAt(posting_node->GetSize() - 1), value)) {
+    if (page_id != head_page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    page_id = head_page_id;
+    page = head_page;
+    posting_node = head_node;
+    while (PostingValueLess(posting_node->ValueAt(posting_node->GetSize() - 1), value)) {
+      auto next_page_id = posting_node->GetNextPageId();
+      if (page_id != head_page_id) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+      }
+      page_id = next_page_id;
+      page = buffer_pool_manager_->FetchPage(page_id);
+      if (page == nullptr) {
+        buffer_pool_manager_->UnpinPage(head_page_id, false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "'AppendToPostingList' BufferPoolManager::FetchPage FAIL!");
+      }
+      posting_node = PageAsPostingPage(page);
+    }
+    if (posting_node->ValueIndex(value) != -1) {
+      if (page_id != head_page_id) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+      }
+      buffer_pool_manager_->UnpinPage(head_page_id, false);
+      return false;
+    }
+  }
+
+  if (!posting_node->IsFull()) {
+    posting_node->Insert(value);
+    if (page_id != head_page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    return true;
+  }
+
+  page_id_t new_page_id = INVALID_PAGE_ID;
+  auto new_page = buffer_pool_manager_->NewPage(&new_page_id);
+  if (new_page == nullptr) {
+    if (page_id != head_page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'AppendToPostingList' BufferPoolManager::NewPage FAIL!");
+  }
+  auto new_node = PageAsPostingPage(new_page);
+  new_node->Init(new_page_id);
+  new_node->SetNextPageId(posting_node->GetNextPageId());
+  posting_node->SetNextPageId(new_page_id);
+  if (head_node->GetTailPageId() == page_id) {
+    head_node->SetTailPageId(new_page_id);
+  }
+  if (PostingValueLess(posting_node->ValueAt(posting_node->GetSize() - 1), value)) {
+    // appending to the tail, leave the full page as it is
+    new_node->Append(value);
+  } else {
+    posting_node->MoveHalfTo(new_node);
+    if (PostingValueLess(value, new_node->ValueAt(0))) {
+      posting_node->Insert(value);
+    } else {
+      new_node->Insert(value);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  if (page_id != head_page_id) {
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return true;
+}
+
+/*
+ * Remove value from the posting list referenced by leaf_node[index]
+ * Emptied pages are unlinked, and once a single value is left it moves back
+ * inline into the leaf so lookups of that key skip the posting page again.
+ * @return: false if the value is not in the posting list
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromPostingList(LeafPage *leaf_node, int index, const ValueType &value) {
+  page_id_t head_page_id = PostingListPageId(leaf_node->ValueAt(index));
+  auto head_page = buffer_pool_manager_->FetchPage(head_page_id);
+  if (head_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'RemoveFromPostingList' BufferPoolManager::FetchPage FAIL!");
+  }
+  auto head_node = PageAsPostingPage(head_page);
+
+  // the chain is sorted, stop at the first page whose last value is not smaller
+  page_id_t page_id = head_page_id;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  auto posting_node = head_node;
+  while (PostingValueLess(posting_node->ValueAt(posting_node->GetSize() - 1), value) &&
+         posting_node->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page_id = posting_node->GetNextPageId();
+    if (page_id != head_page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    prev_page_id = page_id;
+    page_id = next_page_id;
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(head_page_id, false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'RemoveFromPostingList' BufferPoolManager::FetchPage FAIL!");
+    }
+    posting_node = PageAsPostingPage(page);
+  }
+
+  auto value_index = posting_node->ValueIndex(value);
+  if (value_index == -1) {
+    if (page_id != head_page_id) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    return false;
+  }
+
+  posting_node->Remove(value_index);
+  if (page_id != head_page_id) {
+    auto next_page_id = posting_node->GetNextPageId();
+    bool emptied = posting_node->GetSize() == 0;
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    if (emptied) {
+      auto prev_node = head_node;
+      if (prev_page_id != head_page_id) {
+        auto prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+        if (prev_page == nullptr) {
+          buffer_pool_manager_->UnpinPage(head_page_id, false);
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "'RemoveFromPostingList' BufferPoolManager::FetchPage FAIL!");
+        }
+        prev_node = PageAsPostingPage(prev_page);
+      }
+      prev_node->SetNextPageId(next_page_id);
+      if (head_node->GetTailPageId() == page_id) {
+        head_node->SetTailPageId(prev_page_id);
+      }
+      if (prev_page_id != head_page_id) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      }
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+  }
+
+  auto next_page_id = head_node->GetNextPageId();
+  if (head_node->GetSize() == 0 && next_page_id != INVALID_PAGE_ID) {
+    // head page emptied while later pages still hold values, promote the next page
+    auto next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(head_page_id, true);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'RemoveFromPostingList' BufferPoolManager::FetchPage FAIL!");
+    }
+    PageAsPostingPage(next_page)->SetTailPageId(head_node->GetTailPageId());
+    buffer_pool_manager_->UnpinPage(next_page_id, true);
+    leaf_node->SetValueAt(index, MakePostingListValue(next_page_id));
+  } else if (head_node->GetSize() == 1 && next_page_id == INVALID_PAGE_ID) {
+    leaf_node->SetValueAt(index, head_node->ValueAt(0));
+  } else {
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(head_page_id, false);
+  buffer_pool_manager_->DeletePage(head_page_id);
+  return true;
+}
+
+/*
+ * Append every value of the posting list starting at page_id to result
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectPostingList(page_id_t page_id, std::vector<ValueType> *result) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'CollectPostingList' BufferPoolManager::FetchPage FAIL!");
+    }
+    auto posting_node = PageAsPostingPage(page);
+    for (int i = 0; i < posting_node->GetSize(); ++i) {
+      result->push_back(posting_node->ValueAt(i));
+    }
+    auto next_page_id = posting_node->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+/*
+ * Give every page of the posting list starting at page_id back to the buffer pool
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePostingList(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "'DeletePostingList' BufferPoolManager::FetchPage FAIL!");
+    }
+    auto next_page_id = PageAsPostingPage(page)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -534,16 +1075,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, Transaction* t) {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
-  KeyType k{};
-  root_latch_.RLock();
-  auto page = FindLeafPage(k, true, nullptr, OperatorFind);
-
-  if (page == nullptr) {
-    throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "Out Of Memory Begin()"};
-  }
-  return INDEXITERATOR_TYPE{page, buffer_pool_manager_, 0};
-}
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return ScanRange(nullptr, true, nullptr, true); }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -551,21 +1083,53 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  root_latch_.RLock();
-  auto page = FindLeafPage(key, false);
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return ScanRange(&key, true, nullptr, true); }
 
-  if (page == nullptr) {
-    throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "Out Of Memory Begin(const KeyType& key)"};
+/*
+ * Find the leaf holding the first key of the range in the scan direction,
+ * the iterator then walks the leaf chain until it passes the other bound.
+ * @return : index iterator, end() if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::ScanRange(const KeyType *low, bool low_inclusive, const KeyType *high,
+                                             bool high_inclusive, ScanDirection direction) {
+  KeyType k{};
+  if (direction == ScanDirection::FORWARD) {
+    auto page = FindLeafPageRead(low == nullptr ? k : *low, low == nullptr);
+    if (page == nullptr) {
+      return end();
+    }
+    auto leaf = PageAsLeafPage(page);
+    int idx = 0;
+    if (low != nullptr) {
+      idx = leaf->KeyIndex(*low, comparator_);
+      if (idx == -1) {
+        idx = leaf->GetSize();
+      } else if (!low_inclusive && leaf->CompareKeyAt(idx, *low, comparator_) == 0) {
+        idx++;
+      }
+    }
+    return INDEXITERATOR_TYPE{this, page, idx, direction, high, high_inclusive};
   }
 
-  auto idx =  PageAsLeafPage(page)->KeyIndex(key, comparator_);
-  if (idx == -1) {
-    page->RUnlatch();
+  auto page = FindLeafPageRead(high == nullptr ? k : *high, false, high == nullptr);
+  if (page == nullptr) {
     return end();
   }
-
-  return INDEXITERATOR_TYPE{page, buffer_pool_manager_, idx};
+  auto leaf = PageAsLeafPage(page);
+  int idx = leaf->GetSize() - 1;
+  if (high != nullptr) {
+    // last key before high, or at high when inclusive
+    idx = leaf->KeyIndex(*high, comparator_);
+    if (idx == -1) {
+      idx = leaf->GetSize();
+    }
+    if (idx < leaf->GetSize() && high_inclusive && leaf->CompareKeyAt(idx, *high, comparator_) == 0) {
+      idx++;
+    }
+    idx--;
+  }
+  return INDEXITERATOR_TYPE{this, page, idx, direction, low, low_inclusive};
 }
 
 /*
@@ -581,20 +1145,20 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page, if rightMost flag == true, find the right most one
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transaction* t, int op) {
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transaction* t, int op, bool rightMost) {
   if (IsEmpty()) {
     return nullptr;
   }
 
   Page* page = nullptr,* last_page = nullptr;
-  auto page_id = root_page_id_, last_page_id = INVALID_PAGE_ID;
+  auto page_id = root_page_id_;
 
   while (true)
   {
-    page = buffer_pool_manager_->FetchPage(page_id);
+    page = last_page == nullptr ? FetchRootPage() : buffer_pool_manager_->FetchPage(page_id);
     if (!page) {
       throw Exception{ExceptionType::OUT_OF_MEMORY, "FindLeafPage Out Of Memory"};
     }
@@ -605,12 +1169,11 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transactio
         ReleaseAllLatch(t, op, false);
         t->AddIntoPageSet(page);
       } else {
-        if (page_id == root_page_id_)
+        if (last_page == nullptr)
           root_latch_.RUnlock();
         else
         {
-          UnlatchPage(last_page, op);
-          buffer_pool_manager_->UnpinPage(last_page_id, false);
+          ReleasePage(last_page, op, false);
         }
       }
     } else {
@@ -619,7 +1182,6 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transactio
 
     // 如果 是安全的，则父节点全被锁上了
     // 否则 就只有page节点被锁上
-    last_page_id = page_id;
     last_page = page;
 
     if (TreePage(page)->IsLeafPage()) {
@@ -628,6 +1190,8 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transactio
 
     if (leftMost) {
       page_id = PageAsInternalPage(page)->ValueAt(0);
+    } else if (rightMost) {
+      page_id = PageAsInternalPage(page)->ValueAt(PageAsInternalPage(page)->GetSize() - 1);
     } else {
       page_id = PageAsInternalPage(page)->Lookup(key, comparator_);
     }
@@ -637,25 +1201,171 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, Transactio
   return page;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageRead(const KeyType &key, bool leftMost, bool rightMost) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  return FindLeafPage(key, leftMost, nullptr, OperatorFind, rightMost);
+}
+
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
- * Call this method everytime root page id is changed.
- * @parameter: insert_record      defualt value is false. When set to true,
- * insert a record <index_name, root_page_id> into header page instead of
- * updating it.
+ * Page of page_id on the path latched by the current insert or delete
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
-    // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+Page *BPLUSTREE_TYPE::PathPageOf(page_id_t page_id, Transaction *t) {
+  auto path = t->GetPageSet();
+  for (auto it = path->rbegin(); it != path->rend(); ++it) {
+    if (*it != nullptr && (*it)->GetPageId() == page_id) {
+      return *it;
+    }
+  }
+  throw Exception{ExceptionType::INVALID, "page is not on the latched path"};
+}
+
+/*
+ * Parent of a non-root page on the latched path, the page right above it.
+ * Pages do not store their parent, an operation that may split or merge a
+ * page keeps every page above it latched up to a safe one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::ParentPageOf(page_id_t page_id, Transaction *t) {
+  auto path = t->GetPageSet();
+  for (size_t i = path->size(); i-- > 1;) {
+    if ((*path)[i] != nullptr && (*path)[i]->GetPageId() == page_id) {
+      if ((*path)[i - 1] == nullptr) {
+        break;
+      }
+      return (*path)[i - 1];
+    }
+  }
+  throw Exception{ExceptionType::INVALID, "parent page is not on the latched path"};
+}
+
+/*
+ * Writers hold the latch of the left leaf and of some of its ancestors here.
+ * Latching the right leaf now could deadlock with a delete that holds that
+ * leaf and waits for one of those ancestors as its sibling, so the link is
+ * only queued. Backward iterators check the prev link before they follow it,
+ * a link that is late or lost only sends them back to the root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RelinkPrevPageId(page_id_t page_id, page_id_t old_prev_page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(prev_links_latch_);
+  prev_links_.push_back(PrevLink{page_id, old_prev_page_id, prev_page_id});
+}
+
+/*
+ * A link is only applied if nothing relinked the leaf in between. Each leaf
+ * is pinned before its link leaves the queue and DeleteAllOnSet() purges the
+ * queue first, so a leaf deleted meanwhile stays pinned and is not reused.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ApplyPrevLinks() {
+  while (true) {
+    PrevLink link{};
+    Page *page = nullptr;
+    {
+      std::lock_guard<std::mutex> guard(prev_links_latch_);
+      if (prev_links_.empty()) {
+        return;
+      }
+      link = prev_links_.front();
+      page = buffer_pool_manager_->FetchPage(link.page_id_);
+      if (page == nullptr) {
+        throw Exception{ExceptionType::OUT_OF_MEMORY, "ApplyPrevLinks Out Of Memory"};
+      }
+      prev_links_.pop_front();
+    }
+    page->WLatch();
+    auto leaf = PageAsLeafPage(page);
+    bool relinked = leaf->IsLeafPage() && leaf->GetPrevPageId() == link.old_prev_page_id_;
+    if (relinked) {
+      leaf->SetPrevPageId(link.prev_page_id_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(link.page_id_, relinked);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+/*
+ * Point root_page_ at the new root, called right after root_page_id_ changed
+ * with the old root write latched on the path of t. An internal root stays
+ * pinned so descents start without a buffer pool call.
+ * Pins change hands instead of being dropped and taken again: t releases an
+ * old cached root like any page of its path, which gives back the pin of the
+ * cache, and a new root already on the path keeps the pin t holds for it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CacheRootPage(Transaction *t) {
+  Page *root = nullptr;
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    for (auto page : *t->GetPageSet()) {
+      if (page != nullptr && page->GetPageId() == root_page_id_) {
+        root = page;
+      }
+    }
+    if (root == nullptr) {
+      root = buffer_pool_manager_->FetchPage(root_page_id_);
+      if (root == nullptr) {
+        throw Exception{ExceptionType::OUT_OF_MEMORY, "CacheRootPage Out Of Memory"};
+      }
+      if (TreePage(root)->IsLeafPage()) {
+        buffer_pool_manager_->UnpinPage(root_page_id_, false);
+      }
+    }
+    if (TreePage(root)->IsLeafPage()) {
+      root = nullptr;
+    }
+  }
+  root_page_ = root;
+}
+
+/*
+ * Record a root change, call this method everytime root page id is changed,
+ * with the root latch write locked.
+ * The header page (page_id = 0, see include/page/header_page.h) is shared by
+ * every index and searched by name, so it is not touched here; the new root
+ * page id only reaches it with FlushRootPageId() at checkpoint time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UpdateRootPageId() { root_page_id_dirty_ = true; }
+
+/*
+ * Write the root page id into the header page if it changed since the last
+ * flush. The record <index_name, root_page_id> is inserted the first time the
+ * tree has a root, a tree without record is empty.
+ * @return: false if the header page has no room for a new record
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FlushRootPageId() {
+  root_latch_.WLock();
+  if (!root_page_id_dirty_) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  auto page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    root_latch_.WUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "'FlushRootPageId' BufferPoolManager::FetchPage FAIL!");
+  }
+  // other indexes flush into the same page
+  page->WLatch();
+  auto header_page = static_cast<HeaderPage *>(page);
+  bool flushed = header_page->UpdateRecord(index_name_, root_page_id_) || root_page_id_ == INVALID_PAGE_ID ||
+                 header_page->InsertRecord(index_name_, root_page_id_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, flushed);
+
+  root_page_id_dirty_ = !flushed;
+  root_latch_.WUnlock();
+  return flushed;
 }
 
 /*
@@ -728,12 +1438,6 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
       out << leaf_prefix << leaf->GetPageId() << " -> " << leaf_prefix << leaf->GetNextPageId() << ";\n";
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId() << "};\n";
     }
-
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     InternalPage *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -759,14 +1463,11 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> " << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
-    // Print leaves
+    // Print leaves, pages don't know their parent so the links are printed from here
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      out << internal_prefix << inner->GetPageId() << ":p" << child_page->GetPageId() << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << child_page->GetPageId() << ";\n";
       ToGraph(child_page, bpm, out);
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
@@ -793,8 +1494,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
-    std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+    std::cout << "Leaf Page: " << leaf->GetPageId() << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -802,7 +1502,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
   } else {
     InternalPage *internal = reinterpret_cast<InternalPage *>(page);
-    std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
+    std::cout << "Internal Page: " << internal->GetPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
     }
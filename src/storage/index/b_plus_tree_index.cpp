@@ -11,7 +11,105 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include "common/logger.h"
+
 namespace bustub {
+
+namespace {
+
+/** RIDs a range cursor reads from the tree per refill */
+constexpr size_t RANGE_CURSOR_BATCH_SIZE = 128;
+
+/*
+ * Reads the range a batch at a time. The tree iterator is only open while a
+ * batch is filled, so no leaf stays latched between calls and the caller may
+ * delete the entries it was handed. A refill seeks back to the last key
+ * returned and skips the values of that key it has already handed out;
+ * values of one key come back in posting list order, which is sorted.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class BPlusTreeRangeCursor : public IndexRangeCursor {
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+
+ public:
+  BPlusTreeRangeCursor(Tree *tree, const KeyComparator &comparator, const KeyType *low, bool low_inclusive,
+                       const KeyType *high, bool high_inclusive, ScanDirection direction)
+      : tree_(tree),
+        comparator_(comparator),
+        has_low_(low != nullptr),
+        low_(low != nullptr ? *low : KeyType{}),
+        low_inclusive_(low_inclusive),
+        has_high_(high != nullptr),
+        high_(high != nullptr ? *high : KeyType{}),
+        high_inclusive_(high_inclusive),
+        direction_(direction) {}
+
+  bool Next(RID *rid) override {
+    if (cursor_ >= batch_.size()) {
+      Refill();
+      if (batch_.empty()) {
+        return false;
+      }
+    }
+    *rid = batch_[cursor_++];
+    return true;
+  }
+
+ private:
+  void Refill() {
+    batch_.clear();
+    cursor_ = 0;
+    if (done_) {
+      return;
+    }
+
+    const KeyType *low = has_low_ ? &low_ : nullptr;
+    bool low_inclusive = low_inclusive_;
+    const KeyType *high = has_high_ ? &high_ : nullptr;
+    bool high_inclusive = high_inclusive_;
+    if (has_last_ && direction_ == ScanDirection::FORWARD) {
+      low = &last_key_;
+      low_inclusive = true;
+    } else if (has_last_) {
+      high = &last_key_;
+      high_inclusive = true;
+    }
+
+    auto iter = tree_->ScanRange(low, low_inclusive, high, high_inclusive, direction_);
+    for (; !iter.isEnd() && batch_.size() < RANGE_CURSOR_BATCH_SIZE; ++iter) {
+      const auto &item = *iter;
+      if (has_last_ && comparator_(item.first, last_key_) == 0 && !PostingValueLess(last_value_, item.second)) {
+        continue;
+      }
+      batch_.push_back(item.second);
+      last_key_ = item.first;
+      last_value_ = item.second;
+      has_last_ = true;
+    }
+    done_ = iter.isEnd();
+  }
+
+  Tree *tree_;
+  KeyComparator comparator_;
+  bool has_low_;
+  KeyType low_;
+  bool low_inclusive_;
+  bool has_high_;
+  KeyType high_;
+  bool high_inclusive_;
+  ScanDirection direction_;
+
+  std::vector<RID> batch_;
+  size_t cursor_{0};
+  bool done_{false};
+  // last entry handed out, the next refill resumes from it
+  bool has_last_{false};
+  KeyType last_key_;
+  ValueType last_value_;
+};
+
+}  // namespace
+
 /*
  * Constructor
  */
@@ -19,7 +117,8 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 metadata->IsUnique()) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -36,7 +135,7 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -48,12 +147,88 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                   Transaction *transaction) {
+  // construct scan index keys
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i]);
+  }
+
+  container_.GetValues(index_keys, results);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                    bool high_inclusive, ScanDirection direction, std::vector<RID> *result,
+                                    Transaction *transaction) {
+  // construct the bounds of the scan
+  KeyType low;
+  KeyType high;
+  if (low_key != nullptr) {
+    low.SetFromKey(*low_key);
+  }
+  if (high_key != nullptr) {
+    high.SetFromKey(*high_key);
+  }
+
+  for (auto iter = container_.ScanRange(low_key != nullptr ? &low : nullptr, low_inclusive,
+                                        high_key != nullptr ? &high : nullptr, high_inclusive, direction);
+       !iter.isEnd(); ++iter) {
+    result->push_back((*iter).second);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::unique_ptr<IndexRangeCursor> BPLUSTREE_INDEX_TYPE::OpenRange(const Tuple *low_key, bool low_inclusive,
+                                                                  const Tuple *high_key, bool high_inclusive,
+                                                                  ScanDirection direction, Transaction *transaction) {
+  KeyType low;
+  KeyType high;
+  if (low_key != nullptr) {
+    low.SetFromKey(*low_key);
+  }
+  if (high_key != nullptr) {
+    high.SetFromKey(*high_key);
+  }
+  return std::make_unique<BPlusTreeRangeCursor<KeyType, ValueType, KeyComparator>>(
+      &container_, comparator_, low_key != nullptr ? &low : nullptr, low_inclusive,
+      high_key != nullptr ? &high : nullptr, high_inclusive, direction);
+}
+
+/*
+ * Root changes since the last checkpoint would be lost with the index, the
+ * header page may have no room left for them, which only a checkpoint reports
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_INDEX_TYPE::~BPlusTreeIndex() {
+  try {
+    container_.FlushRootPageId();
+  } catch (Exception &e) {
+    LOG_WARN("root page id of %s not flushed: %s", GetName().c_str(), e.what());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::Checkpoint() {
+  if (!container_.FlushRootPageId()) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "header page has no room for the root of " + GetName());
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const KeyType *low, bool low_inclusive, const KeyType *high,
+                                                          bool high_inclusive, ScanDirection direction) {
+  return container_.ScanRange(low, low_inclusive, high, high_inclusive, direction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
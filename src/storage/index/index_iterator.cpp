@@ -3,7 +3,7 @@
  */
 #include <cassert>
 
-#include "storage/index/index_iterator.h"
+#include "storage/index/b_plus_tree.h"
 
 namespace bustub {
 
@@ -12,22 +12,285 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() : buffer_pool_(nullptr), page_(nullptr), index_at_page_(-1), page_id_(INVALID_PAGE_ID) {
-}
+INDEXITERATOR_TYPE::IndexIterator()
+    : tree_(nullptr),
+      buffer_pool_(nullptr),
+      page_(nullptr),
+      index_at_page_(-1),
+      page_id_(INVALID_PAGE_ID),
+      posting_page_(nullptr),
+      posting_index_(-1),
+      direction_(ScanDirection::FORWARD),
+      has_bound_(false),
+      bound_{},
+      bound_inclusive_(true),
+      read_ahead_page_id_(INVALID_PAGE_ID) {}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(Page *p, BufferPoolManager *bpm, int idx)
-    : buffer_pool_(bpm), page_(p), index_at_page_(idx), page_id_(p->GetPageId()) {
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, Page *p, int idx, ScanDirection direction, const KeyType *bound,
+                                  bool bound_inclusive)
+    : tree_(tree),
+      buffer_pool_(tree->buffer_pool_manager_),
+      page_(p),
+      index_at_page_(idx),
+      page_id_(p->GetPageId()),
+      posting_page_(nullptr),
+      posting_index_(-1),
+      direction_(direction),
+      has_bound_(bound != nullptr),
+      bound_(bound != nullptr ? *bound : KeyType{}),
+      bound_inclusive_(bound_inclusive),
+      read_ahead_page_id_(INVALID_PAGE_ID) {
   LOG_DEBUG("Latch node {%d} read", page_->GetPageId());
+  Settle();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      buffer_pool_(other.buffer_pool_),
+      page_(other.page_),
+      index_at_page_(other.index_at_page_),
+      page_id_(other.page_id_),
+      posting_page_(other.posting_page_),
+      posting_index_(other.posting_index_),
+      direction_(other.direction_),
+      has_bound_(other.has_bound_),
+      bound_(other.bound_),
+      bound_inclusive_(other.bound_inclusive_),
+      read_ahead_page_id_(other.read_ahead_page_id_) {
+  other.page_ = nullptr;
+  other.page_id_ = INVALID_PAGE_ID;
+  other.posting_page_ = nullptr;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    tree_ = other.tree_;
+    buffer_pool_ = other.buffer_pool_;
+    page_ = other.page_;
+    index_at_page_ = other.index_at_page_;
+    page_id_ = other.page_id_;
+    posting_page_ = other.posting_page_;
+    posting_index_ = other.posting_index_;
+    direction_ = other.direction_;
+    has_bound_ = other.has_bound_;
+    bound_ = other.bound_;
+    bound_inclusive_ = other.bound_inclusive_;
+    read_ahead_page_id_ = other.read_ahead_page_id_;
+    other.page_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.posting_page_ = nullptr;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (posting_page_) {
+    buffer_pool_->UnpinPage(posting_page_->GetPageId(), false);
+    posting_page_ = nullptr;
+  }
   if (page_) {
     LOG_DEBUG("UnLatch node {%d} read", page_->GetPageId());
     page_->RUnlatch();
     buffer_pool_->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetEnd() {
+  Release();
+  page_id_ = INVALID_PAGE_ID;
+  index_at_page_ = -1;
+  posting_index_ = -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::InBound(const KeyType &key) const {
+  if (!has_bound_) {
+    return true;
+  }
+  int cmp = tree_->comparator_(key, bound_);
+  if (direction_ == ScanDirection::BACKWARD) {
+    cmp = -cmp;
+  }
+  return cmp < 0 || (cmp == 0 && bound_inclusive_);
+}
+
+/*
+ * An index past the end of the leaf moves to the next leaf, unless the last
+ * key of this leaf is already out of the range. Same for a backward scan
+ * with an index before the first key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Settle() {
+  while (!isEnd()) {
+    auto leaf = Leaf();
+    int size = leaf->GetSize();
+    if (direction_ == ScanDirection::FORWARD && index_at_page_ >= size) {
+      if (size > 0 && !InBound(leaf->KeyAt(size - 1))) {
+        SetEnd();
+        return;
+      }
+      NextLeaf();
+      continue;
+    }
+    if (direction_ == ScanDirection::BACKWARD && index_at_page_ < 0) {
+      if (size > 0 && !InBound(leaf->KeyAt(0))) {
+        SetEnd();
+        return;
+      }
+      PrevLeaf();
+      continue;
+    }
+    if (!InBound(leaf->KeyAt(index_at_page_))) {
+      SetEnd();
+      return;
+    }
+    if (read_ahead_page_id_ != page_id_) {
+      read_ahead_page_id_ = page_id_;
+      ReadAhead();
+    }
+    EnterEntry();
+    return;
+  }
+}
+
+/*
+ * Writers latch leaves from left to right only, so the next leaf is latched
+ * before the current one is released.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::NextLeaf() {
+  auto next_page_id = Leaf()->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    SetEnd();
+    return;
+  }
+  auto page = buffer_pool_->FetchPage(next_page_id);
+  if (page == nullptr) {
+    throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "IndexIterator operator++ Out Of Memory"};
+  }
+  page->RLatch();
+  LOG_DEBUG("Latch node {%d} read", page->GetPageId());
+  Release();
+  page_ = page;
+  page_id_ = next_page_id;
+  index_at_page_ = 0;
+}
+
+/*
+ * Latching to the left while holding a leaf could deadlock with writers, so
+ * the current leaf is released first and the previous one is checked to still
+ * link to it. If a split or merge got in between, the leaf holding the last
+ * key before the old first key is searched from the root again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrevLeaf() {
+  auto leaf = Leaf();
+  if (leaf->GetSize() == 0) {
+    SetEnd();
+    return;
+  }
+  KeyType first_key = leaf->KeyAt(0);
+  while (true) {
+    auto prev_page_id = Leaf()->GetPrevPageId();
+    auto old_page_id = page_id_;
+    if (prev_page_id == INVALID_PAGE_ID) {
+      SetEnd();
+      return;
+    }
+    Release();
+    auto page = buffer_pool_->FetchPage(prev_page_id);
+    if (page == nullptr) {
+      page_id_ = INVALID_PAGE_ID;
+      throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "IndexIterator operator++ Out Of Memory"};
+    }
+    page->RLatch();
+    auto prev_leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (prev_leaf->IsLeafPage() && prev_leaf->GetNextPageId() == old_page_id && prev_leaf->GetSize() > 0) {
+      page_ = page;
+      page_id_ = prev_page_id;
+      index_at_page_ = prev_leaf->GetSize() - 1;
+      return;
+    }
+    page->RUnlatch();
+    buffer_pool_->UnpinPage(prev_page_id, false);
+
+    page = tree_->FindLeafPageRead(first_key);
+    if (page == nullptr) {
+      SetEnd();
+      return;
+    }
+    page_ = page;
+    page_id_ = page->GetPageId();
+    int idx = Leaf()->KeyIndex(first_key, tree_->comparator_);
+    index_at_page_ = (idx == -1 ? Leaf()->GetSize() : idx) - 1;
+    if (index_at_page_ >= 0) {
+      return;
+    }
+    if (Leaf()->GetSize() == 0) {
+      SetEnd();
+      return;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  auto leaf = Leaf();
+  int size = leaf->GetSize();
+  if (direction_ == ScanDirection::FORWARD) {
+    if (!InBound(leaf->KeyAt(size - 1))) {
+      return;
+    }
+    buffer_pool_->PrefetchPage(leaf->GetNextPageId(), INDEX_READ_AHEAD, NextLeafPageId);
+  } else {
+    if (!InBound(leaf->KeyAt(0))) {
+      return;
+    }
+    buffer_pool_->PrefetchPage(leaf->GetPrevPageId(), INDEX_READ_AHEAD, PrevLeafPageId);
+  }
+}
+
+/*
+ * Run by the read ahead thread on a page it has just read, the page may have
+ * been reused for something else than a leaf since the link was followed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t INDEXITERATOR_TYPE::NextLeafPageId(const char *page_data) {
+  auto leaf = reinterpret_cast<const LeafPage *>(page_data);
+  return leaf->IsLeafPage() ? leaf->GetNextPageId() : INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t INDEXITERATOR_TYPE::PrevLeafPageId(const char *page_data) {
+  auto leaf = reinterpret_cast<const LeafPage *>(page_data);
+  return leaf->IsLeafPage() ? leaf->GetPrevPageId() : INVALID_PAGE_ID;
+}
+
+/*
+ * A leaf entry of a duplicated key refers to a posting list, the iterator
+ * then yields every value of the list before moving to the next key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterEntry() {
+  auto leaf = Leaf();
+  if (index_at_page_ < 0 || index_at_page_ >= leaf->GetSize() || !IsPostingList(leaf->ValueAt(index_at_page_))) {
+    return;
+  }
+  posting_page_ = buffer_pool_->FetchPage(PostingListPageId(leaf->ValueAt(index_at_page_)));
+  if (posting_page_ == nullptr) {
+    throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "IndexIterator Out Of Memory at fetching posting page"};
   }
+  posting_index_ = 0;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -39,7 +302,15 @@ const MappingType &INDEXITERATOR_TYPE::operator*() {
     throw bustub::Exception{ExceptionType::OUT_OF_RANGE, "IndexIterator operator* page_ is nullptr"};
   }
 
-  return reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetItem(index_at_page_);
+  // keys are packed in the leaf, so the pair is always rebuilt into item_
+  auto leaf = Leaf();
+  if (posting_page_ == nullptr) {
+    item_ = leaf->GetItem(index_at_page_);
+    return item_;
+  }
+  auto posting = reinterpret_cast<BPlusTreePostingPage<ValueType> *>(posting_page_->GetData());
+  item_ = MappingType{leaf->KeyAt(index_at_page_), posting->ValueAt(posting_index_)};
+  return item_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -48,39 +319,30 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     return *this;
   }
 
-  LOG_DEBUG("InteratorIndex operator++ index_at_page {%d} tree_page {%d} , page_size {%d} next_page_id {%d}", 
-        this->index_at_page_, page_->GetPageId(), reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetSize(), 
-        reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetNextPageId());
-
-  if (index_at_page_ >= reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetSize()  - 1) {
-    page_->RUnlatch();
-    LOG_DEBUG("UnLatch node {%d} read", page_->GetPageId());
-    if (reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetNextPageId() == INVALID_PAGE_ID) {
-      page_id_t old_page_id = page_id_;
-      page_ = nullptr;
-      page_id_ = INVALID_PAGE_ID;
-      index_at_page_ = -1;
-      buffer_pool_->UnpinPage(old_page_id, false);
-    } else {
-      auto next_page_id = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_)->GetNextPageId();
-
-      buffer_pool_->UnpinPage(page_->GetPageId(), false);
-      auto page = buffer_pool_->FetchPage(next_page_id);
-      if (page == nullptr) {
+  if (posting_page_ != nullptr) {
+    auto posting = reinterpret_cast<BPlusTreePostingPage<ValueType> *>(posting_page_->GetData());
+    if (++posting_index_ < posting->GetSize()) {
+      return *this;
+    }
+    auto next_posting_page_id = posting->GetNextPageId();
+    buffer_pool_->UnpinPage(posting_page_->GetPageId(), false);
+    posting_page_ = nullptr;
+    posting_index_ = -1;
+    if (next_posting_page_id != INVALID_PAGE_ID) {
+      posting_page_ = buffer_pool_->FetchPage(next_posting_page_id);
+      if (posting_page_ == nullptr) {
         throw bustub::Exception{ExceptionType::OUT_OF_MEMORY, "IndexIterator operator++ Out Of Memory"};
       }
-      page_ = page;
-      page_id_ = page_->GetPageId();
-      index_at_page_ = 0;
-
-      page_->RLatch();
-      LOG_DEBUG("Latch node {%d} read", page_->GetPageId());
+      posting_index_ = 0;
+      return *this;
     }
-  } else {
-    index_at_page_++;
   }
-  
-  
+
+  LOG_DEBUG("InteratorIndex operator++ index_at_page {%d} tree_page {%d} , page_size {%d}", this->index_at_page_,
+            page_->GetPageId(), Leaf()->GetSize());
+
+  index_at_page_ += direction_ == ScanDirection::FORWARD ? 1 : -1;
+  Settle();
 
   return *this;
 }
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_link_tree_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "storage/page/b_link_tree_page.h"
+
+namespace bustub {
+
+/*
+ * Init method after creating a new node, the node has no right sibling
+ */
+template <typename KeyType, typename ValueType>
+void B_LINK_TREE_PAGE_TYPE::Init(page_id_t page_id, int level, int max_size) {
+  lsn_ = INVALID_LSN;
+  size_ = 0;
+  max_size_ = max_size;
+  page_id_ = page_id;
+  level_ = level;
+  right_page_id_ = INVALID_PAGE_ID;
+}
+
+template <typename KeyType, typename ValueType>
+page_id_t B_LINK_TREE_PAGE_TYPE::GetPageId() const { return page_id_; }
+
+template <typename KeyType, typename ValueType>
+int B_LINK_TREE_PAGE_TYPE::GetLevel() const { return level_; }
+
+template <typename KeyType, typename ValueType>
+bool B_LINK_TREE_PAGE_TYPE::IsLeafPage() const { return level_ == 0; }
+
+template <typename KeyType, typename ValueType>
+int B_LINK_TREE_PAGE_TYPE::GetSize() const { return size_; }
+
+template <typename KeyType, typename ValueType>
+int B_LINK_TREE_PAGE_TYPE::GetMaxSize() const { return max_size_; }
+
+template <typename KeyType, typename ValueType>
+bool B_LINK_TREE_PAGE_TYPE::IsFull() const { return size_ >= max_size_; }
+
+template <typename KeyType, typename ValueType>
+page_id_t B_LINK_TREE_PAGE_TYPE::GetRightPageId() const { return right_page_id_; }
+
+template <typename KeyType, typename ValueType>
+bool B_LINK_TREE_PAGE_TYPE::HasHighKey() const { return right_page_id_ != INVALID_PAGE_ID; }
+
+template <typename KeyType, typename ValueType>
+const typename B_LINK_TREE_PAGE_TYPE::Entry &B_LINK_TREE_PAGE_TYPE::HighKey() const { return high_key_; }
+
+template <typename KeyType, typename ValueType>
+const typename B_LINK_TREE_PAGE_TYPE::Entry &B_LINK_TREE_PAGE_TYPE::EntryAt(int index) const { return array_[index]; }
+
+/*
+ * Insert entry at index, caller checks IsFull() first
+ */
+template <typename KeyType, typename ValueType>
+void B_LINK_TREE_PAGE_TYPE::InsertAt(int index, const Entry &entry) {
+  memmove(static_cast<void *>(array_ + index + 1), static_cast<void *>(array_ + index),
+          (size_ - index) * sizeof(Entry));
+  array_[index] = entry;
+  size_++;
+}
+
+template <typename KeyType, typename ValueType>
+void B_LINK_TREE_PAGE_TYPE::RemoveAt(int index) {
+  memmove(static_cast<void *>(array_ + index), static_cast<void *>(array_ + index + 1),
+          (size_ - index - 1) * sizeof(Entry));
+  size_--;
+}
+
+/*
+ * The recipient takes over the high key and right link of this node, and this
+ * node links to the recipient. Nobody can reach the recipient before the
+ * latch of this node is released.
+ */
+template <typename KeyType, typename ValueType>
+void B_LINK_TREE_PAGE_TYPE::MoveHalfTo(BLinkTreePage *recipient) {
+  int mid = size_ / 2;
+  memcpy(static_cast<void *>(recipient->array_), static_cast<void *>(array_ + mid), (size_ - mid) * sizeof(Entry));
+  recipient->size_ = size_ - mid;
+  recipient->high_key_ = high_key_;
+  recipient->right_page_id_ = right_page_id_;
+
+  size_ = mid;
+  high_key_ = recipient->array_[0];
+  right_page_id_ = recipient->page_id_;
+}
+
+template class BLinkTreePage<GenericKey<4>, RID>;
+template class BLinkTreePage<GenericKey<8>, RID>;
+template class BLinkTreePage<GenericKey<16>, RID>;
+template class BLinkTreePage<GenericKey<32>, RID>;
+template class BLinkTreePage<GenericKey<64>, RID>;
+
+}  // namespace bustub
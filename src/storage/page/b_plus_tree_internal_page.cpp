@@ -10,6 +10,7 @@ Internal Page does not store any real data,
  * */
 
 // Values save the page id , and keys save the key to comparator!Ant the first pair's key is empty.
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -22,33 +23,38 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id and set max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
   SetPageId(page_id);
-  SetParentPageId(parent_id);
-  SetMaxSize(max_size);
+  // a larger max size could split into halves that don't fit uncompressed
+  SetMaxSize(std::min<int>(max_size, INTERNAL_PAGE_SIZE));
 
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetSize(0);
+  SetKeyPrefixSize(0);
+  SetKeyWidth(0);
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
+ * Caller of SetKeyAt checks CanSetKeyAt() first, a key that shares less with
+ * its neighbours may need more bytes than the page has left.
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key =  array[index].first;
-  return key;
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const { return Codec().KeyAt(index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (!Codec().SetKeyAt(index, key)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "'SetKeyAt' internal page has no room for key");
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key)
-{
-  array[index].first = key;
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKeyAt(int index, const KeyType &key) const {
+  return Codec().CanSetKeyAt(index, key);
 }
 
 /*
@@ -58,9 +64,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key)
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  auto codec = Codec();
   for (int i = 0; i < GetSize(); ++i)
   {
-    if (array[i].second == value)
+    if (codec.ValueAt(i) == value)
     {
       return i;
     }
@@ -74,9 +81,58 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
-  ValueType value = array[index].second;
-  return value;
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return Codec().ValueAt(index); }
+
+/*
+ * Whether key can be inserted without splitting for lack of bytes, inserting
+ * may still reach max size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key) const { return Codec().CanInsert(key); }
+
+/*
+ * Whether any insertion is known not to split this page, even one that forces
+ * the keys to be stored uncompressed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToInsert() const {
+  return GetSize() < GetMaxSize() - 1 && (GetSize() + 1) * KeyCodec::FULL_SLOT_SIZE <= INTERNAL_PAGE_CAPACITY;
+}
+
+/*
+ * Whether removing one pair is known not to leave this page underflowed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSafeToRemove() const {
+  auto codec = Codec();
+  return GetSize() > GetMinSize() + 1 || (codec.UsedBytes() - codec.SlotSize()) * 2 >= INTERNAL_PAGE_CAPACITY;
+}
+
+/*
+ * A page is underflowed once it is below min size and less than half of its
+ * bytes are used
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() < GetMinSize() && Codec().UsedBytes() * 2 < INTERNAL_PAGE_CAPACITY;
+}
+
+/*
+ * Whether every pair of sibling, with middle_key pulled down from the parent,
+ * fits into this page as well
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMergeFrom(const BPlusTreeInternalPage *sibling,
+                                                  const KeyType &middle_key) const {
+  if (GetSize() + sibling->GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  auto codec = Codec();
+  auto items = codec.Items(0, GetSize());
+  auto sibling_items = sibling->Codec().Items(0, sibling->GetSize());
+  sibling_items[0].first = middle_key;
+  items.insert(items.end(), sibling_items.begin(), sibling_items.end());
+  return codec.Fits(items);
 }
 
 /*****************************************************************************
@@ -87,18 +143,11 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  * that contains input "key"
  * Start the search from the second key(the first key should always be invalid)
  */
-
-// [v][k][v]
-// FIXME  use binary search
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  for (int i = 1; i < GetSize(); ++i)
-  {
-    if (comparator(array[i].first, key) > 0) {
-      return array[i - 1].second;
-    }
-  }
-  return array[GetSize() - 1].second;
+  auto codec = Codec();
+  // the last index whose key <= key
+  return codec.ValueAt(codec.UpperBound(1, key, comparator) - 1);
 }
 
 /*****************************************************************************
@@ -113,34 +162,26 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 // Become a root
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) {
-  array[0].second = old_value;
-  array[1].first = new_key;
-  array[1].second = new_value;
-  SetSize(2);
+  // the invalid first key copies new_key so it packs for free
+  Codec().Assign({MappingType{new_key, old_value}, MappingType{new_key, new_value}});
 }
 
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
+ * Caller checks HasRoomFor() first.
  * @return:  new size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-  // 1 2 3 4(index) 5 []
-  // 1 2 3 4 4(new kv) 5
   auto index = ValueIndex(old_value);
 
   assert(index != -1 && "'InsertNodeAfter'");
 
-  for (auto i = GetSize(); i > index + 1; --i)
-  {
-    array[i] = array[i-1];
+  if (!Codec().Insert(index + 1, new_key, new_value)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "'InsertNodeAfter' internal page has no room for key");
   }
-
-  array[index + 1].first = new_key;
-  array[index + 1].second = new_value;
-  IncreaseSize(1);
   return GetSize();
 }
 
@@ -149,43 +190,26 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * Both halves are packed again, so each gets the prefix of its own keys.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) {
+  auto codec = Codec();
   auto start = GetMinSize();
-  auto number = GetSize() - start;
-  recipient->CopyNFrom(array + start, number, buffer_pool_manager);
-  IncreaseSize(-number);
+  recipient->CopyNFrom(codec.Items(start, GetSize()));
+  codec.Assign(codec.Items(0, start));
 }
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
- * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
+/* Copy items after my own entries.
+ * Children do not point back at their parent, so moving them only dirties
+ * this page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  auto start = array + GetSize();
-  for (auto i = 0; i < size; ++i)
-  {
-    *(start + i) = *(items + i);
-  }
-
-  IncreaseSize(size);
-
-  for (auto i = 0 ; i < size; ++i)
-  {
-    auto page_id =  start[i].second;
-    auto page = buffer_pool_manager->FetchPage(page_id, nullptr);
-
-    if (page == nullptr) {
-      throw std::runtime_error{"BufferPoolManager out of memory"};
-    }
-
-    auto node = reinterpret_cast<BPlusTreePage*>(page->GetData());
-    node->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(page_id, true);
-  }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(const std::vector<MappingType> &items) {
+  auto codec = Codec();
+  auto all = codec.Items(0, GetSize());
+  all.insert(all.end(), items.begin(), items.end());
+  codec.Assign(all);
 }
 
 /*****************************************************************************
@@ -197,13 +221,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  for (auto i = index; i < GetSize() - 1 ; ++i)
-  {
-    array[i] = array[i + 1];
-  }
-  IncreaseSize(-1);
-}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) { Codec().Remove(index); }
 
 /*
  * Remove the only key & value pair in internal page and return the value
@@ -211,8 +229,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  auto child = ValueAt(0);
   SetSize(0);
-  return array[0].second;
+  return child;
 }
 /*****************************************************************************
  * MERGE
@@ -221,15 +240,14 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
  * Remove all of key & value pairs from this page to "recipient" page.
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * Caller checks recipient->CanMergeFrom(this, middle_key) first.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {
-  SetKeyAt(0, middle_key);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
   // middle_key add to recipient's kv : [old][mid][copy]
-  recipient->CopyNFrom(array, GetSize(), buffer_pool_manager);
+  auto items = Codec().Items(0, GetSize());
+  items[0].first = middle_key;
+  recipient->CopyNFrom(items);
   SetSize(0);
 }
 /*****************************************************************************
@@ -240,73 +258,37 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  *
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * @return false if recipient has no room for the pair, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {
-  SetKeyAt(0, middle_key);
-  recipient->CopyLastFrom(array[0], buffer_pool_manager);
-  Remove(0);
-}
-
-/* Append an entry at the end.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  array[GetSize()] = pair;
-  IncreaseSize(1);
-  auto page_id = array[GetSize() - 1].second;
-  auto page = buffer_pool_manager->FetchPage(page_id);
-  if (page == nullptr) {
-    throw std::runtime_error{"BufferPoolManager out of memory"};
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  auto child = ValueAt(0);
+  if (!recipient->Codec().Insert(recipient->GetSize(), middle_key, child)) {
+    return false;
   }
-  auto node = reinterpret_cast<BPlusTreePage*>(page->GetData());
-  node->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page_id, true);
+  Remove(0);
+  return true;
 }
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
- * You need to handle the original dummy key properly, e.g. updating recipient’s array to position the middle_key at the
- * right place.
- * You also need to use BufferPoolManager to persist changes to the parent page id for those pages that are
- * moved to the recipient
+ * The middle_key becomes the key of recipient's old first child, the moved key
+ * takes the invalid first slot.
+ * @return false if recipient has no room for the pair, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {
-    SetKeyAt(0, middle_key);
-    recipient->CopyFirstFrom(array[GetSize() - 1], buffer_pool_manager);
-    IncreaseSize(-1);
-}
-
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  for (auto i = GetSize() ; i > 0; --i )
-  {
-    array[i] = array[i-1];
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  auto codec = recipient->Codec();
+  auto items = codec.Items(0, recipient->GetSize());
+  items[0].first = middle_key;
+  auto last = GetSize() - 1;
+  items.insert(items.begin(), MappingType{KeyAt(last), ValueAt(last)});
+  if (!codec.Fits(items)) {
+    return false;
   }
-  array[0] = pair;
-  IncreaseSize(1);
-
-  auto page_id = pair.second;
-  auto page = buffer_pool_manager->FetchPage(page_id);
-
-  if (page == nullptr) {
-    throw std::runtime_error{"BufferPoolManager out of memory"};
-  }
-
-  auto node = reinterpret_cast<BPlusTreePage*>(page->GetData());
-  node->SetParentPageId(GetPageId());
-  buffer_pool_manager->UnpinPage(page_id, true);
+  codec.Assign(items);
+  Remove(last);
+  return true;
 }
 
 // valuetype for internalNode should be page id_t
@@ -9,6 +9,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
@@ -23,16 +24,19 @@ namespace bustub {
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * Including set page type, set current size to zero, set page id, set next/prev
+ * page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
     SetSize(0);
     SetPageId(page_id);
-    SetMaxSize(max_size);
-    SetParentPageId(parent_id);
-    SetSize(0);
+    // a larger max size could split into halves that don't fit uncompressed
+    SetMaxSize(std::min<int>(max_size, LEAF_PAGE_SIZE));
+    SetKeyPrefixSize(0);
+    SetKeyWidth(0);
+    SetNextPageId(INVALID_PAGE_ID);
+    SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /**
@@ -45,20 +49,30 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 /**
- * Helper method to find the first index i so that array[i].first >= key
- * NOTE: This method is only used when generating index iterator
+ * Helper methods to set/get prev page id
  */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+/**
+ * Helper method to find the first index i so that array[i].first >= key
+ * If return -1, every key of the page is smaller than key.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  for (auto i = 0; i < GetSize(); ++i)
-  {
-    if (comparator(array[i].first, key) >= 0)
-    {
-      return i;
-    }
-  }
-  return -1;
+  int index = Codec().LowerBound(0, key, comparator);
+  return index == GetSize() ? -1 : index;
+}
+
+/*
+ * comparator(KeyAt(index), key), compared against the packed bytes
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::CompareKeyAt(int index, const KeyType &key, const KeyComparator &comparator) const {
+  return Codec().CompareAt(index, key, comparator);
 }
 
 /*
@@ -66,31 +80,82 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  return array[index].first;
-}
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return Codec().KeyAt(index); }
+
+/*
+ * Helper methods to get/set the value associated with input "index"(a.k.a
+ * array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const { return Codec().ValueAt(index); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { Codec().SetValueAt(index, value); }
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  return array[index];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
+  auto codec = Codec();
+  return MappingType{codec.KeyAt(index), codec.ValueAt(index)};
+}
+
+/*
+ * Whether key can be inserted without splitting for lack of bytes, inserting
+ * may still reach max size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key) const { return Codec().CanInsert(key); }
+
+/*
+ * Whether any insertion is known not to split this page, even one that forces
+ * the keys to be stored uncompressed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToInsert() const {
+  return GetSize() < GetMaxSize() - 1 && (GetSize() + 1) * KeyCodec::FULL_SLOT_SIZE <= LEAF_PAGE_CAPACITY;
+}
+
+/*
+ * Whether removing one pair is known not to leave this page underflowed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSafeToRemove() const {
+  auto codec = Codec();
+  return GetSize() > GetMinSize() + 1 || (codec.UsedBytes() - codec.SlotSize()) * 2 >= LEAF_PAGE_CAPACITY;
+}
+
+/*
+ * A page is underflowed once it is below min size and less than half of its
+ * bytes are used, a page of long keys may never reach min size
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsUnderflow() const {
+  return GetSize() < GetMinSize() && Codec().UsedBytes() * 2 < LEAF_PAGE_CAPACITY;
+}
+
+/*
+ * Whether every pair of sibling fits into this page as well
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMergeFrom(const BPlusTreeLeafPage *sibling) const {
+  if (GetSize() + sibling->GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  auto codec = Codec();
+  auto items = codec.Items(0, GetSize());
+  auto sibling_items = sibling->Codec().Items(0, sibling->GetSize());
+  items.insert(items.end(), sibling_items.begin(), sibling_items.end());
+  return codec.Fits(items);
 }
 
 /**
  * Remove index key
  * */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(int index) {
-  int size = GetSize();
-  for (int i = index; i < size - 1; ++i){
-    array[i] = array[i + 1];
-  }
-  IncreaseSize(-1);
-}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(int index) { Codec().Remove(index); }
 
 
 /*****************************************************************************
@@ -98,30 +163,20 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(int index) {
  *****************************************************************************/
 /*
  * Insert key & value pair into leaf page ordered by key
+ * Caller checks HasRoomFor() first.
  * @return  page size after insertion
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  int target_index = -1;
-  target_index = KeyIndex(key, comparator);
-
-  if (target_index == -1)
-  {
-    array[GetSize()] = std::pair<KeyType, ValueType>{key, value};
+  int target_index = KeyIndex(key, comparator);
+  if (target_index == -1) {
+    target_index = GetSize();
   }
 
-  if (target_index != -1)
-  {
-    for (int i = GetSize(); i >= target_index ; --i)
-    {
-      array[i] = array[i-1];
-    }
-
-    array[target_index] = std::pair<KeyType, ValueType> {key, value};
+  if (!Codec().Insert(target_index, key, value)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "'Insert' leaf page has no room for key");
   }
 
-  IncreaseSize(1);
-
   return GetSize();
 }
 
@@ -130,26 +185,25 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * Both halves are packed again, so each gets the prefix of its own keys.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  auto codec = Codec();
   int mid_index = GetSize() / 2;
-  int count = GetSize() - mid_index;
-  recipient->CopyNFrom(array + mid_index, count);
-  IncreaseSize(-count);
+  recipient->CopyNFrom(codec.Items(mid_index, GetSize()));
+  codec.Assign(codec.Items(0, mid_index));
 }
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Copy items after my own pairs.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-  int start = GetSize();
-  for (int i = 0; i < size; ++i) {
-    array[start + i] = items[i];
-  }
-
-  IncreaseSize(size);
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(const std::vector<MappingType> &items) {
+  auto codec = Codec();
+  auto all = codec.Items(0, GetSize());
+  all.insert(all.end(), items.begin(), items.end());
+  codec.Assign(all);
 }
 
 /*****************************************************************************
@@ -164,11 +218,11 @@ INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
   auto key_index = KeyIndex(key, comparator);
 
-  if (key_index == -1 || comparator(key, array[key_index].first) != 0) {
+  if (key_index == -1 || CompareKeyAt(key_index, key, comparator) != 0) {
     return false;
   }
 
-  *value = array[key_index].second;
+  *value = ValueAt(key_index);
   return true;
 }
 
@@ -181,29 +235,15 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * NOTE: store key&value pair continuously after deletion
  * @return   page size after deletion
  */
-
-// TODO binary_seach
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-  int target_index = -1;
-
-  target_index = KeyIndex(key, comparator);
+  int target_index = KeyIndex(key, comparator);
 
-  if (target_index == -1 || comparator(key, array[target_index].first) != 0)
-  {
+  if (target_index == -1 || CompareKeyAt(target_index, key, comparator) != 0) {
     return GetSize();
   }
 
-  if (target_index != -1)
-  {
-    for (int i = target_index; i < GetSize() - 1 ; ++i)
-    {
-      array[i] = array[i + 1];
-    }
-
-    IncreaseSize(-1);
-  }
-
+  Remove(target_index);
   return GetSize();
 }
 
@@ -213,10 +253,11 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
 /*
  * Remove all of key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
+ * Caller checks recipient->CanMergeFrom(this) first.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-  recipient->CopyNFrom(array, GetSize());
+  recipient->CopyNFrom(Codec().Items(0, GetSize()));
   SetSize(0);
 }
 
@@ -225,47 +266,44 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  *****************************************************************************/
 /*
  * Remove the first key & value pair from this page to "recipient" page.
+ * @return false if recipient has no room for it, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyLastFrom(array[0]);
-  for (int i = 0; i < GetSize(); ++i)
-  {
-    array[i] = array[i+1];
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  if (!recipient->CopyLastFrom(GetItem(0))) {
+    return false;
   }
-  IncreaseSize(-1);
+  Remove(0);
+  return true;
 }
 
 /*
  * Copy the item into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  array[GetSize()] = item;
-  IncreaseSize(1);
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
+  return Codec().Insert(GetSize(), item.first, item.second);
 }
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
+ * @return false if recipient has no room for it, nothing is moved
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
-  recipient->CopyFirstFrom(array[GetSize() - 1]);
-  IncreaseSize(-1);
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  if (!recipient->CopyFirstFrom(GetItem(GetSize() - 1))) {
+    return false;
+  }
+  Remove(GetSize() - 1);
+  return true;
 }
 
 /*
  * Insert item at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  for (int i = GetSize() ; i >= 0 ; --i)
-  {
-    array[i + 1] = array[i];
-  }
-
-  array[0] = item;
-  IncreaseSize(1);
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  return Codec().Insert(0, item.first, item.second);
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
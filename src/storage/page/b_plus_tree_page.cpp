@@ -8,9 +8,6 @@ namespace bustub {
  */
 bool BPlusTreePage::IsLeafPage() const { return page_type_ == IndexPageType::LEAF_PAGE; }
 
-// No parents
-bool BPlusTreePage::IsRootPage() const { return parent_page_id_ == INVALID_PAGE_ID; }
-
 void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_  = page_type; }
 
 /*
@@ -36,12 +33,6 @@ int BPlusTreePage::GetMinSize() const {
   return max_size_ / 2;
 }
 
-/*
- * Helper methods to get/set parent page id
- */
-page_id_t BPlusTreePage::GetParentPageId() const { return parent_page_id_; }
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) { parent_page_id_ = parent_page_id; }
-
 /*
  * Helper methods to get/set self page id
  */
@@ -53,4 +44,14 @@ void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+/*
+ * Helper methods to get/set the packed key layout, number of bytes shared by
+ * every key of the page and number of bytes each slot keeps after them
+ */
+uint16_t BPlusTreePage::GetKeyPrefixSize() const { return key_prefix_size_; }
+void BPlusTreePage::SetKeyPrefixSize(uint16_t prefix_size) { key_prefix_size_ = prefix_size; }
+
+uint16_t BPlusTreePage::GetKeyWidth() const { return key_width_; }
+void BPlusTreePage::SetKeyWidth(uint16_t width) { key_width_ = width; }
+
 }  // namespace bustub
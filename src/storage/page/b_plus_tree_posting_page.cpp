@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+/*
+ * Init method after creating a new posting page
+ */
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Init(page_id_t page_id, int max_size) {
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  tail_page_id_ = page_id;
+  size_ = 0;
+  max_size_ = max_size;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::GetPageId() const { return page_id_; }
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::GetTailPageId() const { return tail_page_id_; }
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::SetTailPageId(page_id_t tail_page_id) { tail_page_id_ = tail_page_id; }
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::GetSize() const { return size_; }
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::GetMaxSize() const { return max_size_; }
+
+template <typename ValueType>
+bool B_PLUS_TREE_POSTING_PAGE_TYPE::IsFull() const { return size_ >= max_size_; }
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_POSTING_PAGE_TYPE::ValueAt(int index) const { return array_[index]; }
+
+/*
+ * Helper method to find the array offset of value
+ * If return -1, it means can't find value.
+ */
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  int index = LowerBound(value);
+  if (index < size_ && array_[index] == value) {
+    return index;
+  }
+  return -1;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::LowerBound(const ValueType &value) const {
+  int left = 0;
+  int right = size_;
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (PostingValueLess(array_[mid], value)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Append(const ValueType &value) {
+  array_[size_] = value;
+  size_++;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Insert(const ValueType &value) {
+  int index = LowerBound(value);
+  std::copy_backward(array_ + index, array_ + size_, array_ + size_ + 1);
+  array_[index] = value;
+  size_++;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Remove(int index) {
+  std::copy(array_ + index + 1, array_ + size_, array_ + index);
+  size_--;
+}
+
+/*
+ * Split helper: the recipient is linked right after this page, so moving the
+ * upper half keeps the chain sorted.
+ */
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::MoveHalfTo(BPlusTreePostingPage *recipient) {
+  int keep = size_ / 2;
+  std::copy(array_ + keep, array_ + size_, recipient->array_ + recipient->size_);
+  recipient->size_ += size_ - keep;
+  size_ = keep;
+}
+
+template class BPlusTreePostingPage<RID>;
+
+}  // namespace bustub
@@ -0,0 +1,793 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page.cpp
+//
+// Identification: src/storage/page/compressed_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/compressed_page.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace bustub {
+
+namespace {
+
+/** The size of the header of a dictionary block, the offsets of the entries follow it */
+constexpr size_t SIZE_DICTIONARY_HEADER = 12;
+
+/** @return the size of a value of the type in a tuple, the offset of its payload for a varchar */
+uint32_t FixedLength(TypeId type) {
+  if (type == TypeId::VARCHAR) {
+    return Column(std::string(), type, uint32_t{0}).GetFixedLength();
+  }
+  return Column(std::string(), type).GetFixedLength();
+}
+
+bool IsInteger(TypeId type) {
+  return type == TypeId::BOOLEAN || type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER ||
+         type == TypeId::BIGINT;
+}
+
+int64_t ReadInteger(const char *data, uint32_t width) {
+  switch (width) {
+    case 1:
+      return *reinterpret_cast<const int8_t *>(data);
+    case 2:
+      return *reinterpret_cast<const int16_t *>(data);
+    case 4:
+      return *reinterpret_cast<const int32_t *>(data);
+    default:
+      return *reinterpret_cast<const int64_t *>(data);
+  }
+}
+
+void WriteInteger(char *data, uint32_t width, int64_t value) {
+  switch (width) {
+    case 1:
+      *reinterpret_cast<int8_t *>(data) = static_cast<int8_t>(value);
+      break;
+    case 2:
+      *reinterpret_cast<int16_t *>(data) = static_cast<int16_t>(value);
+      break;
+    case 4:
+      *reinterpret_cast<int32_t *>(data) = static_cast<int32_t>(value);
+      break;
+    default:
+      *reinterpret_cast<int64_t *>(data) = value;
+  }
+}
+
+/** @return the size of a varchar payload, see Tuple */
+uint32_t PayloadSize(const char *payload) {
+  uint32_t len = *reinterpret_cast<const uint32_t *>(payload);
+  return len == BUSTUB_VALUE_NULL ? sizeof(uint32_t) : sizeof(uint32_t) + len;
+}
+
+/** @return the number of bits needed by codes up to max_code */
+uint32_t BitsFor(uint64_t max_code) {
+  uint32_t bits = 0;
+  while (bits < 64 && (max_code >> bits) != 0) {
+    bits++;
+  }
+  return bits;
+}
+
+uint64_t ReadBits(const char *data, uint64_t bit_offset, uint32_t bits) {
+  uint64_t value = 0;
+  for (uint32_t done = 0; done < bits;) {
+    uint64_t position = bit_offset + done;
+    uint32_t shift = position % 8;
+    uint32_t take = std::min(8 - shift, bits - done);
+    uint64_t byte = static_cast<uint8_t>(data[position / 8]);
+    value |= ((byte >> shift) & ((1U << take) - 1)) << done;
+    done += take;
+  }
+  return value;
+}
+
+void WriteBits(char *data, uint64_t bit_offset, uint32_t bits, uint64_t value) {
+  for (uint32_t done = 0; done < bits;) {
+    uint64_t position = bit_offset + done;
+    uint32_t shift = position % 8;
+    uint32_t take = std::min(8 - shift, bits - done);
+    auto part = static_cast<uint8_t>((value >> done) & ((1U << take) - 1));
+    data[position / 8] = static_cast<char>(static_cast<uint8_t>(data[position / 8]) | (part << shift));
+    done += take;
+  }
+}
+
+template <typename T>
+void Append(std::vector<char> *out, const T &value) {
+  const auto *bytes = reinterpret_cast<const char *>(&value);
+  out->insert(out->end(), bytes, bytes + sizeof(T));
+}
+
+/** Append the codes of a column, packed or in runs, whichever is smaller. @return the layout used */
+CodeLayout AppendCodes(std::vector<char> *out, const std::vector<uint64_t> &codes, uint32_t bits) {
+  size_t packed_size = (codes.size() * bits + 7) / 8;
+  uint32_t code_size = (bits + 7) / 8;
+  uint32_t run_count = 0;
+  for (size_t i = 0; i < codes.size(); i++) {
+    if (i == 0 || codes[i] != codes[i - 1]) {
+      run_count++;
+    }
+  }
+  size_t runs_size = sizeof(uint32_t) + run_count * (sizeof(uint16_t) + code_size);
+  if (packed_size <= runs_size) {
+    size_t begin = out->size();
+    out->resize(begin + packed_size, 0);
+    for (size_t i = 0; i < codes.size(); i++) {
+      WriteBits(out->data() + begin, i * bits, bits, codes[i]);
+    }
+    return CodeLayout::PACKED;
+  }
+  Append(out, run_count);
+  for (size_t i = 0; i < codes.size(); i++) {
+    if (i + 1 == codes.size() || codes[i + 1] != codes[i]) {
+      Append(out, static_cast<uint16_t>(i + 1));
+      const auto *bytes = reinterpret_cast<const char *>(&codes[i]);
+      out->insert(out->end(), bytes, bytes + code_size);
+    }
+  }
+  return CodeLayout::RUNS;
+}
+
+}  // namespace
+
+void CompressedPage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
+                          Transaction *txn, const std::vector<TypeId> &column_types) {
+  // Set the page ID.
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  // Log that we are creating a new page.
+  if (enable_logging) {
+    LogRecord log_record =
+        LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, prev_page_id, page_id);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  // Set the previous and next page IDs.
+  SetPrevPageId(prev_page_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetTupleCount(0);
+  SetFlags(0);
+
+  auto column_count = static_cast<uint32_t>(column_types.size());
+  BUSTUB_ASSERT(HeaderSize(column_count) < page_size, "Too many columns for a compressed page.");
+  memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto type = static_cast<uint32_t>(column_types[i]);
+    uint32_t width = FixedLength(column_types[i]);
+    memcpy(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * i, &type, sizeof(uint32_t));
+    memcpy(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * i + sizeof(uint32_t), &width, sizeof(uint32_t));
+  }
+  // Lay out the empty column blocks.
+  bool encoded = Encode(Rows{{}, std::vector<std::vector<int64_t>>(column_count),
+                             std::vector<std::vector<std::string>>(column_count),
+                             std::vector<std::string>(column_count)});
+  BUSTUB_ASSERT(encoded, "The columns do not fit in the page.");
+}
+
+std::vector<TypeId> CompressedPage::ColumnTypes(const Schema &schema) {
+  std::vector<TypeId> column_types;
+  column_types.reserve(schema.GetColumnCount());
+  for (const auto &column : schema.GetColumns()) {
+    column_types.push_back(column.GetType());
+  }
+  return column_types;
+}
+
+Value CompressedPage::GetValue(uint32_t slot_num, uint32_t column_idx) {
+  BUSTUB_ASSERT(IsVisible(slot_num), "Cannot read a deleted tuple.");
+  TypeId type = GetColumnType(column_idx);
+  if (type == TypeId::VARCHAR) {
+    return Value::DeserializeFrom(GetPayload(column_idx, slot_num), type);
+  }
+  char value[sizeof(int64_t)];
+  GetFixedValue(column_idx, slot_num, value);
+  return Value::DeserializeFrom(value, type);
+}
+
+void CompressedPage::MatchColumn(uint32_t column_idx, const std::function<bool(const Value &)> &match,
+                                 std::vector<bool> *matches) {
+  uint32_t tuple_count = GetTupleCount();
+  matches->assign(tuple_count, false);
+  TypeId type = GetColumnType(column_idx);
+  ColumnEncoding encoding = GetColumnEncoding(column_idx);
+  const char *block = GetColumnBlock(column_idx);
+  uint32_t bits = static_cast<uint8_t>(block[2]);
+
+  // The value of a code, for the columns that have codes.
+  auto code_value = [&](uint64_t code) {
+    if (encoding == ColumnEncoding::DICTIONARY) {
+      uint32_t entry_offset =
+          *reinterpret_cast<const uint32_t *>(block + SIZE_DICTIONARY_HEADER + sizeof(uint32_t) * code);
+      return Value::ViewFrom(block + entry_offset, type);
+    }
+    char value[sizeof(int64_t)];
+    int64_t base = *reinterpret_cast<const int64_t *>(block + SIZE_BLOCK_HEADER);
+    WriteInteger(value, GetColumnWidth(column_idx), base + static_cast<int64_t>(code));
+    return Value::DeserializeFrom(value, type);
+  };
+
+  if (encoding == ColumnEncoding::PLAIN) {
+    for (uint32_t i = 0; i < tuple_count; i++) {
+      (*matches)[i] = IsVisible(i) && match(GetValue(i, column_idx));
+    }
+  } else if (GetCodeLayout(column_idx) == CodeLayout::RUNS) {
+    // Once per run.
+    const char *codes = GetCodes(column_idx);
+    uint32_t run_count = *reinterpret_cast<const uint32_t *>(codes);
+    size_t run_size = sizeof(uint16_t) + (bits + 7) / 8;
+    uint32_t begin = 0;
+    for (uint32_t run = 0; run < run_count; run++) {
+      const char *run_data = codes + sizeof(uint32_t) + run * run_size;
+      uint32_t end = *reinterpret_cast<const uint16_t *>(run_data);
+      uint64_t code = 0;
+      memcpy(&code, run_data + sizeof(uint16_t), run_size - sizeof(uint16_t));
+      if (match(code_value(code))) {
+        for (uint32_t i = begin; i < end; i++) {
+          (*matches)[i] = IsVisible(i);
+        }
+      }
+      begin = end;
+    }
+  } else {
+    // Once per entry of the dictionary, or per possible code when there are few of them.
+    size_t code_count = encoding == ColumnEncoding::DICTIONARY ? *reinterpret_cast<const uint32_t *>(block + 4)
+                        : bits <= 8                              ? size_t{1} << bits
+                                                                 : 0;
+    if (code_count == 0 || code_count > tuple_count) {
+      for (uint32_t i = 0; i < tuple_count; i++) {
+        (*matches)[i] = IsVisible(i) && match(code_value(GetCode(column_idx, i)));
+      }
+      return;
+    }
+    std::vector<bool> code_matches(code_count);
+    for (size_t code = 0; code < code_count; code++) {
+      code_matches[code] = match(code_value(code));
+    }
+    for (uint32_t i = 0; i < tuple_count; i++) {
+      (*matches)[i] = IsVisible(i) && code_matches[GetCode(column_idx, i)];
+    }
+  }
+}
+
+bool CompressedPage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
+                                 LogManager *log_manager) {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  if ((GetFlags() & FLAG_SEALED) != 0) {
+    return false;
+  }
+  uint32_t slot_num = FindFreeSlot();
+  Rows rows = Decode();
+  SetRow(&rows, slot_num, tuple);
+  // If the page cannot hold the encoded rows, seal it.
+  if (!Encode(rows)) {
+    SetFlags(GetFlags() | FLAG_SEALED);
+    return false;
+  }
+  rid->Set(GetTablePageId(), slot_num);
+
+  // Write the log record.
+  if (enable_logging) {
+    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
+    // Acquire an exclusive lock on the new tuple.
+    bool locked = lock_manager->LockExclusive(txn, *rid);
+    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return true;
+}
+
+size_t CompressedPage::BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids,
+                                        Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  if ((GetFlags() & FLAG_SEALED) != 0 || begin == tuples.size()) {
+    return begin;
+  }
+  // Search for the most tuples that fit. Each takes at least its status byte.
+  uint32_t tuple_count = GetTupleCount();
+  Rows rows = Decode();
+  auto encode = [&](size_t count) {
+    Rows batch = rows;
+    for (size_t i = 0; i < count; i++) {
+      SetRow(&batch, tuple_count + i, tuples[begin + i]);
+    }
+    return Encode(batch);
+  };
+  size_t low = 0;
+  size_t high = std::min(tuples.size() - begin, static_cast<size_t>(PAGE_SIZE - GetSize()));
+  while (low < high) {
+    size_t mid = (low + high + 1) / 2;
+    if (encode(mid)) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  encode(low);
+  size_t end = begin + low;
+  for (size_t i = begin; i < end; i++) {
+    rids->emplace_back(GetTablePageId(), tuple_count + (i - begin));
+  }
+  if (end < tuples.size()) {
+    SetFlags(GetFlags() | FLAG_SEALED);
+  }
+
+  // Write one log record for the whole batch.
+  if (enable_logging && end > begin) {
+    for (auto rid = rids->end() - (end - begin); rid != rids->end(); ++rid) {
+      bool locked = lock_manager->LockExclusive(txn, *rid);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT, GetTablePageId(),
+                         std::vector<Tuple>(tuples.begin() + begin, tuples.begin() + end));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return end;
+}
+
+bool CompressedPage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager,
+                                LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot number is invalid or the tuple is already deleted, abort the transaction.
+  if (!IsVisible(slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (enable_logging) {
+    // Acquire an exclusive lock, upgrading from a shared lock if necessary.
+    if (txn->IsSharedLocked(rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid)) {
+        return false;
+      }
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+      return false;
+    }
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  // Mark the tuple as deleted.
+  SetStatus(slot_num, STATUS_DELETED);
+  return true;
+}
+
+bool CompressedPage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                                 LockManager *lock_manager, LogManager *log_manager) {
+  BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot number is invalid or the tuple is deleted, abort the transaction.
+  if (!IsVisible(slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  // Copy out the old value.
+  ReadRow(slot_num, old_tuple);
+  old_tuple->rid_ = rid;
+
+  // Acquire an exclusive lock before the page changes, upgrading from shared if necessary.
+  if (enable_logging) {
+    if (txn->IsSharedLocked(rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid)) {
+        return false;
+      }
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+      return false;
+    }
+  }
+
+  // Perform the update. If the page cannot hold the new tuple, we need to update via delete followed by an insert.
+  Rows rows = Decode();
+  SetRow(&rows, slot_num, new_tuple);
+  if (!Encode(rows)) {
+    return false;
+  }
+
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return true;
+}
+
+void CompressedPage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+
+  // We need to copy out the deleted tuple for undo purposes.
+  Tuple delete_tuple;
+  if (enable_logging || deleted_tuple != nullptr) {
+    ReadRow(slot_num, &delete_tuple);
+    delete_tuple.rid_ = rid;
+  }
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = delete_tuple;
+  }
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
+
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  // The slot can be reused, and the page may have room again.
+  SetStatus(slot_num, STATUS_FREE);
+  SetFlags(GetFlags() & ~FLAG_SEALED);
+}
+
+void CompressedPage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+  // Log the rollback.
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  SetStatus(slot_num, STATUS_LIVE);
+}
+
+bool CompressedPage::Compact() {
+  Rows rows = Decode();
+  size_t tuple_count = rows.status_.size();
+  while (tuple_count > 0 && rows.status_[tuple_count - 1] == STATUS_FREE) {
+    tuple_count--;
+  }
+  rows.status_.resize(tuple_count);
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    rows.integers_[i].resize(std::min(rows.integers_[i].size(), tuple_count));
+    rows.payloads_[i].resize(std::min(rows.payloads_[i].size(), tuple_count));
+    rows.plain_[i].resize(std::min(rows.plain_[i].size(), tuple_count * GetColumnWidth(i)));
+  }
+  // A free slot takes the values of the slot before it, so the values of the freed tuples leave the dictionaries
+  // and the runs grow.
+  size_t first_used = 0;
+  while (first_used < tuple_count && rows.status_[first_used] == STATUS_FREE) {
+    first_used++;
+  }
+  for (size_t slot = 0; slot < tuple_count; slot++) {
+    if (rows.status_[slot] != STATUS_FREE) {
+      continue;
+    }
+    size_t from = slot < first_used ? first_used : slot - 1;
+    for (uint32_t i = 0; i < GetColumnCount(); i++) {
+      switch (GetColumnEncoding(i)) {
+        case ColumnEncoding::FRAME_OF_REFERENCE:
+          rows.integers_[i][slot] = rows.integers_[i][from];
+          break;
+        case ColumnEncoding::DICTIONARY:
+          rows.payloads_[i][slot] = rows.payloads_[i][from];
+          break;
+        case ColumnEncoding::PLAIN: {
+          uint32_t width = GetColumnWidth(i);
+          rows.plain_[i].replace(slot * width, width, rows.plain_[i], from * width, width);
+          break;
+        }
+      }
+    }
+  }
+  // Dropping values never makes the rows larger, so they fit.
+  Encode(rows);
+  return GetTupleCount() == 0;
+}
+
+bool CompressedPage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot is invalid or the tuple is deleted, abort the transaction.
+  if (!IsVisible(slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  // Otherwise we have a valid tuple, try to acquire at least a shared lock.
+  if (enable_logging && lock_manager != nullptr) {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+
+  ReadRow(slot_num, tuple);
+  tuple->rid_ = rid;
+  return true;
+}
+
+bool CompressedPage::GetFirstTupleRid(RID *first_rid) {
+  // Find and return the first valid tuple.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (IsVisible(i)) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool CompressedPage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
+  BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  // Find and return the first valid tuple after our current slot number.
+  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
+    if (IsVisible(i)) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  // Otherwise return false as there are no more tuples.
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+uint32_t CompressedPage::GetInsertableSize() {
+  // A tuple takes a status byte, and at most its own size in the columns when it is the only one of the page.
+  if ((GetFlags() & FLAG_SEALED) != 0 || GetSize() + 1 >= PAGE_SIZE) {
+    return 0;
+  }
+  return PAGE_SIZE - GetSize() - 1;
+}
+
+uint64_t CompressedPage::GetCode(uint32_t column_idx, uint32_t slot_num) {
+  const char *block = GetColumnBlock(column_idx);
+  uint32_t bits = static_cast<uint8_t>(block[2]);
+  const char *codes = GetCodes(column_idx);
+  if (GetCodeLayout(column_idx) == CodeLayout::PACKED) {
+    return ReadBits(codes, static_cast<uint64_t>(slot_num) * bits, bits);
+  }
+  // Find the first run that ends after the slot.
+  uint32_t run_count = *reinterpret_cast<const uint32_t *>(codes);
+  size_t run_size = sizeof(uint16_t) + (bits + 7) / 8;
+  const char *runs = codes + sizeof(uint32_t);
+  uint32_t low = 0;
+  uint32_t high = run_count - 1;
+  while (low < high) {
+    uint32_t mid = (low + high) / 2;
+    if (*reinterpret_cast<const uint16_t *>(runs + mid * run_size) <= slot_num) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  uint64_t code = 0;
+  memcpy(&code, runs + low * run_size + sizeof(uint16_t), run_size - sizeof(uint16_t));
+  return code;
+}
+
+const char *CompressedPage::GetCodes(uint32_t column_idx) {
+  const char *block = GetColumnBlock(column_idx);
+  if (GetColumnEncoding(column_idx) == ColumnEncoding::DICTIONARY) {
+    return block + *reinterpret_cast<const uint32_t *>(block + 8);
+  }
+  return block + SIZE_BLOCK_HEADER + sizeof(int64_t);
+}
+
+const char *CompressedPage::GetPayload(uint32_t column_idx, uint32_t slot_num) {
+  const char *block = GetColumnBlock(column_idx);
+  uint64_t code = GetCode(column_idx, slot_num);
+  return block + *reinterpret_cast<const uint32_t *>(block + SIZE_DICTIONARY_HEADER + sizeof(uint32_t) * code);
+}
+
+void CompressedPage::GetFixedValue(uint32_t column_idx, uint32_t slot_num, char *value) {
+  const char *block = GetColumnBlock(column_idx);
+  uint32_t width = GetColumnWidth(column_idx);
+  if (GetColumnEncoding(column_idx) == ColumnEncoding::PLAIN) {
+    memcpy(value, block + SIZE_BLOCK_HEADER + slot_num * width, width);
+    return;
+  }
+  int64_t base = *reinterpret_cast<const int64_t *>(block + SIZE_BLOCK_HEADER);
+  WriteInteger(value, width, base + static_cast<int64_t>(GetCode(column_idx, slot_num)));
+}
+
+CompressedPage::Rows CompressedPage::Decode() {
+  uint32_t tuple_count = GetTupleCount();
+  uint32_t column_count = GetColumnCount();
+  Rows rows;
+  rows.status_.resize(tuple_count);
+  for (uint32_t slot = 0; slot < tuple_count; slot++) {
+    rows.status_[slot] = GetStatus(slot);
+  }
+  rows.integers_.resize(column_count);
+  rows.payloads_.resize(column_count);
+  rows.plain_.resize(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    switch (GetColumnEncoding(i)) {
+      case ColumnEncoding::FRAME_OF_REFERENCE: {
+        int64_t base = *reinterpret_cast<const int64_t *>(GetColumnBlock(i) + SIZE_BLOCK_HEADER);
+        rows.integers_[i].reserve(tuple_count);
+        for (uint32_t slot = 0; slot < tuple_count; slot++) {
+          rows.integers_[i].push_back(base + static_cast<int64_t>(GetCode(i, slot)));
+        }
+        break;
+      }
+      case ColumnEncoding::DICTIONARY:
+        rows.payloads_[i].reserve(tuple_count);
+        for (uint32_t slot = 0; slot < tuple_count; slot++) {
+          const char *payload = GetPayload(i, slot);
+          rows.payloads_[i].emplace_back(payload, PayloadSize(payload));
+        }
+        break;
+      case ColumnEncoding::PLAIN:
+        rows.plain_[i].assign(GetColumnBlock(i) + SIZE_BLOCK_HEADER, tuple_count * GetColumnWidth(i));
+        break;
+    }
+  }
+  return rows;
+}
+
+void CompressedPage::SetRow(Rows *rows, uint32_t slot_num, const Tuple &tuple) {
+  if (slot_num >= rows->status_.size()) {
+    rows->status_.resize(slot_num + 1, STATUS_FREE);
+  }
+  rows->status_[slot_num] = STATUS_LIVE;
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    TypeId type = GetColumnType(i);
+    uint32_t width = GetColumnWidth(i);
+    const char *data = tuple.data_ + offset;
+    if (type == TypeId::VARCHAR) {
+      const char *payload = tuple.data_ + *reinterpret_cast<const uint32_t *>(data);
+      rows->payloads_[i].resize(rows->status_.size());
+      rows->payloads_[i][slot_num].assign(payload, PayloadSize(payload));
+    } else if (IsInteger(type)) {
+      rows->integers_[i].resize(rows->status_.size());
+      rows->integers_[i][slot_num] = ReadInteger(data, width);
+    } else {
+      rows->plain_[i].resize(rows->status_.size() * width);
+      rows->plain_[i].replace(slot_num * width, width, data, width);
+    }
+    offset += width;
+  }
+}
+
+bool CompressedPage::Encode(const Rows &rows) {
+  uint32_t column_count = GetColumnCount();
+  size_t header_size = HeaderSize(column_count);
+  auto tuple_count = static_cast<uint32_t>(rows.status_.size());
+  std::vector<char> body(rows.status_.begin(), rows.status_.end());
+  std::vector<uint32_t> block_offsets(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    block_offsets[i] = header_size + body.size();
+    TypeId type = GetColumnType(i);
+    std::vector<uint64_t> codes;
+    codes.reserve(tuple_count);
+    if (type == TypeId::VARCHAR) {
+      // Codes into the distinct payloads, in the order they appear.
+      std::unordered_map<std::string, uint64_t> dictionary;
+      std::vector<const std::string *> entries;
+      for (const auto &payload : rows.payloads_[i]) {
+        auto entry = dictionary.emplace(payload, entries.size());
+        if (entry.second) {
+          entries.push_back(&entry.first->first);
+        }
+        codes.push_back(entry.first->second);
+      }
+      uint32_t bits = entries.empty() ? 0 : BitsFor(entries.size() - 1);
+      size_t block = body.size();
+      Append(&body, static_cast<uint8_t>(ColumnEncoding::DICTIONARY));
+      Append(&body, uint8_t{0});
+      Append(&body, static_cast<uint8_t>(bits));
+      Append(&body, uint8_t{0});
+      Append(&body, static_cast<uint32_t>(entries.size()));
+      Append(&body, uint32_t{0});
+      uint32_t entry_offset = SIZE_DICTIONARY_HEADER + sizeof(uint32_t) * entries.size();
+      for (const auto *entry : entries) {
+        Append(&body, entry_offset);
+        entry_offset += entry->size();
+      }
+      for (const auto *entry : entries) {
+        body.insert(body.end(), entry->begin(), entry->end());
+      }
+      auto codes_offset = static_cast<uint32_t>(body.size() - block);
+      memcpy(body.data() + block + 8, &codes_offset, sizeof(uint32_t));
+      body[block + 1] = static_cast<char>(AppendCodes(&body, codes, bits));
+    } else if (IsInteger(type)) {
+      // Codes from the smallest value.
+      const auto &integers = rows.integers_[i];
+      int64_t base = integers.empty() ? 0 : *std::min_element(integers.begin(), integers.end());
+      uint64_t max_code = 0;
+      for (auto integer : integers) {
+        codes.push_back(static_cast<uint64_t>(integer) - static_cast<uint64_t>(base));
+        max_code = std::max(max_code, codes.back());
+      }
+      uint32_t bits = BitsFor(max_code);
+      size_t block = body.size();
+      Append(&body, static_cast<uint8_t>(ColumnEncoding::FRAME_OF_REFERENCE));
+      Append(&body, uint8_t{0});
+      Append(&body, static_cast<uint8_t>(bits));
+      Append(&body, uint8_t{0});
+      Append(&body, base);
+      body[block + 1] = static_cast<char>(AppendCodes(&body, codes, bits));
+    } else {
+      Append(&body, static_cast<uint32_t>(ColumnEncoding::PLAIN));
+      body.insert(body.end(), rows.plain_[i].begin(), rows.plain_[i].end());
+    }
+    if (header_size + body.size() > PAGE_SIZE) {
+      return false;
+    }
+  }
+
+  memcpy(GetData() + header_size, body.data(), body.size());
+  for (uint32_t i = 0; i < column_count; i++) {
+    memcpy(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * i + 2 * sizeof(uint32_t), &block_offsets[i], sizeof(uint32_t));
+  }
+  SetTupleCount(tuple_count);
+  SetSize(header_size + body.size());
+  return true;
+}
+
+uint32_t CompressedPage::FindFreeSlot() {
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetStatus(i) == STATUS_FREE) {
+      return i;
+    }
+  }
+  return tuple_count;
+}
+
+void CompressedPage::ReadRow(uint32_t slot_num, Tuple *tuple) {
+  uint32_t column_count = GetColumnCount();
+  uint32_t fixed_size = 0;
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < column_count; i++) {
+    fixed_size += GetColumnWidth(i);
+    if (GetColumnType(i) == TypeId::VARCHAR) {
+      size += PayloadSize(GetPayload(i, slot_num));
+    }
+  }
+  size += fixed_size;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->size_ = size;
+  tuple->data_ = new char[size];
+  tuple->allocated_ = true;
+  memset(tuple->data_, 0, size);
+
+  // The fixed-size parts in the order of the columns, then the payloads.
+  uint32_t offset = 0;
+  uint32_t payload_offset = fixed_size;
+  for (uint32_t i = 0; i < column_count; i++) {
+    if (GetColumnType(i) == TypeId::VARCHAR) {
+      const char *payload = GetPayload(i, slot_num);
+      uint32_t payload_size = PayloadSize(payload);
+      memcpy(tuple->data_ + offset, &payload_offset, sizeof(uint32_t));
+      memcpy(tuple->data_ + payload_offset, payload, payload_size);
+      payload_offset += payload_size;
+    } else {
+      GetFixedValue(i, slot_num, tuple->data_ + offset);
+    }
+    offset += GetColumnWidth(i);
+  }
+}
+
+}  // namespace bustub
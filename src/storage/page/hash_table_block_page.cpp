@@ -10,6 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <cassert>
+
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
 
@@ -17,33 +23,75 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
-  return {};
+  return array_[bucket_ind].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
-  return false;
+bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                   uint8_t fingerprint) {
+  if (IsReadable(bucket_ind)) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  tags_[bucket_ind] = fingerprint;
+  return true;
 }
 
+/*
+ * The slot stays occupied as a tombstone, so probes for the keys placed
+ * after it keep going
+ */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  tags_[bucket_ind] = TOMBSTONE_TAG;
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
-  return false;
+  return tags_[bucket_ind] != EMPTY_TAG;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
-  return false;
+  return (tags_[bucket_ind] & 0x80) != 0;
+}
+
+/*
+ * A group near the end of the tags reads past them into array_, which is
+ * still in the page; the bits of those slots are masked out.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BLOCK_TYPE::MatchGroup(slot_offset_t start, slot_offset_t count, uint8_t fingerprint,
+                                           uint32_t *empty) const {
+  assert(count <= BLOCK_TAG_GROUP_SIZE);
+  uint32_t match;
+#if defined(__AVX2__)
+  __m256i tags = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags_ + start));
+  match = static_cast<uint32_t>(
+      _mm256_movemask_epi8(_mm256_cmpeq_epi8(tags, _mm256_set1_epi8(static_cast<char>(fingerprint)))));
+  *empty = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(tags, _mm256_setzero_si256())));
+#elif defined(__SSE2__)
+  __m128i tags = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + start));
+  match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_set1_epi8(static_cast<char>(fingerprint)))));
+  *empty = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(tags, _mm_setzero_si128())));
+#else
+  match = 0;
+  *empty = 0;
+  for (slot_offset_t i = 0; i < count; i++) {
+    match |= static_cast<uint32_t>(tags_[start + i] == fingerprint) << i;
+    *empty |= static_cast<uint32_t>(tags_[start + i] == EMPTY_TAG) << i;
+  }
+#endif
+  uint32_t in_group = count == 32 ? ~0U : (1U << count) - 1;
+  *empty &= in_group;
+  return match & in_group;
 }
 
-// DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBlockPage<int, int, IntComparator>;
 template class HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class HashTableBlockPage<GenericKey<8>, RID, GenericComparator<8>>;
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_bucket_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) const {
+  bool found = false;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && cmp(array_[i].first, key) == 0) {
+      result->push_back(array_[i].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key, const ValueType &value, KeyComparator cmp) {
+  slot_offset_t free_slot = BUCKET_ARRAY_SIZE;
+  slot_offset_t i = 0;
+  for (; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (!IsReadable(i)) {
+      free_slot = std::min(free_slot, i);
+    } else if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      return false;
+    }
+  }
+  // no tombstone to reuse, take the first slot never occupied
+  if (free_slot == BUCKET_ARRAY_SIZE) {
+    if (i == BUCKET_ARRAY_SIZE) {
+      return false;
+    }
+    free_slot = i;
+  }
+  array_[free_slot] = MappingType(key, value);
+  char mask = static_cast<char>(1 << (free_slot % 8));
+  occupied_[free_slot / 8] |= mask;
+  readable_[free_slot / 8] |= mask;
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key, const ValueType &value, KeyComparator cmp) {
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i) && cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+      RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(slot_offset_t bucket_idx) const {
+  return array_[bucket_idx].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(slot_offset_t bucket_idx) const {
+  return array_[bucket_idx].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(slot_offset_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsOccupied(slot_offset_t bucket_idx) const {
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsReadable(slot_offset_t bucket_idx) const {
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() const {
+  uint32_t num_readable = 0;
+  for (slot_offset_t i = 0; i < BUCKET_ARRAY_SIZE && IsOccupied(i); i++) {
+    if (IsReadable(i)) {
+      num_readable++;
+    }
+  }
+  return num_readable;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
+  return NumReadable() == BUCKET_ARRAY_SIZE;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
+  return NumReadable() == 0;
+}
+
+template class HashTableBucketPage<int, int, IntComparator>;
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
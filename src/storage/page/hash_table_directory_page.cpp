@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_page.h"
+
+#include <unordered_map>
+
+namespace bustub {
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(global_depth_ < HASH_TABLE_DIRECTORY_MAX_DEPTH);
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[size + i] = local_depths_[i];
+    bucket_page_ids_[size + i] = bucket_page_ids_[i];
+  }
+  global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  assert(CanShrink());
+  global_depth_--;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << global_depth_; }
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  assert(local_depth <= HASH_TABLE_DIRECTORY_MAX_DEPTH);
+  local_depths_[bucket_idx] = static_cast<uint8_t>(local_depth);
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) const {
+  return (1U << local_depths_[bucket_idx]) - 1;
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  assert(local_depths_[bucket_idx] > 0);
+  return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
+}
+
+void HashTableDirectoryPage::VerifyIntegrity() const {
+  std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+  std::unordered_map<page_id_t, uint32_t> page_id_to_local_depth;
+  for (uint32_t i = 0; i < Size(); i++) {
+    page_id_t page_id = bucket_page_ids_[i];
+    assert(local_depths_[i] <= global_depth_);
+    auto iter = page_id_to_local_depth.find(page_id);
+    if (iter == page_id_to_local_depth.end()) {
+      page_id_to_local_depth[page_id] = local_depths_[i];
+    } else {
+      assert(iter->second == local_depths_[i]);
+    }
+    page_id_to_count[page_id]++;
+  }
+  for (const auto &[page_id, count] : page_id_to_count) {
+    assert(count == (1U << (global_depth_ - page_id_to_local_depth[page_id])));
+    (void)page_id;
+    (void)count;
+  }
+}
+
+}  // namespace bustub
@@ -13,22 +13,38 @@
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
-page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) { return 0; }
+page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) {
+  assert(index < next_ind_);
+  return block_page_ids_[index];
+}
 
-page_id_t HashTableHeaderPage::GetPageId() const { return 0; }
+page_id_t HashTableHeaderPage::GetPageId() const { return page_id_; }
 
-void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) {}
+void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
 
-lsn_t HashTableHeaderPage::GetLSN() const { return 0; }
+lsn_t HashTableHeaderPage::GetLSN() const { return lsn_; }
 
-void HashTableHeaderPage::SetLSN(lsn_t lsn) {}
+void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {}
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  assert(next_ind_ < HASH_TABLE_HEADER_MAX_BLOCKS);
+  block_page_ids_[next_ind_] = page_id;
+  next_ind_++;
+}
 
-size_t HashTableHeaderPage::NumBlocks() { return 0; }
+size_t HashTableHeaderPage::NumBlocks() { return next_ind_; }
 
-void HashTableHeaderPage::SetSize(size_t size) {}
+void HashTableHeaderPage::SetSize(size_t size) { size_ = size; }
 
-size_t HashTableHeaderPage::GetSize() const { return 0; }
+size_t HashTableHeaderPage::GetSize() const { return size_; }
+
+size_t HashTableHeaderPage::GetLiveCount() const { return __atomic_load_n(&live_count_, __ATOMIC_RELAXED); }
+
+size_t HashTableHeaderPage::GetTombstoneCount() const { return __atomic_load_n(&tombstone_count_, __ATOMIC_RELAXED); }
+
+void HashTableHeaderPage::UpdateCounts(int64_t live_delta, int64_t tombstone_delta) {
+  __atomic_fetch_add(&live_count_, static_cast<size_t>(live_delta), __ATOMIC_RELAXED);
+  __atomic_fetch_add(&tombstone_count_, static_cast<size_t>(tombstone_delta), __ATOMIC_RELAXED);
+}
 
 }  // namespace bustub
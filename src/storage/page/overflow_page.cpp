@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.cpp
+//
+// Identification: src/storage/page/overflow_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/overflow_page.h"
+
+#include <algorithm>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+void OverflowPage::Init(page_id_t page_id, page_id_t next_page_id, const char *data, uint32_t size) {
+  BUSTUB_ASSERT(size <= CAPACITY, "The data does not fit in an overflow page.");
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetLSN(INVALID_LSN);
+  memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(next_page_id));
+  memcpy(GetData() + OFFSET_DATA_SIZE, &size, sizeof(size));
+  memcpy(GetData() + OFFSET_DATA, data, size);
+}
+
+page_id_t OverflowPage::WriteChain(BufferPoolManager *buffer_pool_manager, const char *data, uint32_t size) {
+  // The chain is written from its end, so each page knows its next one when it is initialized.
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  uint32_t end = size;
+  do {
+    uint32_t begin = end - std::min(end, (end - 1) % CAPACITY + 1);
+    page_id_t page_id;
+    auto page = static_cast<OverflowPage *>(buffer_pool_manager->NewPage(&page_id));
+    if (page == nullptr) {
+      DeleteChain(buffer_pool_manager, next_page_id);
+      return INVALID_PAGE_ID;
+    }
+    page->WLatch();
+    page->Init(page_id, next_page_id, data + begin, end - begin);
+    page->WUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, true);
+    next_page_id = page_id;
+    end = begin;
+  } while (end > 0);
+  return next_page_id;
+}
+
+bool OverflowPage::ReadChain(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, char *data,
+                             uint32_t size) {
+  uint32_t offset = 0;
+  page_id_t page_id = first_page_id;
+  while (offset < size && page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<OverflowPage *>(buffer_pool_manager->FetchPage(page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    page->RLatch();
+    uint32_t data_size = std::min(page->GetDataSize(), size - offset);
+    memcpy(data + offset, page->GetValueData(), data_size);
+    offset += data_size;
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return offset == size;
+}
+
+void OverflowPage::DeleteChain(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+  page_id_t page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<OverflowPage *>(buffer_pool_manager->FetchPage(page_id));
+    if (page == nullptr) {
+      return;
+    }
+    page->RLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,449 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void PaxPage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
+                   Transaction *txn, const std::vector<uint32_t> &column_widths, uint32_t capacity) {
+  // Set the page ID.
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  // Log that we are creating a new page.
+  if (enable_logging) {
+    LogRecord log_record =
+        LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, prev_page_id, page_id);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  // Set the previous and next page IDs.
+  SetPrevPageId(prev_page_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetFreeSpacePointer(page_size);
+  SetTupleCount(0);
+
+  // Lay out the minipages after the rows.
+  auto column_count = static_cast<uint32_t>(column_widths.size());
+  memcpy(GetData() + OFFSET_CAPACITY, &capacity, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  uint32_t fixed_length = 0;
+  uint32_t offset = HeaderSize(column_count) + capacity * SIZE_ROW;
+  for (uint32_t i = 0; i < column_count; i++) {
+    memcpy(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * i, &column_widths[i], sizeof(uint32_t));
+    memcpy(GetData() + OFFSET_COLUMNS + SIZE_COLUMN * i + sizeof(uint32_t), &offset, sizeof(uint32_t));
+    fixed_length += column_widths[i];
+    offset += capacity * column_widths[i];
+  }
+  memcpy(GetData() + OFFSET_FIXED_LENGTH, &fixed_length, sizeof(uint32_t));
+  BUSTUB_ASSERT(offset <= page_size, "The minipages do not fit in the page.");
+}
+
+std::vector<uint32_t> PaxPage::ColumnWidths(const Schema &schema) {
+  std::vector<uint32_t> column_widths;
+  column_widths.reserve(schema.GetColumnCount());
+  for (const auto &column : schema.GetColumns()) {
+    column_widths.push_back(column.GetFixedLength());
+  }
+  return column_widths;
+}
+
+uint32_t PaxPage::ComputeCapacity(const Schema &schema) {
+  size_t header_size = HeaderSize(schema.GetColumnCount());
+  BUSTUB_ASSERT(header_size < PAGE_SIZE, "Too many columns for a PAX page.");
+  size_t row_size = SIZE_ROW + schema.GetLength() + PAX_VARLEN_RESERVE * schema.GetUnlinedColumnCount();
+  auto capacity = static_cast<uint32_t>((PAGE_SIZE - header_size) / row_size);
+  BUSTUB_ASSERT(capacity > 0, "A row does not fit in a PAX page.");
+  return capacity;
+}
+
+Value PaxPage::GetValue(const Schema *schema, uint32_t slot_num, uint32_t column_idx) {
+  BUSTUB_ASSERT(IsVisible(slot_num), "Cannot read a deleted tuple.");
+  const Column &column = schema->GetColumn(column_idx);
+  const char *data = GetColumnData(column_idx) + slot_num * GetColumnWidth(column_idx);
+  if (!column.IsInlined()) {
+    // The offset is relative to the tuple, whose payload starts after its fixed-size part.
+    uint32_t offset = *reinterpret_cast<const uint32_t *>(data);
+    data = GetData() + GetVarlenOffset(slot_num) + offset - GetFixedLength();
+  }
+  return Value::DeserializeFrom(data, column.GetType());
+}
+
+bool PaxPage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
+                          LogManager *log_manager) {
+  BUSTUB_ASSERT(tuple.size_ >= GetFixedLength() && tuple.size_ > 0, "The tuple does not match the columns.");
+  // If there is no free row or not enough space for the payload, then return false.
+  uint32_t slot_num = FindFreeRow();
+  if (slot_num == GetCapacity() || GetFreeSpaceRemaining() < tuple.size_ - GetFixedLength()) {
+    return false;
+  }
+
+  WriteRow(slot_num, tuple);
+  rid->Set(GetTablePageId(), slot_num);
+  if (slot_num == GetTupleCount()) {
+    SetTupleCount(GetTupleCount() + 1);
+  }
+
+  // Write the log record.
+  if (enable_logging) {
+    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
+    // Acquire an exclusive lock on the new tuple.
+    bool locked = lock_manager->LockExclusive(txn, *rid);
+    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return true;
+}
+
+size_t PaxPage::BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids,
+                                 Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t tuple_count = GetTupleCount();
+  size_t end = begin;
+  for (; end < tuples.size() && tuple_count < GetCapacity(); end++) {
+    const Tuple &tuple = tuples[end];
+    BUSTUB_ASSERT(tuple.size_ >= GetFixedLength() && tuple.size_ > 0, "The tuple does not match the columns.");
+    if (GetFreeSpaceRemaining() < tuple.size_ - GetFixedLength()) {
+      break;
+    }
+    WriteRow(tuple_count, tuple);
+    rids->emplace_back(GetTablePageId(), tuple_count);
+    tuple_count++;
+  }
+  SetTupleCount(tuple_count);
+
+  // Write one log record for the whole batch.
+  if (enable_logging && end > begin) {
+    for (auto rid = rids->end() - (end - begin); rid != rids->end(); ++rid) {
+      bool locked = lock_manager->LockExclusive(txn, *rid);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT, GetTablePageId(),
+                         std::vector<Tuple>(tuples.begin() + begin, tuples.begin() + end));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return end;
+}
+
+bool PaxPage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot number is invalid, abort the transaction.
+  if (slot_num >= GetTupleCount()) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  uint32_t tuple_size = GetRowSize(slot_num);
+  // If the tuple is already deleted, abort the transaction.
+  if (IsDeleted(tuple_size)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (enable_logging) {
+    // Acquire an exclusive lock, upgrading from a shared lock if necessary.
+    if (txn->IsSharedLocked(rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid)) {
+        return false;
+      }
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+      return false;
+    }
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  // Mark the tuple as deleted.
+  SetRowSize(slot_num, SetDeletedFlag(tuple_size));
+  return true;
+}
+
+bool PaxPage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager) {
+  BUSTUB_ASSERT(new_tuple.size_ >= GetFixedLength() && new_tuple.size_ > 0, "The tuple does not match the columns.");
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the slot number is invalid, abort the transaction.
+  if (slot_num >= GetTupleCount()) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  // If the tuple is deleted, abort the transaction.
+  if (IsDeleted(GetRowSize(slot_num))) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  // If there is not enough space for the new payload, we need to update via delete followed by an insert.
+  if (GetFreeSpaceRemaining() + GetVarlenSize(slot_num) < new_tuple.size_ - GetFixedLength()) {
+    return false;
+  }
+
+  // Copy out the old value.
+  GetTuple(rid, old_tuple, txn, nullptr);
+
+  if (enable_logging) {
+    // Acquire an exclusive lock, upgrading from shared if necessary.
+    if (txn->IsSharedLocked(rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid)) {
+        return false;
+      }
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+      return false;
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  // Perform the update.
+  FreeVarlen(slot_num);
+  WriteRow(slot_num, new_tuple);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+
+  // We need to copy out the deleted tuple for undo purposes.
+  Tuple delete_tuple;
+  if (enable_logging || deleted_tuple != nullptr) {
+    // Unset the deleted flag for a moment so the tuple can be read back.
+    uint32_t tuple_size = GetRowSize(slot_num);
+    SetRowSize(slot_num, UnsetDeletedFlag(tuple_size));
+    GetTuple(rid, &delete_tuple, txn, nullptr);
+    SetRowSize(slot_num, tuple_size);
+  }
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = delete_tuple;
+  }
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
+
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  FreeVarlen(slot_num);
+  SetRowSize(slot_num, 0);
+  SetVarlenOffset(slot_num, 0);
+}
+
+void PaxPage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+  // Log the rollback.
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  SetRowSize(slot_num, UnsetDeletedFlag(GetRowSize(slot_num)));
+}
+
+bool PaxPage::Compact() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetRowSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+
+  // Move the payloads stored last first, so none is overwritten before it moves.
+  std::vector<uint32_t> slots;
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetVarlenSize(i) != 0) {
+      slots.push_back(i);
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [this](uint32_t a, uint32_t b) { return GetVarlenOffset(a) > GetVarlenOffset(b); });
+  uint32_t free_space_pointer = PAGE_SIZE;
+  for (uint32_t slot_num : slots) {
+    uint32_t varlen_size = GetVarlenSize(slot_num);
+    free_space_pointer -= varlen_size;
+    memmove(GetData() + free_space_pointer, GetData() + GetVarlenOffset(slot_num), varlen_size);
+    SetVarlenOffset(slot_num, free_space_pointer);
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  return tuple_count == 0;
+}
+
+bool PaxPage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+  if (!LockRow(rid, txn, lock_manager)) {
+    return false;
+  }
+  uint32_t slot_num = rid.GetSlotNum();
+  uint32_t tuple_size = GetRowSize(slot_num);
+
+  // Gather the columns and the payload into the tuple.
+  tuple->size_ = tuple_size;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[tuple->size_];
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    uint32_t width = GetColumnWidth(i);
+    memcpy(tuple->data_ + offset, GetColumnData(i) + slot_num * width, width);
+    offset += width;
+  }
+  memcpy(tuple->data_ + offset, GetData() + GetVarlenOffset(slot_num), tuple_size - offset);
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  return true;
+}
+
+bool PaxPage::GetValues(const Schema *schema, const RID &rid, const std::vector<uint32_t> &column_idxs,
+                        std::vector<Value> *values, Transaction *txn, LockManager *lock_manager) {
+  if (!LockRow(rid, txn, lock_manager)) {
+    return false;
+  }
+  values->clear();
+  values->reserve(column_idxs.size());
+  for (uint32_t column_idx : column_idxs) {
+    values->push_back(GetValue(schema, rid.GetSlotNum(), column_idx));
+  }
+  return true;
+}
+
+bool PaxPage::LockRow(const RID &rid, Transaction *txn, LockManager *lock_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If somehow we have more slots than tuples, abort the transaction.
+  if (slot_num >= GetTupleCount()) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+  // If the tuple is deleted, abort the transaction.
+  if (IsDeleted(GetRowSize(slot_num))) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  // Otherwise we have a valid tuple, try to acquire at least a shared lock.
+  if (enable_logging && lock_manager != nullptr) {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PaxPage::GetFirstTupleRid(RID *first_rid) {
+  // Find and return the first valid tuple.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (!IsDeleted(GetRowSize(i))) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
+  BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  // Find and return the first valid tuple after our current slot number.
+  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
+    if (!IsDeleted(GetRowSize(i))) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  // Otherwise return false as there are no more tuples.
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+uint32_t PaxPage::GetInsertableSize() {
+  if (FindFreeRow() == GetCapacity()) {
+    return 0;
+  }
+  return GetFixedLength() + GetFreeSpaceRemaining();
+}
+
+uint32_t PaxPage::FindFreeRow() {
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetRowSize(i) == 0) {
+      return i;
+    }
+  }
+  return tuple_count;
+}
+
+void PaxPage::WriteRow(uint32_t slot_num, const Tuple &tuple) {
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < GetColumnCount(); i++) {
+    uint32_t width = GetColumnWidth(i);
+    memcpy(GetData() + GetColumnOffset(i) + slot_num * width, tuple.data_ + offset, width);
+    offset += width;
+  }
+  uint32_t varlen_size = tuple.size_ - offset;
+  uint32_t varlen_offset = 0;
+  if (varlen_size > 0) {
+    SetFreeSpacePointer(GetFreeSpacePointer() - varlen_size);
+    varlen_offset = GetFreeSpacePointer();
+    memcpy(GetData() + varlen_offset, tuple.data_ + offset, varlen_size);
+  }
+  SetVarlenOffset(slot_num, varlen_offset);
+  SetRowSize(slot_num, tuple.size_);
+}
+
+void PaxPage::FreeVarlen(uint32_t slot_num) {
+  uint32_t varlen_size = GetVarlenSize(slot_num);
+  if (varlen_size == 0) {
+    return;
+  }
+  uint32_t varlen_offset = GetVarlenOffset(slot_num);
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  BUSTUB_ASSERT(varlen_offset >= free_space_pointer, "Free space appears before payloads.");
+  memmove(GetData() + free_space_pointer + varlen_size, GetData() + free_space_pointer,
+          varlen_offset - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer + varlen_size);
+  SetVarlenOffset(slot_num, 0);
+
+  // Update the offsets of the payloads that moved.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (GetVarlenSize(i) != 0 && i != slot_num && GetVarlenOffset(i) < varlen_offset) {
+      SetVarlenOffset(i, GetVarlenOffset(i) + varlen_size);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -12,7 +12,9 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 namespace bustub {
 
@@ -85,6 +87,41 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
   return true;
 }
 
+size_t TablePage::BulkInsertTuples(const std::vector<Tuple> &tuples, size_t begin, std::vector<RID> *rids,
+                                   Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  uint32_t tuple_count = GetTupleCount();
+  uint32_t free_space = GetFreeSpaceRemaining();
+  size_t end = begin;
+  for (; end < tuples.size() && free_space >= tuples[end].size_ + SIZE_TUPLE; end++) {
+    const Tuple &tuple = tuples[end];
+    BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+    free_space -= tuple.size_ + SIZE_TUPLE;
+    free_space_pointer -= tuple.size_;
+    memcpy(GetData() + free_space_pointer, tuple.data_, tuple.size_);
+    SetTupleOffsetAtSlot(tuple_count, free_space_pointer);
+    SetTupleSize(tuple_count, tuple.size_);
+    rids->emplace_back(GetTablePageId(), tuple_count);
+    tuple_count++;
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetTupleCount(tuple_count);
+
+  // Write one log record for the whole batch.
+  if (enable_logging && end > begin) {
+    for (auto rid = rids->end() - (end - begin); rid != rids->end(); ++rid) {
+      bool locked = lock_manager->LockExclusive(txn, *rid);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT, GetTablePageId(),
+                         std::vector<Tuple>(tuples.begin() + begin, tuples.begin() + end));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return end;
+}
+
 bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
@@ -197,7 +234,7 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -226,6 +263,10 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
     txn->SetPrevLSN(lsn);
   }
 
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = delete_tuple;
+  }
+
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
 
@@ -265,7 +306,51 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
+bool TablePage::Compact() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+
+  // Move the tuples stored last first, so none is overwritten before it moves.
+  std::vector<uint32_t> slots;
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    if (GetTupleSize(i) != 0) {
+      slots.push_back(i);
+    }
+  }
+  std::sort(slots.begin(), slots.end(),
+            [this](uint32_t a, uint32_t b) { return GetTupleOffsetAtSlot(a) > GetTupleOffsetAtSlot(b); });
+  uint32_t free_space_pointer = PAGE_SIZE;
+  for (uint32_t slot_num : slots) {
+    uint32_t tuple_size = UnsetDeletedFlag(GetTupleSize(slot_num));
+    free_space_pointer -= tuple_size;
+    memmove(GetData() + free_space_pointer, GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size);
+    SetTupleOffsetAtSlot(slot_num, free_space_pointer);
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  return tuple_count == 0;
+}
+
 bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+  Tuple view;
+  if (!GetTupleView(rid, &view, txn, lock_manager)) {
+    return false;
+  }
+  // Copy the tuple data into our result.
+  tuple->size_ = view.size_;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[tuple->size_];
+  memcpy(tuple->data_, view.data_, tuple->size_);
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  return true;
+}
+
+bool TablePage::GetTupleView(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
@@ -292,16 +377,14 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
     }
   }
 
-  // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
+  // At this point, we have at least a shared lock on the RID. Point the result at the tuple data.
   if (tuple->allocated_) {
     delete[] tuple->data_;
   }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
+  tuple->size_ = tuple_size;
+  tuple->data_ = GetData() + GetTupleOffsetAtSlot(slot_num);
   tuple->rid_ = rid;
-  tuple->allocated_ = true;
+  tuple->allocated_ = false;
   return true;
 }
 
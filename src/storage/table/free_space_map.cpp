@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t insertable_size) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto iter = positions_.find(page_id);
+  if (iter == positions_.end()) {
+    Add(page_id, ToCategory(insertable_size), false);
+    return;
+  }
+  categories_[iter->second] = ToCategory(insertable_size);
+  UpdateLeaf(iter->second);
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t tuple_size) {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t position;
+  return FindPosition(tuple_size, &position);
+}
+
+page_id_t FreeSpaceMap::Claim(uint32_t tuple_size) {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t position;
+  page_id_t page_id = FindPosition(tuple_size, &position);
+  if (page_id != INVALID_PAGE_ID) {
+    claimed_[position] = true;
+    UpdateLeaf(position);
+  }
+  return page_id;
+}
+
+void FreeSpaceMap::AddClaimed(page_id_t page_id, uint32_t insertable_size) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Add(page_id, ToCategory(insertable_size), true);
+}
+
+void FreeSpaceMap::Release(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto iter = positions_.find(page_id);
+  if (iter != positions_.end()) {
+    claimed_[iter->second] = false;
+    UpdateLeaf(iter->second);
+  }
+}
+
+void FreeSpaceMap::Remove(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto iter = positions_.find(page_id);
+  if (iter == positions_.end()) {
+    return;
+  }
+  size_t position = iter->second;
+  positions_.erase(iter);
+  pages_[position] = INVALID_PAGE_ID;
+  categories_[position] = 0;
+  claimed_[position] = false;
+  UpdateLeaf(position);
+  free_positions_.push_back(position);
+}
+
+size_t FreeSpaceMap::GetNumPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return positions_.size();
+}
+
+uint8_t FreeSpaceMap::ToCategory(uint32_t insertable_size) {
+  return static_cast<uint8_t>(std::min<uint32_t>(insertable_size / FSM_CATEGORY_SIZE, UINT8_MAX));
+}
+
+uint32_t FreeSpaceMap::ToNeededCategory(uint32_t tuple_size) {
+  return (tuple_size + FSM_CATEGORY_SIZE - 1) / FSM_CATEGORY_SIZE;
+}
+
+void FreeSpaceMap::Add(page_id_t page_id, uint8_t category, bool claimed) {
+  if (!free_positions_.empty()) {
+    size_t position = free_positions_.back();
+    free_positions_.pop_back();
+    positions_[page_id] = position;
+    pages_[position] = page_id;
+    categories_[position] = category;
+    claimed_[position] = claimed;
+    UpdateLeaf(position);
+    return;
+  }
+  if (pages_.size() == capacity_) {
+    // double the tree, the old leaves move to the start of the new ones
+    size_t old_capacity = capacity_;
+    capacity_ = std::max<size_t>(2 * capacity_, 16);
+    std::vector<uint8_t> tree(2 * capacity_, 0);
+    std::copy(tree_.begin() + old_capacity, tree_.end(), tree.begin() + capacity_);
+    tree_ = std::move(tree);
+    for (size_t i = capacity_ - 1; i > 0; i--) {
+      tree_[i] = std::max(tree_[2 * i], tree_[2 * i + 1]);
+    }
+  }
+  positions_[page_id] = pages_.size();
+  pages_.push_back(page_id);
+  categories_.push_back(category);
+  claimed_.push_back(claimed);
+  UpdateLeaf(pages_.size() - 1);
+}
+
+page_id_t FreeSpaceMap::FindPosition(uint32_t tuple_size, size_t *position) {
+  uint32_t needed = ToNeededCategory(tuple_size);
+  if (capacity_ == 0 || tree_[1] < needed) {
+    return INVALID_PAGE_ID;
+  }
+  size_t node = 1;
+  while (node < capacity_) {
+    node = tree_[2 * node] >= needed ? 2 * node : 2 * node + 1;
+  }
+  *position = node - capacity_;
+  return pages_[*position];
+}
+
+void FreeSpaceMap::UpdateLeaf(size_t position) {
+  size_t node = capacity_ + position;
+  tree_[node] = claimed_[position] ? 0 : categories_[position];
+  for (node /= 2; node > 0; node /= 2) {
+    tree_[node] = std::max(tree_[2 * node], tree_[2 * node + 1]);
+  }
+}
+
+}  // namespace bustub
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <numeric>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -18,83 +21,198 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, TableFormat format, const Schema *schema)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      format_(format),
+      last_page_id_(first_page_id) {
+  if (format_ == TableFormat::PAX) {
+    // New pages get the layout of the first one.
+    auto first_page = static_cast<PaxPage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+    first_page->RLatch();
+    for (uint32_t i = 0; i < first_page->GetColumnCount(); i++) {
+      pax_column_widths_.push_back(first_page->GetColumnWidth(i));
+    }
+    pax_capacity_ = first_page->GetCapacity();
+    first_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  } else if (format_ == TableFormat::COMPRESSED) {
+    auto first_page = static_cast<CompressedPage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+    first_page->RLatch();
+    for (uint32_t i = 0; i < first_page->GetColumnCount(); i++) {
+      column_types_.push_back(first_page->GetColumnType(i));
+    }
+    first_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  } else if (schema != nullptr) {
+    varlen_columns_ = VarlenColumns(*schema);
+  }
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, TableFormat format, const Schema *schema)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      format_(format) {
+  if (format_ == TableFormat::PAX) {
+    BUSTUB_ASSERT(schema != nullptr, "A PAX table needs the schema of its tuples.");
+    pax_column_widths_ = PaxPage::ColumnWidths(*schema);
+    pax_capacity_ = PaxPage::ComputeCapacity(*schema);
+  } else if (format_ == TableFormat::COMPRESSED) {
+    BUSTUB_ASSERT(schema != nullptr, "A compressed table needs the schema of its tuples.");
+    column_types_ = CompressedPage::ColumnTypes(*schema);
+  } else if (schema != nullptr) {
+    varlen_columns_ = VarlenColumns(*schema);
+  }
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = buffer_pool_manager_->NewPage(&first_page_id_);
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  InitPage(first_page, first_page_id_, INVALID_LSN, txn);
+  UpdateFreeSpace(first_page);
+  last_page_id_ = first_page_id_;
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  // Large values go to overflow pages first, they are freed again if the insert fails.
+  Tuple toasted;
+  const Tuple *stored = Toast(tuple, &toasted);
+  auto abort = [&]() {
+    ReleaseOverflowPages(toasted);
     txn->SetState(TransactionState::ABORTED);
     return false;
+  };
+  if (stored == nullptr || stored->size_ + 32 > PAGE_SIZE) {  // larger than one page size
+    return abort();
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  // The free space map may be behind the page, then the insert fails and the
+  // map is corrected, so the next page it picks is a different one.
+  InsertTarget *target = GetInsertTarget();
+  while (true) {
+    page_id_t page_id = target->page_id_.load();
+    uint32_t new_page_size = 0;
+    if (page_id == INVALID_PAGE_ID) {
+      page_id = ClaimOrAppendPage(stored->size_, txn, &new_page_size);
+      if (page_id == INVALID_PAGE_ID) {
+        return abort();
+      }
+      // a thread sharing the target may have set it first
+      page_id_t expected = INVALID_PAGE_ID;
+      if (!target->page_id_.compare_exchange_strong(expected, page_id)) {
+        free_space_map_.Release(page_id);
+        continue;
+      }
+    }
+    auto cur_page = buffer_pool_manager_->FetchPage(page_id);
+    if (cur_page == nullptr) {
+      return abort();
+    }
+    cur_page->WLatch();
+    bool inserted = WithPage(cur_page, [&](auto *table_page) {
+      return table_page->InsertTuple(*stored, rid, txn, lock_manager_, log_manager_);
+    });
+    UpdateFreeSpace(cur_page);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      break;
+    }
+    // hand the page back for smaller tuples
+    if (target->page_id_.compare_exchange_strong(page_id, INVALID_PAGE_ID)) {
+      free_space_map_.Release(page_id);
+    }
+    // An encoded tuple may not fit even in an empty page.
+    if (stored->size_ > new_page_size && new_page_size > 0) {
+      return abort();
+    }
+  }
+  // Update the transaction's write set.
+  LOG_DEBUG("InsertSet rid %s", rid->ToString().c_str());
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
+
+bool TableHeap::BulkInsert(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) {
+  // Large values go to overflow pages first, the batch is only copied then.
+  std::vector<Tuple> toasted_tuples;
+  const std::vector<Tuple> *stored = &tuples;
+  if (!varlen_columns_.empty() && std::any_of(tuples.begin(), tuples.end(), [](const Tuple &tuple) {
+        return tuple.size_ > static_cast<uint32_t>(TOAST_TUPLE_THRESHOLD);
+      })) {
+    toasted_tuples.reserve(tuples.size());
+    for (const auto &tuple : tuples) {
+      Tuple toasted;
+      const Tuple *stored_tuple = Toast(tuple, &toasted);
+      if (stored_tuple == nullptr) {
+        break;
+      }
+      toasted_tuples.push_back(*stored_tuple);
+    }
+    stored = &toasted_tuples;
+  }
+  auto abort = [&](size_t begin) {
+    for (size_t i = begin; i < toasted_tuples.size(); i++) {
+      ReleaseOverflowPages(toasted_tuples[i]);
+    }
     txn->SetState(TransactionState::ABORTED);
     return false;
+  };
+  if (stored->size() < tuples.size()) {
+    return abort(0);
+  }
+  for (const auto &tuple : *stored) {
+    if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+      return abort(0);
+    }
+  }
+  if (tuples.empty()) {
+    return true;
   }
 
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
-    }
-  }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
-  cur_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  // The batch goes to the end of the table: the rest of the last page, then
+  // new pages, which the other inserts only find once they are full.
+  size_t first_rid = rids->size();
+  std::unique_lock<std::mutex> guard(append_latch_);
+  auto page = LatchLastPage();
+  size_t next = 0;
+  bool appended = false;
+  while (page != nullptr) {
+    size_t begin = next;
+    next = WithPage(page, [&](auto *table_page) {
+      return table_page->BulkInsertTuples(*stored, next, rids, txn, lock_manager_, log_manager_);
+    });
+    UpdateFreeSpace(page);
+    // An encoded tuple may not fit even in an empty page.
+    if (next == tuples.size() || (appended && next == begin)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(last_page_id_, true);
+      break;
+    }
+    page = AppendPage(page, txn);
+    appended = true;
+  }
+  guard.unlock();
   // Update the transaction's write set.
-  LOG_DEBUG("InsertSet rid %s", rid->ToString().c_str());
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  for (auto rid = rids->begin() + first_rid; rid != rids->end(); ++rid) {
+    txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  }
+  if (next < tuples.size()) {
+    return abort(next);
+  }
   return true;
 }
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
-  // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -102,9 +220,10 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  WithPage(page, [&](auto *table_page) { return table_page->MarkDelete(rid, txn, lock_manager_, log_manager_); });
+  UpdateFreeSpace(page);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
@@ -112,51 +231,74 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  Tuple toasted;
+  const Tuple *stored = Toast(tuple, &toasted);
+  if (stored == nullptr) {
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  bool is_updated = WithPage(page, [&](auto *table_page) {
+    return table_page->UpdateTuple(*stored, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  });
+  UpdateFreeSpace(page);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
-  // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), is_updated);
+  if (!is_updated) {
+    ReleaseOverflowPages(toasted);
+    return false;
+  }
+  // Update the transaction's write set. The overflow pages of the old tuple
+  // are freed on commit, or right away when this update is a rollback.
+  if (txn->GetState() != TransactionState::ABORTED) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  } else {
+    ReleaseOverflowPages(old_tuple);
   }
-  return is_updated;
+  return true;
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
-  // Delete the tuple from the page.
+  // Delete the tuple from the page, keeping it when it may have values in overflow pages.
+  Tuple deleted_tuple;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  WithPage(page, [&](auto *table_page) {
+    table_page->ApplyDelete(rid, txn, log_manager_, varlen_columns_.empty() ? nullptr : &deleted_tuple);
+  });
   lock_manager_->Unlock(txn, rid);
+  UpdateFreeSpace(page);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  ReleaseOverflowPages(deleted_tuple);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  WithPage(page, [&](auto *table_page) { table_page->RollbackDelete(rid, txn, log_manager_); });
+  UpdateFreeSpace(page);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -164,32 +306,310 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   }
   // Read the tuple from the page.
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res = WithPage(page, [&](auto *table_page) { return table_page->GetTuple(rid, tuple, txn, lock_manager_); });
+  tuple->buffer_pool_manager_ = buffer_pool_manager_;
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
 }
 
+bool TableHeap::GetValuesOnPage(Page *page, const RID &rid, Transaction *txn, const Schema *schema,
+                                const std::vector<uint32_t> &column_idxs, std::vector<Value> *values) {
+  if (format_ == TableFormat::PAX) {
+    page->RLatch();
+    bool res = static_cast<PaxPage *>(page)->GetValues(schema, rid, column_idxs, values, txn, lock_manager_);
+    page->RUnlatch();
+    return res;
+  }
+  return ViewTupleOnPage(page, rid, txn, [&](const Tuple &view) {
+    values->clear();
+    values->reserve(column_idxs.size());
+    for (uint32_t column_idx : column_idxs) {
+      values->push_back(view.GetValue(schema, column_idx));
+    }
+  });
+}
+
+size_t TableHeap::Vacuum() {
+  std::lock_guard<std::mutex> guard(append_latch_);
+  // Empty pages may be freed, so the insert targets start over.
+  for (auto &target : insert_targets_) {
+    page_id_t page_id = target.page_id_.exchange(INVALID_PAGE_ID);
+    if (page_id != INVALID_PAGE_ID) {
+      free_space_map_.Release(page_id);
+    }
+  }
+
+  auto prev_page = buffer_pool_manager_->FetchPage(first_page_id_);
+  if (prev_page == nullptr) {
+    return 0;
+  }
+  auto compact = [](auto *table_page) { return table_page->Compact(); };
+  prev_page->WLatch();
+  WithPage(prev_page, compact);
+  UpdateFreeSpace(prev_page);
+  size_t num_freed = 0;
+  // Walk the list holding the last page kept, which links past the freed ones.
+  while (GetNextPageId(prev_page) != INVALID_PAGE_ID) {
+    page_id_t page_id = GetNextPageId(prev_page);
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      break;
+    }
+    page->WLatch();
+    bool is_empty = WithPage(page, compact);
+    page_id_t next_page_id = GetNextPageId(page);
+    Page *next_page = nullptr;
+    if (is_empty && next_page_id != INVALID_PAGE_ID) {
+      next_page = buffer_pool_manager_->FetchPage(next_page_id);
+      // keep the page if its neighbour cannot be relinked
+      is_empty = next_page != nullptr;
+    }
+    if (!is_empty) {
+      UpdateFreeSpace(page);
+      prev_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      prev_page = page;
+      continue;
+    }
+
+    WithPage(prev_page, [&](auto *table_page) { table_page->SetNextPageId(next_page_id); });
+    if (next_page != nullptr) {
+      next_page->WLatch();
+      WithPage(next_page, [&](auto *table_page) { table_page->SetPrevPageId(prev_page->GetPageId()); });
+      next_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    free_space_map_.Remove(page_id);
+    if (last_page_id_ == page_id) {
+      last_page_id_ = prev_page->GetPageId();
+    }
+    buffer_pool_manager_->DeletePage(page_id);
+    num_freed++;
+  }
+  // Every page kept was added to the free space map on the way.
+  if (GetNextPageId(prev_page) == INVALID_PAGE_ID) {
+    last_page_id_ = prev_page->GetPageId();
+  }
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  return num_freed;
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = buffer_pool_manager_->FetchPage(page_id);
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = WithPage(page, [&](auto *table_page) { return table_page->GetFirstTupleRid(&rid); });
+    page_id_t next_page_id = GetNextPageId(page);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
   return TableIterator(this, rid, txn);
 }
 
+TableHeap::InsertTarget *TableHeap::GetInsertTarget() {
+  static std::atomic<size_t> next_slot{0};
+  thread_local size_t slot = next_slot++ % INSERT_TARGET_SLOTS;
+  return &insert_targets_[slot];
+}
+
+page_id_t TableHeap::ClaimOrAppendPage(uint32_t tuple_size, Transaction *txn, uint32_t *new_page_size) {
+  *new_page_size = 0;
+  page_id_t page_id = free_space_map_.Claim(tuple_size);
+  if (page_id != INVALID_PAGE_ID) {
+    return page_id;
+  }
+
+  std::lock_guard<std::mutex> guard(append_latch_);
+  auto last_page = LatchLastPage();
+  if (last_page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  // Another insert may have appended a page while this one waited.
+  page_id = free_space_map_.Claim(tuple_size);
+  if (page_id != INVALID_PAGE_ID) {
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    return page_id;
+  }
+  auto new_page = AppendPage(last_page, txn);
+  if (new_page == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  *new_page_size = WithPage(new_page, [](auto *table_page) { return table_page->GetInsertableSize(); });
+  free_space_map_.AddClaimed(last_page_id_, *new_page_size);
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  return last_page_id_;
+}
+
+Page *TableHeap::LatchLastPage() {
+  // Walk the pages the map does not know yet: the rest of an opened table,
+  // or pages appended behind its back (e.g. by recovery).
+  auto last_page = buffer_pool_manager_->FetchPage(last_page_id_);
+  if (last_page == nullptr) {
+    return nullptr;
+  }
+  last_page->WLatch();
+  UpdateFreeSpace(last_page);
+  while (GetNextPageId(last_page) != INVALID_PAGE_ID) {
+    page_id_t next_page_id = GetNextPageId(last_page);
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    last_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (last_page == nullptr) {
+      return nullptr;
+    }
+    last_page_id_ = next_page_id;
+    last_page->WLatch();
+    UpdateFreeSpace(last_page);
+  }
+  return last_page;
+}
+
+Page *TableHeap::AppendPage(Page *last_page, Transaction *txn) {
+  page_id_t page_id;
+  auto new_page = buffer_pool_manager_->NewPage(&page_id);
+  if (new_page == nullptr) {
+    // the caller may have changed last_page
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, true);
+    return nullptr;
+  }
+  new_page->WLatch();
+  WithPage(last_page, [&](auto *table_page) { table_page->SetNextPageId(page_id); });
+  InitPage(new_page, page_id, last_page_id_, txn);
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);
+  last_page_id_ = page_id;
+  return new_page;
+}
+
+void TableHeap::InitPage(Page *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn) {
+  if (format_ == TableFormat::PAX) {
+    static_cast<PaxPage *>(page)->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn, pax_column_widths_,
+                                       pax_capacity_);
+    return;
+  }
+  if (format_ == TableFormat::COMPRESSED) {
+    static_cast<CompressedPage *>(page)->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn, column_types_);
+    return;
+  }
+  static_cast<TablePage *>(page)->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn);
+}
+
+std::vector<uint32_t> TableHeap::VarlenColumns(const Schema &schema) {
+  std::vector<uint32_t> varlen_columns;
+  for (auto column_idx : schema.GetUnlinedColumns()) {
+    varlen_columns.push_back(schema.GetColumn(column_idx).GetOffset());
+  }
+  return varlen_columns;
+}
+
+const Tuple *TableHeap::Toast(const Tuple &tuple, Tuple *toasted) {
+  if (varlen_columns_.empty() || tuple.size_ <= static_cast<uint32_t>(TOAST_TUPLE_THRESHOLD)) {
+    return &tuple;
+  }
+  // Pick the values to move, largest first, until the tuple is small enough.
+  std::vector<uint32_t> payload_sizes;
+  for (auto column_offset : varlen_columns_) {
+    const char *payload = tuple.data_ + *reinterpret_cast<const uint32_t *>(tuple.data_ + column_offset);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(payload);
+    bool is_inline = len != BUSTUB_VALUE_NULL && (len & Tuple::EXTERNAL_FLAG) == 0;
+    payload_sizes.push_back(is_inline ? sizeof(uint32_t) + len : 0);
+  }
+  std::vector<size_t> order(varlen_columns_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return payload_sizes[a] > payload_sizes[b]; });
+  std::vector<bool> moved(varlen_columns_.size(), false);
+  uint32_t size = tuple.size_;
+  for (auto i : order) {
+    if (size <= static_cast<uint32_t>(TOAST_TUPLE_THRESHOLD) || payload_sizes[i] <= EXTERNAL_PAYLOAD_SIZE) {
+      break;
+    }
+    moved[i] = true;
+    size -= payload_sizes[i] - EXTERNAL_PAYLOAD_SIZE;
+  }
+
+  // Rebuild the tuple, the payloads keep the order of the columns.
+  uint32_t fixed_length = tuple.size_;
+  for (auto column_offset : varlen_columns_) {
+    fixed_length = std::min(fixed_length, *reinterpret_cast<const uint32_t *>(tuple.data_ + column_offset));
+  }
+  std::vector<char> data(size);
+  memcpy(data.data(), tuple.data_, fixed_length);
+  uint32_t offset = fixed_length;
+  std::vector<page_id_t> chains;
+  for (size_t i = 0; i < varlen_columns_.size(); i++) {
+    const char *payload = tuple.data_ + *reinterpret_cast<const uint32_t *>(tuple.data_ + varlen_columns_[i]);
+    memcpy(data.data() + varlen_columns_[i], &offset, sizeof(uint32_t));
+    if (!moved[i]) {
+      uint32_t len = *reinterpret_cast<const uint32_t *>(payload);
+      uint32_t payload_size = len == BUSTUB_VALUE_NULL ? sizeof(uint32_t)
+                              : (len & Tuple::EXTERNAL_FLAG) != 0 ? EXTERNAL_PAYLOAD_SIZE
+                                                                  : sizeof(uint32_t) + len;
+      memcpy(data.data() + offset, payload, payload_size);
+      offset += payload_size;
+      continue;
+    }
+    uint32_t len = payload_sizes[i] - sizeof(uint32_t);
+    page_id_t first_page_id = OverflowPage::WriteChain(buffer_pool_manager_, payload + sizeof(uint32_t), len);
+    if (first_page_id == INVALID_PAGE_ID) {
+      for (auto chain : chains) {
+        OverflowPage::DeleteChain(buffer_pool_manager_, chain);
+      }
+      return nullptr;
+    }
+    chains.push_back(first_page_id);
+    len |= Tuple::EXTERNAL_FLAG;
+    memcpy(data.data() + offset, &len, sizeof(uint32_t));
+    memcpy(data.data() + offset + sizeof(uint32_t), &first_page_id, sizeof(page_id_t));
+    offset += EXTERNAL_PAYLOAD_SIZE;
+  }
+  BUSTUB_ASSERT(offset == size, "The toasted tuple does not have the expected size.");
+
+  if (toasted->allocated_) {
+    delete[] toasted->data_;
+  }
+  toasted->allocated_ = true;
+  toasted->rid_ = tuple.rid_;
+  toasted->size_ = size;
+  toasted->data_ = new char[size];
+  memcpy(toasted->data_, data.data(), size);
+  return toasted;
+}
+
+void TableHeap::ReleaseOverflowPages(const Tuple &tuple) {
+  if (tuple.data_ == nullptr) {
+    return;
+  }
+  for (auto column_offset : varlen_columns_) {
+    const char *payload = tuple.data_ + *reinterpret_cast<const uint32_t *>(tuple.data_ + column_offset);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(payload);
+    if (len != BUSTUB_VALUE_NULL && (len & Tuple::EXTERNAL_FLAG) != 0) {
+      OverflowPage::DeleteChain(buffer_pool_manager_,
+                                *reinterpret_cast<const page_id_t *>(payload + sizeof(uint32_t)));
+    }
+  }
+}
+
+void TableHeap::UpdateFreeSpace(Page *page) {
+  free_space_map_.Update(page->GetPageId(),
+                         WithPage(page, [](auto *table_page) { return table_page->GetInsertableSize(); }));
+}
+
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
 }  // namespace bustub
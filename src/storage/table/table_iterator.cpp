@@ -17,50 +17,53 @@
 namespace bustub {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
-  if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
-  }
-}
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {}
 
 const Tuple &TableIterator::operator*() {
   assert(*this != table_heap_->End());
+  Load();
   return *tuple_;
 }
 
 Tuple *TableIterator::operator->() {
   assert(*this != table_heap_->End());
+  Load();
   return tuple_;
 }
 
+void TableIterator::Load() {
+  if (!loaded_) {
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    loaded_ = true;
+  }
+}
+
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId());
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+  if (!table_heap_->WithPage(cur_page, [&](auto *table_page) {
+        return table_page->GetNextTupleRid(tuple_->rid_, &next_tuple_rid);
+      })) {  // end of this page
+    while (table_heap_->GetNextPageId(cur_page) != INVALID_PAGE_ID) {
+      auto next_page = buffer_pool_manager->FetchPage(table_heap_->GetNextPageId(cur_page));
       cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+      if (table_heap_->WithPage(cur_page,
+                                [&](auto *table_page) { return table_page->GetFirstTupleRid(&next_tuple_rid); })) {
         break;
       }
     }
   }
   tuple_->rid_ = next_tuple_rid;
-
-  if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
-  }
-  // release until copy the tuple
+  loaded_ = false;
   cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
   return *this;
 }
 
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_scan_cursor.cpp
+//
+// Identification: src/storage/table/table_scan_cursor.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/table_scan_cursor.h"
+
+namespace bustub {
+
+TableScanCursor::TableScanCursor(TableHeap *table_heap, Transaction *txn, const Schema *schema)
+    : table_heap_(table_heap), txn_(txn), schema_(schema), rid_(INVALID_PAGE_ID, 0) {
+  MoveToPage(table_heap_->GetFirstPageId());
+}
+
+TableScanCursor::~TableScanCursor() { MoveToPage(INVALID_PAGE_ID); }
+
+bool TableScanCursor::Next() {
+  while (page_ != nullptr) {
+    RID next_rid;
+    page_->RLatch();
+    if (!on_page_) {
+      MatchPage();
+    }
+    bool found = table_heap_->WithPage(page_, [&](auto *table_page) {
+      bool res = on_page_ ? table_page->GetNextTupleRid(rid_, &next_rid) : table_page->GetFirstTupleRid(&next_rid);
+      while (res && !Matches(next_rid)) {
+        RID cur_rid = next_rid;
+        res = table_page->GetNextTupleRid(cur_rid, &next_rid);
+      }
+      return res;
+    });
+    page_id_t next_page_id = table_heap_->GetNextPageId(page_);
+    page_->RUnlatch();
+    if (found) {
+      rid_ = next_rid;
+      on_page_ = true;
+      return true;
+    }
+    // end of this page
+    MoveToPage(next_page_id);
+  }
+  rid_.Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+void TableScanCursor::MatchPage() {
+  matches_.clear();
+  if (filter_ && table_heap_->GetFormat() == TableFormat::COMPRESSED) {
+    static_cast<CompressedPage *>(page_)->MatchColumn(filter_column_idx_, filter_, &matches_);
+  } else if (filter_ && schema_ != nullptr && table_heap_->GetFormat() == TableFormat::PAX) {
+    auto pax_page = static_cast<PaxPage *>(page_);
+    matches_.resize(pax_page->GetTupleCount());
+    for (uint32_t slot_num = 0; slot_num < matches_.size(); slot_num++) {
+      matches_[slot_num] =
+          pax_page->IsVisible(slot_num) && filter_(pax_page->GetValue(schema_, slot_num, filter_column_idx_));
+    }
+  }
+}
+
+void TableScanCursor::MoveToPage(page_id_t page_id) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (page_ != nullptr) {
+    buffer_pool_manager->UnpinPage(page_->GetPageId(), false);
+    page_ = nullptr;
+  }
+  on_page_ = false;
+  if (page_id != INVALID_PAGE_ID) {
+    page_ = buffer_pool_manager->FetchPage(page_id);
+    // If the page could not be found, then abort the transaction.
+    if (page_ == nullptr && txn_ != nullptr) {
+      txn_->SetState(TransactionState::ABORTED);
+    }
+  }
+}
+
+}  // namespace bustub
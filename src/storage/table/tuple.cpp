@@ -16,6 +16,8 @@
 #include <string>
 #include <vector>
 
+#include "common/exception.h"
+#include "storage/page/overflow_page.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -54,7 +56,11 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   }
 }
 
-Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
+Tuple::Tuple(const Tuple &other)
+    : allocated_(other.allocated_),
+      rid_(other.rid_),
+      size_(other.size_),
+      buffer_pool_manager_(other.buffer_pool_manager_) {
   if (allocated_) {
     delete[] data_;
   }
@@ -75,6 +81,7 @@ Tuple &Tuple::operator=(const Tuple &other) {
   allocated_ = other.allocated_;
   rid_ = other.rid_;
   size_ = other.size_;
+  buffer_pool_manager_ = other.buffer_pool_manager_;
 
   if (allocated_) {
     // Deep copy.
@@ -93,10 +100,29 @@ Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const {
   assert(data_);
   const TypeId column_type = schema->GetColumn(column_idx).GetType();
   const char *data_ptr = GetDataPtr(schema, column_idx);
+  if (!schema->GetColumn(column_idx).IsInlined()) {
+    uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+    if (len != BUSTUB_VALUE_NULL && (len & EXTERNAL_FLAG) != 0) {
+      return GetExternalValue(column_type, data_ptr);
+    }
+  }
   // the third parameter "is_inlined" is unused
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
+Value Tuple::GetExternalValue(TypeId column_type, const char *data_ptr) const {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception(ExceptionType::INVALID, "The tuple was not read from a table, its overflow pages are unknown.");
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr) & ~EXTERNAL_FLAG;
+  page_id_t first_page_id = *reinterpret_cast<const page_id_t *>(data_ptr + sizeof(uint32_t));
+  std::vector<char> data(len);
+  if (!OverflowPage::ReadChain(buffer_pool_manager_, first_page_id, data.data(), len)) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't read the overflow pages of a value.");
+  }
+  return Value(column_type, data.data(), len, true);
+}
+
 Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
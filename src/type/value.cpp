@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <cassert>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -18,6 +20,20 @@
 #include "type/value.h"
 
 namespace bustub {
+
+namespace {
+
+// A shared varchar buffer starts with the number of values referencing it.
+using RefCount = std::atomic<uint32_t>;
+constexpr size_t SHARED_HEADER_SIZE = sizeof(uint64_t);
+static_assert(sizeof(RefCount) <= SHARED_HEADER_SIZE);
+
+RefCount *GetRefCount(const char *data) {
+  return reinterpret_cast<RefCount *>(const_cast<char *>(data) - SHARED_HEADER_SIZE);
+}
+
+}  // namespace
+
 Value::Value(const Value &other) {
   type_id_ = other.type_id_;
   size_ = other.size_;
@@ -27,17 +43,13 @@ Value::Value(const Value &other) {
     case TypeId::VARCHAR:
       if (size_.len_ == BUSTUB_VALUE_NULL) {
         value_.varlen_ = nullptr;
-      } else {
-        if (manage_data_) {
-          value_.varlen_ = new char[size_.len_];
-          memcpy(value_.varlen_, other.value_.varlen_, size_.len_);
-        } else {
-          value_ = other.value_;
-        }
+      } else if (manage_data_ && !IsVarlenInlined()) {
+        // share the buffer instead of copying it
+        GetRefCount(value_.varlen_)->fetch_add(1, std::memory_order_relaxed);
       }
       break;
     default:
-      value_ = other.value_;
+      break;
   }
 }
 
@@ -221,10 +233,7 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
         manage_data_ = manage_data;
         if (manage_data_) {
           assert(len < BUSTUB_VARCHAR_MAX_LEN);
-          value_.varlen_ = new char[len];
-          assert(value_.varlen_ != nullptr);
-          size_.len_ = len;
-          memcpy(value_.varlen_, data, len);
+          SetVarlen(data, len);
         } else {
           // FUCK YOU GCC I do what I want.
           value_.const_varlen_ = data;
@@ -242,11 +251,7 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
     case TypeId::VARCHAR: {
       manage_data_ = true;
       // TODO(TAs): How to represent a null string here?
-      uint32_t len = static_cast<uint32_t>(data.length()) + 1;
-      value_.varlen_ = new char[len];
-      assert(value_.varlen_ != nullptr);
-      size_.len_ = len;
-      memcpy(value_.varlen_, data.c_str(), len);
+      SetVarlen(data.c_str(), static_cast<uint32_t>(data.length()) + 1);
       break;
     }
     default:
@@ -259,7 +264,7 @@ Value::~Value() {
   switch (type_id_) {
     case TypeId::VARCHAR:
       if (manage_data_) {
-        delete[] value_.varlen_;
+        ReleaseVarlen();
       }
       break;
     default:
@@ -267,6 +272,40 @@ Value::~Value() {
   }
 }
 
+Value Value::ViewFrom(const char *storage, const TypeId type_id) {
+  if (type_id != TypeId::VARCHAR) {
+    return DeserializeFrom(storage, type_id);
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(storage);
+  if (len == BUSTUB_VALUE_NULL) {
+    return Value(type_id, nullptr, len, false);
+  }
+  return Value(type_id, storage + sizeof(uint32_t), len, false);
+}
+
+void Value::SetVarlen(const char *data, uint32_t len) {
+  size_.len_ = len;
+  if (IsVarlenInlined()) {
+    memcpy(value_.inlined_, data, len);
+    return;
+  }
+  char *buffer = new char[SHARED_HEADER_SIZE + len];
+  new (buffer) RefCount(1);
+  value_.varlen_ = buffer + SHARED_HEADER_SIZE;
+  memcpy(value_.varlen_, data, len);
+}
+
+void Value::ReleaseVarlen() {
+  if (size_.len_ == BUSTUB_VALUE_NULL || IsVarlenInlined()) {
+    return;
+  }
+  RefCount *ref_count = GetRefCount(value_.varlen_);
+  if (ref_count->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ref_count->~RefCount();
+    delete[](value_.varlen_ - SHARED_HEADER_SIZE);
+  }
+}
+
 bool Value::CheckComparable(const Value &o) const {
   switch (GetTypeId()) {
     case TypeId::BOOLEAN:
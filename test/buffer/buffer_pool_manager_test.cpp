@@ -12,8 +12,10 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <vector>
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -141,6 +143,65 @@ TEST(BufferPoolManagerTest,  SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 40;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Each page links to the one after it, like a leaf chain.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    page_id_t next = i + 1 < num_pages ? i + 1 : INVALID_PAGE_ID;
+    memcpy(page->GetData(), &next, sizeof(next));
+    snprintf(page->GetData() + sizeof(next), PAGE_SIZE - sizeof(next), "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  auto next_page = [](const char *page_data) {
+    page_id_t next;
+    memcpy(&next, page_data, sizeof(next));
+    return next;
+  };
+
+  // Scenario: Pages read ahead in the background can be fetched while they are read.
+  for (int i = 0; i < num_pages; ++i) {
+    if (i + 1 < num_pages) {
+      bpm->PrefetchPage(i + 1, 4, next_page);
+    }
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string("page ") + std::to_string(i), std::string(page->GetData() + sizeof(page_id_t)));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: Read ahead never keeps frames pinned, the whole pool can still be pinned.
+  bpm->PrefetchPage(0, 8, next_page);
+  std::vector<page_id_t> pinned;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    pinned.push_back(page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto pinned_page_id : pinned) {
+    EXPECT_EQ(true, bpm->UnpinPage(pinned_page_id, false));
+  }
+
+  // Scenario: Once read ahead is stopped, hints are dropped and the disk manager may go first.
+  bpm->StopPrefetch();
+  bpm->PrefetchPage(20, 8, next_page);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
 
 int main()
@@ -10,13 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
+#include "recovery/checkpoint_manager.h"
+#include "storage/page/header_page.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -51,4 +56,131 @@ TEST(CatalogTest, CreateTableTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateArtIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  std::vector<RID> table_rids;
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i * 2)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    table_rids.push_back(rid);
+  }
+
+  // the index only lives in memory, it is filled from the table heap
+  Schema key_schema({Column("A", TypeId::INTEGER)});
+  auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "potato_a", "potato", schema, key_schema, {0}, 8, true, IndexType::ART);
+  EXPECT_FALSE(index_info->index_->IsPersistent());
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    rids.clear();
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i * 2)}, &schema);
+    index_info->index_->ScanKey(tuple.KeyFromTuple(schema, key_schema, {0}), &rids, &txn);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], table_rids[i]);
+  }
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateExtendibleHashIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+  catalog->CreateTable(&txn, "potato", schema);
+
+  // the buckets have no room for more tuples of one key than fit in a page
+  Schema key_schema({Column("A", TypeId::INTEGER)});
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+                   &txn, "potato_a", "potato", schema, key_schema, {0}, 8, false, IndexType::EXTENDIBLE_HASH)),
+               Exception);
+  auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "potato_a", "potato", schema, key_schema, {0}, 8, true, IndexType::EXTENDIBLE_HASH);
+  EXPECT_EQ(index_info, catalog->GetIndex("potato_a", "potato"));
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CheckpointIndexRootTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager, nullptr);
+  auto catalog = new Catalog(bpm, &lock_manager, nullptr);
+  CheckpointManager checkpoint_manager(&txn_mgr, nullptr, bpm);
+  checkpoint_manager.SetCatalog(catalog);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+  catalog->CreateTable(&txn, "potato", schema);
+  Schema key_schema({Column("A", TypeId::INTEGER)});
+  auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn, "potato_a", "potato", schema,
+                                                                                   key_schema, {0}, 8);
+
+  auto insert = [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      Tuple key({ValueFactory::GetIntegerValue(i)}, &key_schema);
+      index_info->index_->InsertEntry(key, RID(i, 0), &txn);
+    }
+  };
+  auto header_root = [&]() {
+    auto header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+    page_id_t root_page_id = INVALID_PAGE_ID;
+    header_page->GetRootId("potato_a", &root_page_id);
+    bpm->UnpinPage(HEADER_PAGE_ID, false);
+    return root_page_id;
+  };
+
+  // a checkpoint writes the root of the tree into the header page, and the page to disk
+  insert(0, 10);
+  checkpoint_manager.BeginCheckpoint();
+  checkpoint_manager.EndCheckpoint();
+  auto checkpointed_root = header_root();
+  EXPECT_NE(checkpointed_root, INVALID_PAGE_ID);
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(HEADER_PAGE_ID, data);
+  auto header_page = bpm->FetchPage(HEADER_PAGE_ID);
+  EXPECT_FALSE(header_page->IsDirty());
+  EXPECT_EQ(memcmp(data, header_page->GetData(), PAGE_SIZE), 0);
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+
+  // root changes after the checkpoint reach the header page when the catalog goes away
+  insert(10, 1000);
+  EXPECT_EQ(header_root(), checkpointed_root);
+  delete catalog;
+  EXPECT_NE(header_root(), checkpointed_root);
+
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+}
+
 }  // namespace bustub
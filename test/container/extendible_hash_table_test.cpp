@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+  ht.VerifyIntegrity();
+
+  // insert one more value for each key
+  for (int i = 0; i < 5; i++) {
+    if (i == 0) {
+      // duplicate values for the same key are not allowed
+      EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+    } else {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i == 0 ? 1 : 2, res.size());
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // more pairs than a bucket holds, the directory has to grow
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  // duplicates are caught in full buckets too
+  for (int i = 0; i < num_keys; i += 100) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // emptied buckets are merged back until the directory is a single bucket
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i += 100) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DuplicateKeyLimitTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // a bucket holds all the pairs of one key, no split can separate them
+  const int bucket_size = 4 * PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 1);
+  for (int i = 0; i < bucket_size; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 1, i));
+  }
+  EXPECT_THROW(ht.Insert(nullptr, 1, bucket_size), Exception);
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  // the failed insert released the table
+  for (int i = 2; i < 100; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  ht.VerifyIntegrity();
+  std::vector<int> res;
+  ht.GetValue(nullptr, 1, &res);
+  EXPECT_EQ(bucket_size, res.size());
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentInsertRemoveTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // each thread inserts its own keys and removes every other one of them
+  const int num_threads = 4;
+  const int per_thread = 2000;
+  std::vector<std::thread> threads;
+  for (int thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&ht, thread_itr]() {
+      for (int i = 0; i < per_thread; i++) {
+        int key = i * num_threads + thread_itr;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      }
+      for (int i = 0; i < per_thread; i += 2) {
+        int key = i * num_threads + thread_itr;
+        EXPECT_TRUE(ht.Remove(nullptr, key, key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ht.VerifyIntegrity();
+
+  for (int key = 0; key < num_threads * per_thread; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    if ((key / num_threads) % 2 == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << key << std::endl;
+      EXPECT_EQ(key, res[0]);
+    }
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
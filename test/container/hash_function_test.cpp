@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_function_test.cpp
+//
+// Identification: test/container/hash_function_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <unordered_set>
+
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashFunctionTest, IntegerKeyTest) {
+  HashFunction<int> hash_fn;
+  std::unordered_set<uint64_t> hashes;
+  std::unordered_set<uint64_t> low_bits;
+  std::unordered_set<uint64_t> high_bits;
+  for (int key = -500; key < 500; key++) {
+    EXPECT_EQ(hash_fn.GetHash(key), hash_fn.GetHash(key));
+    hashes.insert(hash_fn.GetHash(key));
+    low_bits.insert(hash_fn.GetHash(key) & 0xff);
+    high_bits.insert(hash_fn.GetHash(key) >> 57);
+  }
+  // the mix is a bijection, and consecutive keys spread over both ends of the hash
+  EXPECT_EQ(1000, hashes.size());
+  EXPECT_GT(low_bits.size(), 200);
+  EXPECT_EQ(128, high_bits.size());
+}
+
+// NOLINTNEXTLINE
+TEST(HashFunctionTest, GenericKeyTest) {
+  HashFunction<GenericKey<64>> hash_fn;
+  GenericKey<64> key;
+  GenericKey<64> same_key;
+  std::unordered_set<uint64_t> hashes;
+  for (int64_t i = 0; i < 1000; i++) {
+    key.SetFromInteger(i);
+    same_key.SetFromInteger(i);
+    EXPECT_EQ(hash_fn.GetHash(key), hash_fn.GetHash(same_key));
+    hashes.insert(hash_fn.GetHash(key));
+  }
+  EXPECT_EQ(1000, hashes.size());
+
+  // every byte of the key counts, not only the leading ones
+  key.SetFromInteger(1);
+  uint64_t hash = hash_fn.GetHash(key);
+  for (size_t byte = 8; byte < 64; byte++) {
+    key.data_[byte] = 1;
+    EXPECT_NE(hash, hash_fn.GetHash(key)) << byte;
+    key.data_[byte] = 0;
+  }
+
+  HashFunction<GenericKey<4>> narrow_hash_fn;
+  GenericKey<4> narrow_key;
+  memset(narrow_key.data_, 0, 4);
+  uint64_t zero_hash = narrow_hash_fn.GetHash(narrow_key);
+  narrow_key.data_[3] = 1;
+  EXPECT_NE(zero_hash, narrow_hash_fn.GetHash(narrow_key));
+}
+
+}  // namespace bustub
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -23,7 +24,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -56,12 +57,12 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
   bpm->UnpinPage(header_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -73,7 +74,7 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    block_page->Insert(i, i, i, HashTableBlockPage<int, int, IntComparator>::Fingerprint(i));
   }
 
   // check for the inserted pairs
@@ -103,12 +104,61 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
     }
   }
 
+  // a tombstone takes a new pair, a pair is not overwritten
+  EXPECT_TRUE(block_page->Insert(1, 11, 11, HashTableBlockPage<int, int, IntComparator>::Fingerprint(11)));
+  EXPECT_TRUE(block_page->IsReadable(1));
+  EXPECT_EQ(11, block_page->KeyAt(1));
+  EXPECT_FALSE(block_page->Insert(2, 12, 12, HashTableBlockPage<int, int, IntComparator>::Fingerprint(12)));
+
   // unpin the header page now that we are done
   bpm->UnpinPage(block_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
+  delete bpm;
   delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BlockPageMatchGroupTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  using BlockPage = HashTableBlockPage<int, int, IntComparator>;
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page = reinterpret_cast<BlockPage *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
+
+  // slots 0..19 alternate between two fingerprints, slot 3 is removed
+  uint8_t even = BlockPage::Fingerprint(0);
+  uint8_t odd = BlockPage::Fingerprint(1ULL << 63);
+  EXPECT_NE(even, odd);
+  for (unsigned i = 0; i < 20; i++) {
+    EXPECT_TRUE(block_page->Insert(i, i, i, i % 2 == 0 ? even : odd));
+  }
+  EXPECT_FALSE(block_page->Insert(0, 0, 0, even));
+  block_page->Remove(3);
+
+  for (slot_offset_t start = 0; start < 24; start += BLOCK_TAG_GROUP_SIZE) {
+    slot_offset_t count = BLOCK_TAG_GROUP_SIZE;
+    uint32_t empty;
+    uint32_t match = block_page->MatchGroup(start, count, odd, &empty);
+    for (slot_offset_t i = 0; i < count; i++) {
+      slot_offset_t slot = start + i;
+      EXPECT_EQ(slot < 20 && slot % 2 == 1 && slot != 3, ((match >> i) & 1) == 1) << slot;
+      EXPECT_EQ(slot >= 20, ((empty >> i) & 1) == 1) << slot;
+    }
+  }
+
+  // the last group of the block is cut to the slots of the block
+  uint32_t empty;
+  slot_offset_t start = PAGE_SIZE / (sizeof(std::pair<int, int>) + 1) - 3;
+  EXPECT_EQ(0, block_page->MatchGroup(start, 3, odd, &empty));
+  EXPECT_EQ(0b111, empty);
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
@@ -21,7 +21,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -100,8 +100,183 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   }
   disk_manager->ShutDown();
   remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // the table doubles whenever it runs out of slots
+  for (int i = 0; i < 2000; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GE(ht.GetSize(), 2000);
+
+  // removed pairs are dropped by the next resize
+  for (int i = 0; i < 2000; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  size_t size = ht.GetSize();
+  for (int i = 2000; i < 2000 + static_cast<int>(size); i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht.GetSize(), size);
+
+  for (int i = 0; i < 2000 + static_cast<int>(size); i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i < 2000 && i % 2 == 0) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, TombstoneReuseTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 100, HashFunction<int>());
+
+  // a sliding window of 20 keys leaves a tombstone for every key it passes
+  const int window = 20;
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    if (i >= window) {
+      EXPECT_TRUE(ht.Remove(nullptr, i - window, i - window));
+    }
+  }
+  // inserts reuse the tombstones and rebuilds drop them, the table never grows
+  EXPECT_EQ(100, ht.GetSize());
+  for (int i = 0; i < 10000; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i >= 10000 - window ? 1 : 0, res.size()) << i;
+  }
+
+  // a removed pair can be inserted again
+  EXPECT_TRUE(ht.Insert(nullptr, 0, 0));
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
   delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeFailureTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+
+  // leave too few frames to copy the table into a bigger one
+  std::vector<page_id_t> pinned;
+  for (int i = 0; i < 7; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    pinned.push_back(page_id);
+  }
+  size_t size = ht.GetSize();
+  int key = 5;
+  EXPECT_THROW(
+      {
+        for (; key < 5 + static_cast<int>(size); key++) {
+          ht.Insert(nullptr, key, key);
+        }
+      },
+      Exception);
+  EXPECT_EQ(size, ht.GetSize());
+
+  // the failed resize released its latches and pages, the table still works
+  for (auto page_id : pinned) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (; key < 100; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  for (int i = 0; i < 100; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 16, HashFunction<int>());
+
+  // writers keep resizing the table while readers look up the preloaded keys
+  const int preloaded = 100;
+  const int writers = 4;
+  const int per_writer = 1000;
+  for (int i = 0; i < preloaded; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+  std::vector<std::thread> threads;
+  for (int thread_itr = 0; thread_itr < writers; thread_itr++) {
+    threads.emplace_back([&ht, thread_itr]() {
+      for (int i = 0; i < per_writer; i++) {
+        int key = preloaded + i * writers + thread_itr;
+        ht.Insert(nullptr, key, key);
+        // leave tombstones for the other writers to reuse
+        if (key % 3 == 0) {
+          ht.Remove(nullptr, key, key);
+        }
+      }
+    });
+  }
+  for (int thread_itr = 0; thread_itr < writers; thread_itr++) {
+    threads.emplace_back([&ht]() {
+      for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < preloaded; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, i, &res);
+          EXPECT_EQ(1, res.size());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < preloaded + writers * per_writer; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i >= preloaded && i % 3 == 0) {
+      EXPECT_EQ(0, res.size()) << i;
+      continue;
+    }
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
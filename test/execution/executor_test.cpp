@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
 #include <memory>
+#include <random>
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -32,6 +34,8 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
@@ -168,6 +172,58 @@ TEST_F(ExecutorTest,  SimpleSeqScanTest) {
   ASSERT_EQ(result_set.size(), 500);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CompressedSeqScanTest) {
+  // CREATE TABLE compressed (colA integer, colB integer) with compressed pages, and pax with PAX pages
+  // INSERT INTO compressed VALUES (i, i % 7) for i in 0..999
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER)});
+  for (auto format : {TableFormat::COMPRESSED, TableFormat::PAX}) {
+    auto table_info = GetExecutorContext()->GetCatalog()->CreateTable(
+        GetTxn(), format == TableFormat::PAX ? "pax" : "compressed", schema, format);
+    std::vector<std::vector<Value>> raw_vals;
+    for (int32_t i = 0; i < 1000; i++) {
+      raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)});
+    }
+    InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+    GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+    auto colA = MakeColumnValueExpression(table_info->schema_, 0, "colA");
+    auto colB = MakeColumnValueExpression(table_info->schema_, 0, "colB");
+    auto out_schema = MakeOutputSchema({{"colB", colB}, {"colA", colA}});
+    // the comparisons are evaluated on the encoded pages, or on the minipage of the column
+    auto scan = [&](const AbstractExpression *predicate) {
+      SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+      std::vector<int32_t> result;
+      for (auto &tuple : result_set) {
+        result.push_back(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+        EXPECT_EQ(result.back() % 7, tuple.GetValue(out_schema, out_schema->GetColIdx("colB")).GetAs<int32_t>());
+      }
+      return result;
+    };
+
+    // SELECT colB, colA FROM compressed WHERE colA < 150
+    auto const150 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(150));
+    auto result = scan(MakeComparisonExpression(colA, const150, ComparisonType::LessThan));
+    ASSERT_EQ(150, result.size());
+    for (int32_t i = 0; i < 150; i++) {
+      ASSERT_EQ(i, result[i]);
+    }
+    // WHERE 150 < colA
+    ASSERT_EQ(849, scan(MakeComparisonExpression(const150, colA, ComparisonType::LessThan)).size());
+    // WHERE colB = 3
+    auto const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+    result = scan(MakeComparisonExpression(colB, const3, ComparisonType::Equal));
+    ASSERT_EQ(143, result.size());
+    for (auto a : result) {
+      ASSERT_EQ(3, a % 7);
+    }
+    // no predicate
+    ASSERT_EQ(1000, scan(nullptr).size());
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
@@ -335,6 +391,131 @@ TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleIndexScanRangeTest) {
+  // INSERT INTO empty_table2 VALUES (i, i % 7) for i in 0..199, in shuffled order
+  std::vector<int32_t> keys(200);
+  for (int32_t i = 0; i < 200; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  std::vector<std::vector<Value>> raw_vals;
+  for (auto key : keys) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(key), ValueFactory::GetIntegerValue(key % 7)});
+  }
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 8);
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+
+  auto scan = [&](const AbstractExpression *predicate) {
+    IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<int32_t> result;
+    for (auto &tuple : result_set) {
+      result.push_back(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    }
+    return result;
+  };
+  auto range = [](int32_t begin, int32_t end) {
+    std::vector<int32_t> result;
+    for (int32_t i = begin; i < end; i++) {
+      result.push_back(i);
+    }
+    return result;
+  };
+
+  // SELECT colA, colB FROM empty_table2 WHERE colA >= 150
+  auto const150 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(150));
+  ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::GreaterThanOrEqual)), range(150, 200));
+  // WHERE colA > 150
+  ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::GreaterThan)), range(151, 200));
+  // WHERE 150 > colA
+  ASSERT_EQ(scan(MakeComparisonExpression(const150, colA, ComparisonType::GreaterThan)), range(0, 150));
+  // WHERE colA <= 150
+  ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::LessThanOrEqual)), range(0, 151));
+  // WHERE colA = 150
+  ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::Equal)), range(150, 151));
+  // WHERE colA != 150, the whole index is scanned
+  auto not_equal = range(0, 200);
+  not_equal.erase(not_equal.begin() + 150);
+  ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::NotEqual)), not_equal);
+  // WHERE colB = 3, not on the index key
+  std::vector<int32_t> col_b_equal;
+  for (int32_t i = 3; i < 200; i += 7) {
+    col_b_equal.push_back(i);
+  }
+  auto const3 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(3));
+  ASSERT_EQ(scan(MakeComparisonExpression(colB, const3, ComparisonType::Equal)), col_b_equal);
+  // no predicate
+  ASSERT_EQ(scan(nullptr), range(0, 200));
+
+  // DELETE FROM empty_table2 WHERE colA >= 50, the index scan feeding the
+  // delete hands out its entries while they are removed from the index
+  auto const50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  IndexScanPlanNode delete_scan{out_schema, MakeComparisonExpression(colA, const50, ComparisonType::GreaterThanOrEqual),
+                                index_info->index_oid_};
+  DeletePlanNode delete_plan{&delete_scan, table_info->oid_};
+  GetExecutionEngine()->Execute(&delete_plan, nullptr, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(scan(nullptr), range(0, 50));
+
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashIndexScanTest) {
+  // INSERT INTO empty_table2 VALUES (i, i % 7) for i in 0..199
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 200; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)});
+  }
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto const150 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(150));
+  Schema *key_schema = ParseCreateStatement("a integer");
+
+  for (auto index_type : {IndexType::LINEAR_PROBE_HASH, IndexType::EXTENDIBLE_HASH, IndexType::ART}) {
+    auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        GetTxn(), "index" + std::to_string(static_cast<int>(index_type)), "empty_table2", schema, *key_schema, {0}, 8,
+        true, index_type);
+    auto scan = [&](const AbstractExpression *predicate) {
+      IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_};
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+      std::vector<int32_t> result;
+      for (auto &tuple : result_set) {
+        result.push_back(tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+      }
+      std::sort(result.begin(), result.end());
+      return result;
+    };
+
+    // SELECT colA, colB FROM empty_table2 WHERE colA = 150 looks the key up
+    ASSERT_EQ(scan(MakeComparisonExpression(colA, const150, ComparisonType::Equal)), std::vector<int32_t>{150});
+    ASSERT_EQ(scan(MakeComparisonExpression(const150, colA, ComparisonType::Equal)), std::vector<int32_t>{150});
+    // WHERE colA >= 150 and no predicate fall back to reading the table
+    ASSERT_EQ(50, scan(MakeComparisonExpression(colA, const150, ComparisonType::GreaterThanOrEqual)).size());
+    ASSERT_EQ(200, scan(nullptr).size());
+  }
+
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -435,6 +616,61 @@ TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleNestedIndexJoinTest) {
+  // SELECT test_1.colA, empty_table2.colB FROM test_1 JOIN empty_table2 ON test_1.colA = empty_table2.colA
+  // with an index on empty_table2.colA, which holds every multiple of 3 below 300
+  auto inner_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 300; i += 3) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), inner_info->oid_};
+  Schema *key_schema = ParseCreateStatement("a integer");
+  GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "empty_table2", inner_info->schema_, *key_schema, {0}, 8);
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *outer_schema;
+  {
+    // the join column is not the first one of the outer tuple
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    outer_schema = MakeOutputSchema({{"colB", colB}, {"colA", colA}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(outer_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<NestedIndexJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto outer_colA = MakeColumnValueExpression(*outer_schema, 0, "colA");
+    auto inner_colA = MakeColumnValueExpression(inner_info->schema_, 1, "colA");
+    auto inner_colB = MakeColumnValueExpression(inner_info->schema_, 1, "colB");
+    auto predicate = MakeComparisonExpression(outer_colA, inner_colA, ComparisonType::Equal);
+    out_final = MakeOutputSchema({{"colA", outer_colA}, {"colB", inner_colB}});
+    join_plan = std::make_unique<NestedIndexJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan.get()}, predicate, inner_info->oid_, "index1",
+        outer_schema, &inner_info->schema_);
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  std::vector<int32_t> joined;
+  for (const auto &tuple : result_set) {
+    auto colA = tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_EQ(colA % 3, 0);
+    ASSERT_EQ(tuple.GetValue(out_final, out_final->GetColIdx("colB")).GetAs<int32_t>(), colA % 7);
+    joined.push_back(colA);
+  }
+  std::sort(joined.begin(), joined.end());
+  ASSERT_EQ(std::unique(joined.begin(), joined.end()), joined.end());
+
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
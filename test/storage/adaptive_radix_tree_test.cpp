@@ -0,0 +1,166 @@
+/**
+ * adaptive_radix_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+using RadixTree = AdaptiveRadixTree<GenericKey<8>, RID>;
+
+TEST(AdaptiveRadixTreeTests, InsertRemoveTest) {
+  RadixTree tree;
+  GenericKey<8> index_key;
+
+  // random keys share few bytes, sequential ones share all but the last and
+  // fill every node size on the way
+  std::vector<int64_t> keys;
+  std::mt19937_64 generator(15445);
+  for (int i = 0; i < 2000; i++) {
+    keys.push_back(static_cast<int64_t>(generator() >> 1));
+    keys.push_back(i);
+  }
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, static_cast<uint32_t>(key))));
+  }
+  // unique keys
+  index_key.SetFromInteger(keys[0]);
+  EXPECT_FALSE(tree.Insert(index_key, RID(1, 1)));
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0], RID(0, static_cast<uint32_t>(key)));
+  }
+  index_key.SetFromInteger(-1);
+  EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    index_key.SetFromInteger(keys[i]);
+    EXPECT_TRUE(tree.Remove(index_key, RID()));
+    EXPECT_FALSE(tree.Remove(index_key, RID()));
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    rids.clear();
+    index_key.SetFromInteger(keys[i]);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), i % 2 == 1);
+  }
+}
+
+TEST(AdaptiveRadixTreeTests, DuplicateKeyTest) {
+  RadixTree tree(false);
+  GenericKey<8> index_key;
+
+  for (int64_t key = 1; key <= 100; key++) {
+    index_key.SetFromInteger(key);
+    for (int64_t value = 0; value < key % 5 + 1; value++) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(key, value)));
+    }
+  }
+  index_key.SetFromInteger(4);
+  EXPECT_FALSE(tree.Insert(index_key, RID(4, 0)));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 100; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(rids.size(), key % 5 + 1);
+  }
+
+  index_key.SetFromInteger(4);
+  EXPECT_TRUE(tree.Remove(index_key, RID(4, 2)));
+  EXPECT_FALSE(tree.Remove(index_key, RID(4, 2)));
+  rids.clear();
+  tree.GetValue(index_key, &rids);
+  EXPECT_EQ(rids, (std::vector<RID>{RID(4, 0), RID(4, 1), RID(4, 3), RID(4, 4)}));
+}
+
+/*
+ * Writers insert and remove their own keys while readers look up keys that
+ * stay in the tree the whole time
+ */
+TEST(AdaptiveRadixTreeTests, ConcurrentTest) {
+  RadixTree tree;
+  const int64_t stable_keys = 1000;
+  const int64_t keys_per_writer = 20000;
+  const int writers = 4;
+  const int readers = 4;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < stable_keys; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+  std::vector<std::thread> threads;
+  for (int thread_itr = 0; thread_itr < writers; thread_itr++) {
+    threads.emplace_back([&, thread_itr]() {
+      GenericKey<8> key_of_thread;
+      int64_t first = stable_keys + thread_itr * keys_per_writer;
+      for (int64_t key = first; key < first + keys_per_writer; key++) {
+        key_of_thread.SetFromInteger(key);
+        if (!tree.Insert(key_of_thread, RID(0, key))) {
+          errors++;
+        }
+        // drop every other key again
+        if (key % 2 == 0 && !tree.Remove(key_of_thread, RID(0, key))) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (int thread_itr = 0; thread_itr < readers; thread_itr++) {
+    threads.emplace_back([&, thread_itr]() {
+      GenericKey<8> key_of_thread;
+      std::vector<RID> rids;
+      std::mt19937 generator(thread_itr);
+      std::uniform_int_distribution<int64_t> distribution(0, stable_keys - 1);
+      while (!done.load()) {
+        int64_t key = distribution(generator);
+        key_of_thread.SetFromInteger(key);
+        rids.clear();
+        if (!tree.GetValue(key_of_thread, &rids) || !(rids[0] == RID(0, key))) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (int thread_itr = 0; thread_itr < writers; thread_itr++) {
+    threads[thread_itr].join();
+  }
+  // the readers never all pause at once, replaced nodes are freed anyway
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (tree.GetRetiredCount() >= 64 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  EXPECT_LT(tree.GetRetiredCount(), 64);
+  done = true;
+  for (int thread_itr = writers; thread_itr < writers + readers; thread_itr++) {
+    threads[thread_itr].join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+
+  std::vector<RID> rids;
+  for (int64_t key = stable_keys; key < stable_keys + writers * keys_per_writer; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1) << key;
+  }
+}
+
+}  // namespace bustub
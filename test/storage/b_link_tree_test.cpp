@@ -0,0 +1,283 @@
+/**
+ * b_link_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_link_tree.h"
+
+namespace bustub {
+
+using LinkTree = BLinkTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(BLinkTreeTests, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LinkTree tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys(1000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<int64_t>(i) + 1;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  // unique keys
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, 2), transaction));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 1000; ++key) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+
+  // remove the even keys, nodes drain without being merged
+  for (int64_t key = 2; key <= 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Remove(index_key, RID(0, key), transaction));
+  }
+  EXPECT_FALSE(tree.Remove(index_key, RID(0, 1000), transaction));
+
+  GenericKey<8> low;
+  GenericKey<8> high;
+  low.SetFromInteger(100);
+  high.SetFromInteger(200);
+  rids.clear();
+  tree.ScanRange(&low, false, &high, true, &rids);
+  ASSERT_EQ(rids.size(), 50);
+  for (size_t i = 0; i < rids.size(); ++i) {
+    EXPECT_EQ(rids[i].GetSlotNum(), 101 + 2 * i);
+  }
+
+  rids.clear();
+  tree.ScanRange(nullptr, true, nullptr, true, &rids);
+  EXPECT_EQ(rids.size(), 500);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BLinkTreeTests, SplitFailureTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(5, disk_manager);
+  LinkTree tree("foo_pk", bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // leave two free frames: the root leaf and the new root fit, the sibling does not
+  page_id_t filler_page_ids[2];
+  for (auto &filler_page_id : filler_page_ids) {
+    ASSERT_NE(bpm->NewPage(&filler_page_id), nullptr);
+  }
+
+  int64_t failed_key = 0;
+  for (int64_t key = 1; key <= 10 && failed_key == 0; ++key) {
+    index_key.SetFromInteger(key);
+    try {
+      tree.Insert(index_key, RID(0, key), transaction);
+    } catch (Exception &) {
+      failed_key = key;
+    }
+  }
+  ASSERT_GT(failed_key, 1);
+
+  // the root leaf was released untouched and the new root given back
+  page_id_t root_page_id = tree.GetRootPageId();
+  auto root_page = bpm->FetchPage(root_page_id);
+  ASSERT_NE(root_page, nullptr);
+  EXPECT_EQ(root_page->GetPinCount(), 1);
+  bpm->UnpinPage(root_page_id, false);
+  std::vector<RID> rids;
+  tree.ScanRange(nullptr, true, nullptr, true, &rids);
+  EXPECT_EQ(rids.size(), failed_key - 1);
+
+  for (auto filler_page_id : filler_page_ids) {
+    bpm->UnpinPage(filler_page_id, false);
+  }
+  for (int64_t key = failed_key; key <= 200; ++key) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  EXPECT_NE(tree.GetRootPageId(), root_page_id);
+  for (int64_t key = 1; key <= 200; ++key) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BLinkTreeTests, DuplicateKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  LinkTree tree("foo_idx", bpm, comparator, 4, 4, false);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // every key has as many values as it is large, enough to span several leaves
+  for (int64_t key = 1; key <= 20; ++key) {
+    index_key.SetFromInteger(key);
+    for (int64_t value = 0; value < key; ++value) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(key, value), transaction));
+    }
+  }
+  index_key.SetFromInteger(5);
+  EXPECT_FALSE(tree.Insert(index_key, RID(5, 0), transaction));
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 20; ++key) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), key);
+    for (int64_t value = 0; value < key; ++value) {
+      EXPECT_EQ(rids[value], RID(key, value));
+    }
+  }
+
+  index_key.SetFromInteger(20);
+  EXPECT_TRUE(tree.Remove(index_key, RID(20, 7), transaction));
+  EXPECT_FALSE(tree.Remove(index_key, RID(20, 7), transaction));
+  rids.clear();
+  tree.GetValue(index_key, &rids);
+  EXPECT_EQ(rids.size(), 19);
+  EXPECT_EQ(std::find(rids.begin(), rids.end(), RID(20, 7)), rids.end());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Readers look up keys that are already in the tree while writers keep
+ * splitting the nodes on their way
+ */
+TEST(BLinkTreeTests, ConcurrentReadWriteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+  LinkTree tree("foo_pk", bpm, comparator, 4, 4);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t preloaded = 1000;
+  const int64_t total = 10000;
+  const uint64_t writers = 4;
+  const uint64_t readers = 4;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= preloaded; ++key) {
+    index_key.SetFromInteger(key * 2);
+    tree.Insert(index_key, RID(0, key * 2));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> missed{0};
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < writers; ++thread_itr) {
+    threads.emplace_back([&, thread_itr]() {
+      GenericKey<8> key_of_thread;
+      for (int64_t key = preloaded + 1; key <= total; ++key) {
+        if (static_cast<uint64_t>(key) % writers == thread_itr) {
+          key_of_thread.SetFromInteger(key * 2 + 1);
+          tree.Insert(key_of_thread, RID(0, key * 2 + 1));
+        }
+      }
+    });
+  }
+  for (uint64_t thread_itr = 0; thread_itr < readers; ++thread_itr) {
+    threads.emplace_back([&, thread_itr]() {
+      GenericKey<8> key_of_thread;
+      std::vector<RID> rids;
+      std::mt19937 generator(thread_itr);
+      std::uniform_int_distribution<int64_t> distribution(1, preloaded);
+      while (!done.load()) {
+        int64_t key = distribution(generator) * 2;
+        key_of_thread.SetFromInteger(key);
+        rids.clear();
+        if (!tree.GetValue(key_of_thread, &rids) || rids[0].GetSlotNum() != key) {
+          missed++;
+        }
+      }
+    });
+  }
+  for (uint64_t thread_itr = 0; thread_itr < writers; ++thread_itr) {
+    threads[thread_itr].join();
+  }
+  done = true;
+  for (uint64_t thread_itr = writers; thread_itr < writers + readers; ++thread_itr) {
+    threads[thread_itr].join();
+  }
+  EXPECT_EQ(missed.load(), 0);
+
+  std::vector<RID> rids;
+  tree.ScanRange(nullptr, true, nullptr, true, &rids);
+  ASSERT_EQ(rids.size(), total);
+  for (size_t i = 1; i < rids.size(); ++i) {
+    EXPECT_LT(rids[i - 1].GetSlotNum(), rids[i].GetSlotNum());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,177 @@
+/**
+ * b_plus_tree_churn_bench_test.cpp
+ */
+
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+using ChurnTree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using ChurnLeaf = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using ChurnInternal = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+const int64_t CHURN_TOTAL_KEYS = 20000;
+const int64_t CHURN_WINDOW = 200;
+const size_t CHURN_ROUNDS = 20;
+const uint64_t CHURN_THREADS = 4;
+
+// Every round deletes a window of the thread's keys and inserts it again, a
+// delete-heavy workload whose pages drop below half full and fill up again
+void ChurnHelper(ChurnTree *tree, uint64_t thread_itr) {
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(thread_itr);
+  for (size_t round = 0; round < CHURN_ROUNDS; round++) {
+    int64_t start = (round * CHURN_WINDOW * 3) % CHURN_TOTAL_KEYS;
+    std::vector<int64_t> window;
+    for (int64_t key = start + 1; key <= start + CHURN_WINDOW * static_cast<int64_t>(CHURN_THREADS); key++) {
+      if (static_cast<uint64_t>(key) % CHURN_THREADS == thread_itr) {
+        window.push_back(key);
+      }
+    }
+    for (auto key : window) {
+      index_key.SetFromInteger(key);
+      tree->Remove(index_key, transaction);
+    }
+    for (auto key : window) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree->Insert(index_key, rid, transaction);
+    }
+  }
+  delete transaction;
+}
+
+// Shape of the tree read straight from its pages
+struct ChurnShape {
+  int height_{0};
+  int leaves_{0};
+  int keys_{0};
+  // leaves holding fewer keys than the eager policy allows
+  int underfull_leaves_{0};
+};
+
+ChurnShape ShapeOf(ChurnTree *tree, BufferPoolManager *bpm) {
+  ChurnShape shape;
+  EXPECT_TRUE(tree->FlushRootPageId());
+  page_id_t page_id = INVALID_PAGE_ID;
+  auto header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", &page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+
+  // leftmost path down to the first leaf
+  while (true) {
+    auto node = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(page_id)->GetData());
+    shape.height_++;
+    if (node->IsLeafPage()) {
+      break;
+    }
+    auto child_page_id = reinterpret_cast<ChurnInternal *>(node)->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_page_id;
+  }
+  bpm->UnpinPage(page_id, false);
+
+  while (page_id != INVALID_PAGE_ID) {
+    auto leaf = reinterpret_cast<ChurnLeaf *>(bpm->FetchPage(page_id)->GetData());
+    shape.leaves_++;
+    shape.keys_ += leaf->GetSize();
+    if (leaf->GetSize() < leaf->GetMinSize()) {
+      shape.underfull_leaves_++;
+    }
+    auto next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return shape;
+}
+
+// Churn a tree under policy, then compact it
+void RunChurn(MergePolicy policy, ChurnShape *after_churn, ChurnShape *after_compact) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(256, disk_manager);
+  ChurnTree tree("foo_pk", bpm, comparator, 32, 32, true, policy);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(CHURN_THREADS);
+  for (int64_t key = 1; key <= CHURN_TOTAL_KEYS; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < CHURN_THREADS; thread_itr++) {
+    threads.emplace_back(ChurnHelper, &tree, thread_itr);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  *after_churn = ShapeOf(&tree, bpm);
+  tree.Compact(transaction);
+  *after_compact = ShapeOf(&tree, bpm);
+
+  // every key is back in place
+  int64_t expected = 1;
+  for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), expected);
+    expected++;
+  }
+  EXPECT_EQ(expected, CHURN_TOTAL_KEYS + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Compare the shape eager and lazy merges leave behind, before and after a
+ * compaction pass
+ */
+TEST(BPlusTreeTest, ChurnBenchmark) {
+  ChurnShape eager;
+  ChurnShape eager_compact;
+  RunChurn(MergePolicy::EAGER, &eager, &eager_compact);
+  ChurnShape lazy;
+  ChurnShape lazy_compact;
+  RunChurn(MergePolicy::LAZY, &lazy, &lazy_compact);
+
+  for (auto &shape : {eager, eager_compact, lazy, lazy_compact}) {
+    EXPECT_EQ(shape.keys_, CHURN_TOTAL_KEYS);
+  }
+
+  // eager merges keep every leaf half full, there is nothing left to compact
+  EXPECT_EQ(eager.underfull_leaves_, 0);
+  EXPECT_EQ(eager_compact.leaves_, eager.leaves_);
+  EXPECT_EQ(eager_compact.height_, eager.height_);
+
+  // lazy merges leave drained leaves behind, never more leaves than keys allow
+  EXPECT_GE(lazy.leaves_, eager.leaves_);
+  EXPECT_LE(lazy.leaves_, CHURN_TOTAL_KEYS);
+  EXPECT_GE(lazy.height_, eager.height_);
+
+  // compaction brings every leaf back to half full
+  EXPECT_EQ(lazy_compact.underfull_leaves_, 0);
+  EXPECT_LE(lazy_compact.leaves_, lazy.leaves_);
+  EXPECT_LE(lazy_compact.height_, lazy.height_);
+}
+
+}  // namespace bustub
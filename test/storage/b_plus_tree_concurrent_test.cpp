@@ -100,47 +100,49 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-  // keys to Insert
-  std::vector<int64_t> keys;
-  int64_t scale_factor = 100;
-  for (int64_t key = 1; key < scale_factor; key++) {
-    keys.push_back(key);
-  }
-  LaunchParallelTest(2, InsertHelper, &tree, keys);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // keys to Insert
+    std::vector<int64_t> keys;
+    int64_t scale_factor = 100;
+    for (int64_t key = 1; key < scale_factor; key++) {
+      keys.push_back(key);
+    }
+    LaunchParallelTest(2, InsertHelper, &tree, keys);
 
-  std::vector<RID> rids;
-  GenericKey<8> index_key;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -152,49 +154,51 @@ TEST(BPlusTreeConcurrentTest,  InsertTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 6);
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-  // keys to Insert
-  std::vector<int64_t> keys;
-  int64_t scale_factor = 100;
-  for (int64_t key = 1; key < scale_factor; key++) {
-    keys.push_back(key);
-  }
-  LaunchParallelTest(2, InsertHelperSplit, &tree, keys, 2);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 6);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // keys to Insert
+    std::vector<int64_t> keys;
+    int64_t scale_factor = 100;
+    for (int64_t key = 1; key < scale_factor; key++) {
+      keys.push_back(key);
+    }
+    LaunchParallelTest(2, InsertHelperSplit, &tree, keys, 2);
 
-  std::vector<RID> rids;
-  GenericKey<8> index_key;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  tree.Print(bpm);
+    tree.Print(bpm);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -207,37 +211,39 @@ TEST(BPlusTreeConcurrentTest,  DeleteTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
-  GenericKey<8> index_key;
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-  // sequential insert
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  InsertHelper(&tree, keys);
-  tree.Print(bpm);
-  std::vector<int64_t> remove_keys = {1, 5, 3, 4};
-  LaunchParallelTest(2, DeleteHelper, &tree, remove_keys);
-
-  int64_t start_key = 2;
-  int64_t current_key = start_key;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // sequential insert
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    InsertHelper(&tree, keys);
+    tree.Print(bpm);
+    std::vector<int64_t> remove_keys = {1, 5, 3, 4};
+    LaunchParallelTest(2, DeleteHelper, &tree, remove_keys);
+
+    int64_t start_key = 2;
+    int64_t current_key = start_key;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 1);
+    EXPECT_EQ(size, 1);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -250,39 +256,41 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
-  GenericKey<8> index_key;
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  // sequential insert
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
-  InsertHelper(&tree, keys);
-
-  std::vector<int64_t> remove_keys = {1, 4, 3, 2, 5, 6};
-  LaunchParallelTest(2, DeleteHelperSplit, &tree, remove_keys, 2);
-
-  int64_t start_key = 7;
-  int64_t current_key = start_key;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // sequential insert
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    InsertHelper(&tree, keys);
+
+    std::vector<int64_t> remove_keys = {1, 4, 3, 2, 5, 6};
+    LaunchParallelTest(2, DeleteHelperSplit, &tree, remove_keys, 2);
+
+    int64_t start_key = 7;
+    int64_t current_key = start_key;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 4);
+    EXPECT_EQ(size, 4);
 
-  tree.Print(bpm);
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete disk_manager;
+    tree.Print(bpm);
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -295,40 +303,42 @@ TEST(BPlusTreeConcurrentTest,  MixTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-  // first, populate index
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  InsertHelper(&tree, keys);
-
-  // concurrent insert
-  keys.clear();
-  for (int i = 6; i <= 10; i++) {
-    keys.push_back(i);
-  }
-  LaunchParallelTest(1, InsertHelper, &tree, keys);
-  // concurrent delete
-  std::vector<int64_t> remove_keys = {1, 4, 3, 5, 6};
-  LaunchParallelTest(1, DeleteHelper, &tree, remove_keys);
-
-  int64_t start_key = 2;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    size = size + 1;
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // first, populate index
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    InsertHelper(&tree, keys);
+
+    // concurrent insert
+    keys.clear();
+    for (int i = 6; i <= 10; i++) {
+      keys.push_back(i);
+    }
+    LaunchParallelTest(1, InsertHelper, &tree, keys);
+    // concurrent delete
+    std::vector<int64_t> remove_keys = {1, 4, 3, 5, 6};
+    LaunchParallelTest(1, DeleteHelper, &tree, remove_keys);
+
+    int64_t start_key = 2;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 5);
+    EXPECT_EQ(size, 5);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
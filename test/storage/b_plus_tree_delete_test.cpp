@@ -4,6 +4,9 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <numeric>
+#include <random>
+#include <set>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
@@ -21,78 +24,80 @@ TEST(BPlusTreeTests, DeleteTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator,3 ,4);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
+
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    index_key.SetFromInteger(start_key);
+
+      for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+        auto location = (*iterator).second;
+
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  index_key.SetFromInteger(start_key);
 
+
+     EXPECT_EQ(current_key, keys.size() + 1);
+
+    std::vector<int64_t> remove_keys = {1, 5};
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+
+    tree.Print(bpm);
+    start_key = 2;
+    current_key = start_key;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
     for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
       auto location = (*iterator).second;
-      
       EXPECT_EQ(location.GetPageId(), 0);
       EXPECT_EQ(location.GetSlotNum(), current_key);
       current_key = current_key + 1;
+      size = size + 1;
     }
 
+    EXPECT_EQ(size, 3);
 
-
-   EXPECT_EQ(current_key, keys.size() + 1);
-
-  std::vector<int64_t> remove_keys = {1, 5};
-  for (auto key : remove_keys) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
   }
-
-  tree.Print(bpm);
-  start_key = 2;
-  current_key = start_key;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
-  }
-
-  EXPECT_EQ(size, 3);
-
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -105,84 +110,344 @@ TEST(BPlusTreeTests, DeleteTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  tree.Print(bpm);
+    tree.Print(bpm);
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
 
-  }
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  std::vector<int64_t> remove_keys = {1, 5, 3, 4};
-  for (auto key : remove_keys) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
-  }
+    std::vector<int64_t> remove_keys = {1, 5, 3, 4};
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+
+    start_key = 2;
+    current_key = start_key;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
 
-  start_key = 2;
-  current_key = start_key;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
+    tree.Print(bpm);
 
-  tree.Print(bpm);
+    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
+    EXPECT_EQ(size, 1);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
   }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
 
-  EXPECT_EQ(size, 1);
+TEST(BPlusTreeTests, ScanRangeTest) {
+  // create KeyComparator and index schema
+  std::string createStmt = "a bigint";
+  Schema *key_schema = ParseCreateStatement(createStmt);
+  GenericComparator<8> comparator(key_schema);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(500, disk_manager);
+  // create b+ tree
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> low;
+    GenericKey<8> high;
+    low.SetFromInteger(0);
+    EXPECT_TRUE(tree.ScanRange(&low, true, nullptr, true, ScanDirection::BACKWARD).isEnd());
+
+    // even keys only, so bounds can fall between two keys
+    std::set<int64_t> keys;
+    for (int64_t key = 2; key <= 400; key += 2) {
+      keys.insert(key);
+    }
+    std::vector<int64_t> shuffled(keys.begin(), keys.end());
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(11));
+    for (auto key : shuffled) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+
+    auto check = [&](int64_t lo, bool lo_inclusive, int64_t hi, bool hi_inclusive, ScanDirection direction) {
+      std::vector<int64_t> expected;
+      for (auto key : keys) {
+        if ((key > lo || (lo_inclusive && key == lo)) && (key < hi || (hi_inclusive && key == hi))) {
+          expected.push_back(key);
+        }
+      }
+      if (direction == ScanDirection::BACKWARD) {
+        std::reverse(expected.begin(), expected.end());
+      }
+      low.SetFromInteger(lo);
+      high.SetFromInteger(hi);
+      std::vector<int64_t> scanned;
+      for (auto iterator = tree.ScanRange(&low, lo_inclusive, &high, hi_inclusive, direction); !iterator.isEnd();
+           ++iterator) {
+        scanned.push_back((*iterator).second.GetSlotNum());
+      }
+      EXPECT_EQ(scanned, expected) << "[" << lo << ", " << hi << "]";
+    };
+
+    auto check_all = [&]() {
+      for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+        for (int64_t lo : {-1, 0, 2, 3, 50, 51, 398, 400, 401}) {
+          for (int64_t hi : {-1, 2, 3, 100, 101, 399, 400, 500}) {
+            check(lo, true, hi, true, direction);
+            check(lo, false, hi, false, direction);
+            check(lo, true, hi, false, direction);
+          }
+        }
+      }
+
+      // open bounds
+      std::vector<int64_t> scanned;
+      for (auto iterator = tree.ScanRange(nullptr, true, nullptr, true, ScanDirection::BACKWARD); !iterator.isEnd();
+           ++iterator) {
+        scanned.push_back((*iterator).second.GetSlotNum());
+      }
+      EXPECT_EQ(scanned, std::vector<int64_t>(keys.rbegin(), keys.rend()));
+      scanned.clear();
+      high.SetFromInteger(100);
+      for (auto iterator = tree.ScanRange(nullptr, true, &high, false); !iterator.isEnd(); ++iterator) {
+        scanned.push_back((*iterator).second.GetSlotNum());
+      }
+      EXPECT_EQ(scanned, std::vector<int64_t>(keys.begin(), keys.lower_bound(100)));
+    };
+    check_all();
+
+    // merges relink the leaves in both directions
+    for (size_t i = 0; i < shuffled.size(); i += 3) {
+      index_key.SetFromInteger(shuffled[i]);
+      tree.Remove(index_key, transaction);
+      keys.erase(shuffled[i]);
+    }
+    check_all();
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, SmallPoolTest) {
+  // create KeyComparator and index schema
+  std::string createStmt = "a bigint";
+  Schema *key_schema = ParseCreateStatement(createStmt);
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  // a deep tree in a pool barely larger than one root-to-leaf path, any pin
+  // left behind by a split or merge runs it out of frames
+  const size_t pool_size = 32;
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  // create b+ tree
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys(1000);
+    std::iota(keys.begin(), keys.end(), 1);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+    for (auto key : keys) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    }
+
+    // remove all but every fourth key
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (i % 4 != 0) {
+        index_key.SetFromInteger(keys[i]);
+        tree.Remove(index_key, transaction);
+      }
+    }
+
+    std::vector<RID> rids;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      rids.clear();
+      index_key.SetFromInteger(keys[i]);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), i % 4 == 0);
+    }
+
+    // every frame but the header one and the one of the cached root is free to use again
+    std::vector<page_id_t> pinned;
+    for (size_t i = 2; i < pool_size; ++i) {
+      page_id_t temp_page_id;
+      EXPECT_NE(nullptr, bpm->NewPage(&temp_page_id));
+      pinned.push_back(temp_page_id);
+    }
+    for (auto temp_page_id : pinned) {
+      bpm->UnpinPage(temp_page_id, false);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, LazyMergeTest) {
+  // create KeyComparator and index schema
+  std::string createStmt = "a bigint";
+  Schema *key_schema = ParseCreateStatement(createStmt);
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+  // create b+ tree
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8, true,
+                                                             MergePolicy::LAZY);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys(2000);
+    std::iota(keys.begin(), keys.end(), 1);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+    for (auto key : keys) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, rid, transaction));
+    }
 
+    std::set<int64_t> remaining(keys.begin(), keys.end());
+    auto check = [&]() {
+      std::vector<RID> rids;
+      for (int64_t key = 1; key <= 2000; ++key) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(tree.GetValue(index_key, &rids), remaining.count(key) == 1) << key;
+      }
+      std::vector<int64_t> scanned;
+      for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+        scanned.push_back((*iterator).second.GetSlotNum());
+      }
+      EXPECT_EQ(scanned, std::vector<int64_t>(remaining.begin(), remaining.end()));
+    };
+
+    // leaves drain far below half full before they are merged
+    for (size_t i = 0; i < keys.size(); ++i) {
+      if (i % 4 != 0) {
+        index_key.SetFromInteger(keys[i]);
+        tree.Remove(index_key, transaction);
+        remaining.erase(keys[i]);
+      }
+    }
+    check();
+
+    tree.Compact(transaction);
+    check();
+
+    // deleted keys come back into the compacted tree
+    for (size_t i = 0; i < keys.size(); i += 2) {
+      rid.Set(0, keys[i]);
+      index_key.SetFromInteger(keys[i]);
+      tree.Insert(index_key, rid, transaction);
+      remaining.insert(keys[i]);
+    }
+    check();
+
+    // emptying the tree works the same under both policies
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    remaining.clear();
+    check();
+    EXPECT_TRUE(tree.IsEmpty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
 
 }  // namespace bustub
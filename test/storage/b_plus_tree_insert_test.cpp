@@ -3,12 +3,18 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cstdio>
+#include <cstring>
+#include <map>
+#include <numeric>
+#include <random>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
 
 namespace bustub {
 
@@ -22,133 +28,606 @@ TEST(BPlusTreeTests, InsertTest1) {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
-    GenericKey<8> index_key;
-    RID rid;
-    // create transaction
-    Transaction *transaction = new Transaction(0);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+      GenericKey<8> index_key;
+      RID rid;
+      // create transaction
+      Transaction *transaction = new Transaction(0);
 
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
 
-    (void)header_page;
+      (void)header_page;
+
+      std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+
+      for (auto i = 0; i < 50; ++i) {
+        keys.push_back(6 + i);
+      }
+
+      for (auto key : keys) {
+        int64_t value = key & 0xFFFFFFFF;
+        rid.Set(static_cast<int32_t>(key >> 32), value);
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, rid, transaction);
+      }
+      std::vector<RID> rids;
+      std::string s;
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+        EXPECT_EQ(rids.size(), 1);
+
+        int64_t value = key & 0xFFFFFFFF;
+        EXPECT_EQ(rids[0].GetSlotNum(), value);
+      }
 
-    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+      int64_t start_key = 1;
+      int64_t current_key = start_key;
+      index_key.SetFromInteger(start_key);
+      for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+        auto location = (*iterator).second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
 
-    for (auto i = 0; i < 50; ++i)
+      EXPECT_EQ(current_key, keys.size() + 1);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+      delete transaction;
+    }
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+
+}
+
+TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+    // create KeyComparator and index schema
+    Schema *key_schema = ParseCreateStatement("a bigint");
+    GenericComparator<8> comparator(key_schema);
+
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    // create b+ tree
     {
-      keys.push_back( 6 + i);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
+      GenericKey<8> index_key;
+      RID rid;
+      // create transaction
+      Transaction *transaction = new Transaction(0);
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      std::vector<int64_t> keys = {5, 4, 3, 2, 1};
+      for (auto key : keys) {
+        int64_t value = key & 0xFFFFFFFF;
+        rid.Set(static_cast<int32_t>(key >> 32), value);
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, rid, transaction);
+      }
+
+      std::vector<RID> rids;
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+        EXPECT_EQ(rids.size(), 1);
+
+        int64_t value = key & 0xFFFFFFFF;
+        EXPECT_EQ(rids[0].GetSlotNum(), value);
+      }
+
+      int64_t start_key = 1;
+      int64_t current_key = start_key;
+      index_key.SetFromInteger(start_key);
+      for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+        auto location = (*iterator).second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
+
+      EXPECT_EQ(current_key, keys.size() + 1);
+
+      start_key = 3;
+      current_key = start_key;
+      index_key.SetFromInteger(start_key);
+      for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+        auto location = (*iterator).second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+      delete transaction;
     }
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+}
 
-    for (auto key : keys) {
-      int64_t value = key & 0xFFFFFFFF;
-      rid.Set(static_cast<int32_t>(key >> 32), value);
+TEST(BPlusTreeTests, DuplicateKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create non-unique b+ tree
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4, false);
+    GenericKey<8> index_key;
+    Transaction *transaction = new Transaction(0);
+
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // key 1..10, key k owns k * 200 rids so the hot keys need several posting pages
+    for (int64_t key = 1; key <= 10; ++key) {
       index_key.SetFromInteger(key);
-      tree.Insert(index_key, rid, transaction);
+      for (int64_t i = 0; i < key * 200; ++i) {
+        EXPECT_TRUE(tree.Insert(index_key, RID(static_cast<int32_t>(key), i), transaction));
+      }
+      // the same key & value pair is rejected
+      EXPECT_FALSE(tree.Insert(index_key, RID(static_cast<int32_t>(key), 0), transaction));
     }
+
     std::vector<RID> rids;
-    std::string s;
-    for (auto key : keys) {
+    for (int64_t key = 1; key <= 10; ++key) {
       rids.clear();
       index_key.SetFromInteger(key);
-      tree.GetValue(index_key, &rids);
-      EXPECT_EQ(rids.size(), 1);
-
-      int64_t value = key & 0xFFFFFFFF;
-      EXPECT_EQ(rids[0].GetSlotNum(), value);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids.size(), key * 200);
     }
 
-    int64_t start_key = 1;
-    int64_t current_key = start_key;
-    index_key.SetFromInteger(start_key);
+    int64_t size = 0;
+    int64_t last_key = 0;
+    index_key.SetFromInteger(1);
     for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-      auto location = (*iterator).second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
+      auto key = (*iterator).first.ToString();
+      EXPECT_GE(key, last_key);
+      EXPECT_EQ((*iterator).second.GetPageId(), key);
+      last_key = key;
+      size = size + 1;
     }
+    EXPECT_EQ(size, 200 * 55);
 
-    EXPECT_EQ(current_key, keys.size() + 1);
+    // drop every value of key 7 but one, the last value goes back into the leaf
+    index_key.SetFromInteger(7);
+    for (int64_t i = 1; i < 7 * 200; ++i) {
+      tree.Remove(index_key, RID(7, i), transaction);
+    }
+    rids.clear();
+    tree.GetValue(index_key, &rids);
+    EXPECT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), 0);
+
+    // removing a key drops its whole posting list
+    index_key.SetFromInteger(10);
+    tree.Remove(index_key, transaction);
+    rids.clear();
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
     delete key_schema;
     delete transaction;
-    delete disk_manager;
-    delete bpm;
-    remove("test.db");
-    remove("test.log");
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DuplicateKeyShuffledTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4, false);
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(1);
+    Transaction *transaction = new Transaction(0);
+
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // enough values for several posting pages, inserted out of order so pages split in the middle
+    std::vector<int64_t> slots(3000);
+    std::iota(slots.begin(), slots.end(), 0);
+    std::shuffle(slots.begin(), slots.end(), std::mt19937(445));
+    for (auto slot : slots) {
+      EXPECT_TRUE(tree.Insert(index_key, RID(1, slot), transaction));
+    }
+    for (int64_t slot = 0; slot < 3000; slot += 100) {
+      EXPECT_FALSE(tree.Insert(index_key, RID(1, slot), transaction));
+    }
 
+    // the posting list hands values back sorted
+    std::vector<RID> rids;
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 3000);
+    for (int64_t slot = 0; slot < 3000; ++slot) {
+      EXPECT_EQ(rids[slot].GetSlotNum(), slot);
+    }
+
+    // drop the odd slots, then the largest ones so the tail page goes away
+    for (int64_t slot = 1; slot < 3000; slot += 2) {
+      tree.Remove(index_key, RID(1, slot), transaction);
+    }
+    for (int64_t slot = 2998; slot >= 2000; slot -= 2) {
+      tree.Remove(index_key, RID(1, slot), transaction);
+    }
+    // appending past the new tail still works
+    EXPECT_TRUE(tree.Insert(index_key, RID(1, 5000), transaction));
+    EXPECT_FALSE(tree.Insert(index_key, RID(1, 5000), transaction));
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1001);
+    for (int64_t i = 0; i < 1000; ++i) {
+      EXPECT_EQ(rids[i].GetSlotNum(), 2 * i);
+    }
+    EXPECT_EQ(rids[1000].GetSlotNum(), 5000);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
-    // create KeyComparator and index schema
-    Schema *key_schema = ParseCreateStatement("a bigint");
-    GenericComparator<8> comparator(key_schema);
+TEST(BPlusTreeTests, GetValuesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
 
-    DiskManager *disk_manager = new DiskManager("test.db");
-    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
-    // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2,3);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(5000, disk_manager);
+  // create non-unique b+ tree
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4, false);
     GenericKey<8> index_key;
-    RID rid;
-    // create transaction
     Transaction *transaction = new Transaction(0);
 
-    // create and fetch header_page
     page_id_t page_id;
     auto header_page = bpm->NewPage(&page_id);
     (void)header_page;
 
-    std::vector<int64_t> keys = {5, 4, 3, 2, 1};
-    for (auto key : keys) {
-      int64_t value = key & 0xFFFFFFFF;
-      rid.Set(static_cast<int32_t>(key >> 32), value);
+    // probing an empty tree
+    std::vector<GenericKey<8>> probes;
+    index_key.SetFromInteger(1);
+    probes.push_back(index_key);
+    std::vector<std::vector<RID>> results;
+    tree.GetValues(probes, &results);
+    ASSERT_EQ(results.size(), 1);
+    EXPECT_TRUE(results[0].empty());
+
+    // even keys only, key k owns k % 3 + 1 rids
+    for (int64_t key = 0; key < 2000; key += 2) {
       index_key.SetFromInteger(key);
-      tree.Insert(index_key, rid, transaction);
+      for (int64_t i = 0; i <= key % 3; ++i) {
+        tree.Insert(index_key, RID(static_cast<int32_t>(key), i), transaction);
+      }
+    }
+
+    // unordered probes with repeated and missing keys, then a clustered batch
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int64_t> dist(-10, 2010);
+    std::vector<int64_t> probe_keys;
+    for (int i = 0; i < 3000; ++i) {
+      probe_keys.push_back(dist(gen));
+    }
+    for (int64_t key = 500; key < 700; ++key) {
+      probe_keys.push_back(key);
     }
 
+    probes.clear();
+    for (auto key : probe_keys) {
+      index_key.SetFromInteger(key);
+      probes.push_back(index_key);
+    }
+    tree.GetValues(probes, &results);
+    ASSERT_EQ(results.size(), probes.size());
+    for (size_t i = 0; i < probes.size(); ++i) {
+      std::vector<RID> expected;
+      tree.GetValue(probes[i], &expected);
+      std::sort(expected.begin(), expected.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+      std::sort(results[i].begin(), results[i].end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+      EXPECT_EQ(results[i], expected) << probe_keys[i];
+      bool exists = probe_keys[i] >= 0 && probe_keys[i] < 2000 && probe_keys[i] % 2 == 0;
+      EXPECT_EQ(results[i].size(), exists ? probe_keys[i] % 3 + 1 : 0);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, RootCacheTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    Transaction *transaction = new Transaction(0);
+
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    auto root_pin_count = [&]() {
+      page_id_t root_page_id = tree.GetRootPageId();
+      if (root_page_id == INVALID_PAGE_ID) {
+        return 0;
+      }
+      auto root_page = bpm->FetchPage(root_page_id);
+      int pin_count = root_page->GetPinCount() - 1;
+      bpm->UnpinPage(root_page_id, false);
+      return pin_count;
+    };
+
+    // a leaf root is fetched like any leaf
+    index_key.SetFromInteger(1);
+    tree.Insert(index_key, RID(0, 1), transaction);
+    EXPECT_EQ(root_pin_count(), 0);
+
+    // an internal root stays pinned by the tree, through every root split
+    for (int64_t key = 2; key <= 500; ++key) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+      ASSERT_LE(root_pin_count(), 1) << key;
+    }
+    EXPECT_EQ(root_pin_count(), 1);
+
     std::vector<RID> rids;
-    for (auto key : keys) {
+    for (int64_t key = 1; key <= 500; ++key) {
       rids.clear();
       index_key.SetFromInteger(key);
-      tree.GetValue(index_key, &rids);
-      EXPECT_EQ(rids.size(), 1);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+    }
+    EXPECT_EQ(root_pin_count(), 1);
 
-      int64_t value = key & 0xFFFFFFFF;
-      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    // and through every root merge, down to a leaf root again
+    for (int64_t key = 500; key > 1; --key) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+      ASSERT_LE(root_pin_count(), 1) << key;
     }
+    EXPECT_EQ(root_pin_count(), 0);
+    rids.clear();
+    index_key.SetFromInteger(1);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
 
-    int64_t start_key = 1;
-    int64_t current_key = start_key;
-    index_key.SetFromInteger(start_key);
-    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-      auto location = (*iterator).second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete key_schema;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, RootUnpinOnDestroyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  const size_t pool_size = 50;
+  BufferPoolManager *bpm = new BufferPoolManager(pool_size, disk_manager);
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  page_id_t root_page_id;
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    for (int64_t key = 1; key <= 200; ++key) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
     }
+    root_page_id = tree.GetRootPageId();
+    auto root_page = bpm->FetchPage(root_page_id);
+    EXPECT_EQ(root_page->GetPinCount(), 2);
+    bpm->UnpinPage(root_page_id, false);
+  }
 
-    EXPECT_EQ(current_key, keys.size() + 1);
+  // the tree gave its root back, keeping the changes made through the cached pointer
+  auto root_page = bpm->FetchPage(root_page_id);
+  EXPECT_EQ(root_page->GetPinCount(), 1);
+  EXPECT_TRUE(root_page->IsDirty());
+  bpm->UnpinPage(root_page_id, false);
 
-    start_key = 3;
-    current_key = start_key;
-    index_key.SetFromInteger(start_key);
-    for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
-      auto location = (*iterator).second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
+  // so every frame can be reused once the header goes too
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  for (size_t i = 0; i < pool_size; ++i) {
+    EXPECT_NE(bpm->NewPage(&page_id), nullptr) << i;
+  }
+
+  delete transaction;
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, RootCheckpointTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+    GenericKey<8> index_key;
+    Transaction *transaction = new Transaction(0);
+
+    page_id_t page_id;
+    auto header_page = static_cast<HeaderPage *>(bpm->NewPage(&page_id));
+    page_id_t root_id;
+
+    // root changes stay in memory
+    for (int64_t key = 1; key <= 100; ++key) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
     }
+    EXPECT_FALSE(header_page->GetRootId("foo_pk", &root_id));
+
+    // until the checkpoint writes the latest one
+    EXPECT_TRUE(tree.FlushRootPageId());
+    EXPECT_EQ(header_page->GetRecordCount(), 1);
+    EXPECT_TRUE(header_page->GetRootId("foo_pk", &root_id));
+    EXPECT_EQ(root_id, tree.GetRootPageId());
+
+    for (int64_t key = 100; key > 1; --key) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+    EXPECT_TRUE(header_page->GetRootId("foo_pk", &root_id));
+    EXPECT_NE(root_id, tree.GetRootPageId());
+    EXPECT_TRUE(tree.FlushRootPageId());
+    EXPECT_TRUE(header_page->GetRootId("foo_pk", &root_id));
+    EXPECT_EQ(root_id, tree.GetRootPageId());
+    EXPECT_EQ(header_page->GetRecordCount(), 1);
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
     delete transaction;
-    delete disk_manager;
-    delete bpm;
-    remove("test.db");
-    remove("test.log");
+    delete key_schema;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, PrefixCompressionTest) {
+  // eight bigint columns fill the whole GenericKey<64>
+  Schema *key_schema = ParseCreateStatement("a bigint,b bigint,c bigint,d bigint,e bigint,f bigint,g bigint,h bigint");
+  GenericComparator<64> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(5000, disk_manager);
+  {
+    BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+    Transaction *transaction = new Transaction(0);
 
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    using Columns = std::array<int64_t, 8>;
+    auto make_key = [](const Columns &columns) {
+      GenericKey<64> key;
+      memcpy(key.data_, columns.data(), sizeof(key.data_));
+      return key;
+    };
+    std::map<Columns, RID> expected;
+    auto check_tree = [&]() {
+      std::vector<RID> rids;
+      for (const auto &pair : expected) {
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(make_key(pair.first), &rids));
+        ASSERT_EQ(rids.size(), 1);
+        EXPECT_EQ(rids[0], pair.second);
+      }
+      auto expected_iter = expected.begin();
+      for (auto iterator = tree.Begin(make_key(expected.begin()->first)); iterator != tree.end(); ++iterator) {
+        ASSERT_NE(expected_iter, expected.end());
+        EXPECT_EQ(comparator((*iterator).first, make_key(expected_iter->first)), 0);
+        EXPECT_EQ((*iterator).second, expected_iter->second);
+        ++expected_iter;
+      }
+      EXPECT_EQ(expected_iter, expected.end());
+    };
+
+    // keys share the first seven columns, only the low bytes of h differ
+    std::mt19937_64 random(15445);
+    std::vector<int64_t> hs(10000);
+    std::iota(hs.begin(), hs.end(), 0);
+    std::shuffle(hs.begin(), hs.end(), random);
+    for (auto h : hs) {
+      Columns columns{7, 7, 7, 7, 7, 7, 7, h};
+      RID rid(0, static_cast<uint32_t>(h));
+      EXPECT_TRUE(tree.Insert(make_key(columns), rid, transaction));
+      expected[columns] = rid;
+    }
+    check_tree();
+    // keys that share the page prefix but are not there, on either side and in between
+    std::vector<RID> missing;
+    for (int64_t h : {int64_t{-1}, int64_t{10000}, int64_t{1} << 40}) {
+      EXPECT_FALSE(tree.GetValue(make_key(Columns{7, 7, 7, 7, 7, 7, 7, h}), &missing)) << h;
+    }
+    EXPECT_FALSE(tree.GetValue(make_key(Columns{7, 7, 7, 7, 7, 7, 8, 0}), &missing));
+
+    // uncompressed leaves hold at most 56 of these keys
+    page_id_t next_page_id;
+    bpm->NewPage(&next_page_id);
+    bpm->UnpinPage(next_page_id, false);
+    EXPECT_LT(next_page_id, 10000 / 56);
+
+    // keys sharing nothing force pages back to full width and split them early
+    for (int64_t i = 0; i < 2000; ++i) {
+      Columns columns;
+      for (auto &column : columns) {
+        column = static_cast<int64_t>(random());
+      }
+      columns[0] = 7;
+      RID rid(1, static_cast<uint32_t>(i));
+      EXPECT_TRUE(tree.Insert(make_key(columns), rid, transaction));
+      expected[columns] = rid;
+    }
+    check_tree();
+
+    // remove most keys, merges must respect the bytes left in each page
+    std::vector<Columns> keys;
+    for (const auto &pair : expected) {
+      keys.push_back(pair.first);
+    }
+    std::shuffle(keys.begin(), keys.end(), random);
+    keys.resize(keys.size() * 9 / 10);
+    for (const auto &columns : keys) {
+      tree.Remove(make_key(columns), transaction);
+      expected.erase(columns);
+    }
+    check_tree();
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
 }
 }  // namespace bustub
 
@@ -66,55 +66,58 @@ TEST(BptTreeTest, UnitTest) {
   page_id_t page_id;
   auto header_page = bpm->NewPage(&page_id);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-  while (!quit) {
-    std::cout << "> ";
-    std::cin >> instruction;
-    switch (instruction) {
-      case 'c':
-        std::cin >> filename;
-        tree.RemoveFromFile(filename, transaction);
-        break;
-      case 'd':
-        std::cin >> key;
-        index_key.SetFromInteger(key);
-        tree.Remove(index_key, transaction);
-        break;
-      case 'i':
-        std::cin >> key;
-        rid.Set(static_cast<int32_t>(key >> 32), static_cast<int>(key & 0xFFFFFFFF));
-        index_key.SetFromInteger(key);
-        tree.Insert(index_key, rid, transaction);
-        break;
-      case 'f':
-        std::cin >> filename;
-        tree.InsertFromFile(filename, transaction);
-        break;
-      case 'q':
-        quit = true;
-        break;
-      case 'p':
-        tree.Print(bpm);
-        break;
-      case 'g':
-        std::cin >> filename;
-        tree.Draw(bpm, filename);
-        break;
-      case '?':
-        std::cout << usageMessage();
-        break;
-      default:
-        std::cin.ignore(256, '\n');
-        std::cout << usageMessage();
-        break;
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                             internal_max_size);
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+    while (!quit) {
+      std::cout << "> ";
+      std::cin >> instruction;
+      switch (instruction) {
+        case 'c':
+          std::cin >> filename;
+          tree.RemoveFromFile(filename, transaction);
+          break;
+        case 'd':
+          std::cin >> key;
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, transaction);
+          break;
+        case 'i':
+          std::cin >> key;
+          rid.Set(static_cast<int32_t>(key >> 32), static_cast<int>(key & 0xFFFFFFFF));
+          index_key.SetFromInteger(key);
+          tree.Insert(index_key, rid, transaction);
+          break;
+        case 'f':
+          std::cin >> filename;
+          tree.InsertFromFile(filename, transaction);
+          break;
+        case 'q':
+          quit = true;
+          break;
+        case 'p':
+          tree.Print(bpm);
+          break;
+        case 'g':
+          std::cin >> filename;
+          tree.Draw(bpm, filename);
+          break;
+        case '?':
+          std::cout << usageMessage();
+          break;
+        default:
+          std::cin.ignore(256, '\n');
+          std::cout << usageMessage();
+          break;
+      }
     }
+    bpm->UnpinPage(header_page->GetPageId(), true);
+    delete key_schema;
+    delete transaction;
   }
-  bpm->UnpinPage(header_page->GetPageId(), true);
-  delete key_schema;
   delete bpm;
-  delete transaction;
   delete disk_manager;
   remove("test.db");
   remove("test.log");
@@ -26,53 +26,55 @@ TEST(BPlusTreeTests, SplitTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 2, 3);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    // insert into repetitive key, all failed
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(false, tree.Insert(index_key, rid, transaction));
+    }
+    index_key.SetFromInteger(1);
+    auto leaf_node =
+        reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(tree.FindLeafPage(index_key));
+    ASSERT_NE(nullptr, leaf_node);
+    EXPECT_EQ(1, leaf_node->GetSize());
+    EXPECT_EQ(2, leaf_node->GetMaxSize());
+
+    // Check the next 4 pages
+    tree.Print(bpm);
+
+    for (int i = 0; i < 4; i++) {
+       EXPECT_NE(INVALID_PAGE_ID, leaf_node->GetNextPageId());
+      leaf_node = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
+          bpm->FetchPage(leaf_node->GetNextPageId()));
+    }
+
+    EXPECT_EQ(INVALID_PAGE_ID, leaf_node->GetNextPageId());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
   }
-  // insert into repetitive key, all failed
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    EXPECT_EQ(false, tree.Insert(index_key, rid, transaction));
-  }
-  index_key.SetFromInteger(1);
-  auto leaf_node =
-      reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(tree.FindLeafPage(index_key));
-  ASSERT_NE(nullptr, leaf_node);
-  EXPECT_EQ(1, leaf_node->GetSize());
-  EXPECT_EQ(2, leaf_node->GetMaxSize());
-
-  // Check the next 4 pages
-  tree.Print(bpm);
-
-  for (int i = 0; i < 4; i++) {
-     EXPECT_NE(INVALID_PAGE_ID, leaf_node->GetNextPageId());
-    leaf_node = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(
-        bpm->FetchPage(leaf_node->GetNextPageId()));
-  }
-
-  EXPECT_EQ(INVALID_PAGE_ID, leaf_node->GetNextPageId());
-
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   delete key_schema;
   remove("test.db");
   remove("test.log");
@@ -92,41 +94,43 @@ TEST(BPlusTreeTests, InsertTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
-
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
-
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
+
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
   }
-
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -145,41 +149,43 @@ TEST(BPlusTreeTests, InsertTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {5, 4, 3, 2, 1};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {5, 4, 3, 2, 1};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
+
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
   }
-
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
-
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
-
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -198,47 +204,49 @@ TEST(BPlusTreeTests, ScaleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  int64_t scale = 10000;
-  std::vector<int64_t> keys;
-  for (int64_t key = 1; key < scale; key++) {
-    keys.push_back(key);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    int64_t scale = 10000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key < scale; key++) {
+      keys.push_back(key);
+    }
+
+    // randomized the insertion order
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
+
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
   }
-
-  // randomized the insertion order
-  auto rng = std::default_random_engine{};
-  std::shuffle(keys.begin(), keys.end(), rng);
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
-
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
-
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -132,47 +132,49 @@ void InsertTest1Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-    // keys to Insert
-    std::vector<int64_t> keys;
-    int64_t scale_factor = 100;
-    for (int64_t key = 1; key < scale_factor; key++) {
-      keys.push_back(key);
-    }
-    LaunchParallelTest(2, 0, InsertHelper, &tree, keys);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      // keys to Insert
+      std::vector<int64_t> keys;
+      int64_t scale_factor = 100;
+      for (int64_t key = 1; key < scale_factor; key++) {
+        keys.push_back(key);
+      }
+      LaunchParallelTest(2, 0, InsertHelper, &tree, keys);
+
+      std::vector<RID> rids;
+      GenericKey<8> index_key;
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+        EXPECT_EQ(rids.size(), 1);
+
+        int64_t value = key & 0xFFFFFFFF;
+        EXPECT_EQ(rids[0].GetSlotNum(), value);
+      }
 
-    std::vector<RID> rids;
-    GenericKey<8> index_key;
-    for (auto key : keys) {
-      rids.clear();
-      index_key.SetFromInteger(key);
-      tree.GetValue(index_key, &rids);
-      EXPECT_EQ(rids.size(), 1);
+      int64_t start_key = 1;
+      int64_t current_key = start_key;
 
-      int64_t value = key & 0xFFFFFFFF;
-      EXPECT_EQ(rids[0].GetSlotNum(), value);
-    }
+      for (auto &pair : tree) {
+        auto location = pair.second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
 
-    int64_t start_key = 1;
-    int64_t current_key = start_key;
+      EXPECT_EQ(current_key, keys.size() + 1);
 
-    for (auto &pair : tree) {
-      auto location = pair.second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
     }
-
-    EXPECT_EQ(current_key, keys.size() + 1);
-
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -187,47 +189,49 @@ void InsertTest2Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-    // keys to Insert
-    std::vector<int64_t> keys;
-    int64_t scale_factor = 1000;
-    for (int64_t key = 1; key < scale_factor; key++) {
-      keys.push_back(key);
-    }
-    LaunchParallelTest(2, 0, InsertHelperSplit, &tree, keys, 2);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      // keys to Insert
+      std::vector<int64_t> keys;
+      int64_t scale_factor = 1000;
+      for (int64_t key = 1; key < scale_factor; key++) {
+        keys.push_back(key);
+      }
+      LaunchParallelTest(2, 0, InsertHelperSplit, &tree, keys, 2);
+
+      std::vector<RID> rids;
+      GenericKey<8> index_key;
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+        EXPECT_EQ(rids.size(), 1);
+
+        int64_t value = key & 0xFFFFFFFF;
+        EXPECT_EQ(rids[0].GetSlotNum(), value);
+      }
 
-    std::vector<RID> rids;
-    GenericKey<8> index_key;
-    for (auto key : keys) {
-      rids.clear();
-      index_key.SetFromInteger(key);
-      tree.GetValue(index_key, &rids);
-      EXPECT_EQ(rids.size(), 1);
+      int64_t start_key = 1;
+      int64_t current_key = start_key;
 
-      int64_t value = key & 0xFFFFFFFF;
-      EXPECT_EQ(rids[0].GetSlotNum(), value);
-    }
+      for (auto &pair : tree) {
+        auto location = pair.second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+      }
 
-    int64_t start_key = 1;
-    int64_t current_key = start_key;
+      EXPECT_EQ(current_key, keys.size() + 1);
 
-    for (auto &pair : tree) {
-      auto location = pair.second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
     }
-
-    EXPECT_EQ(current_key, keys.size() + 1);
-
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -242,36 +246,38 @@ void DeleteTest1Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-    // sequential insert
-    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-    InsertHelper(&tree, keys, 1);
-
-    std::vector<int64_t> remove_keys = {1, 5, 3, 4};
-    LaunchParallelTest(2, 1, DeleteHelper, &tree, remove_keys);
-
-    int64_t start_key = 2;
-    int64_t current_key = start_key;
-    int64_t size = 0;
-
-    for (auto &pair : tree) {
-      auto location = pair.second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
-      size = size + 1;
-    }
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      // sequential insert
+      std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+      InsertHelper(&tree, keys, 1);
+
+      std::vector<int64_t> remove_keys = {1, 5, 3, 4};
+      LaunchParallelTest(2, 1, DeleteHelper, &tree, remove_keys);
+
+      int64_t start_key = 2;
+      int64_t current_key = start_key;
+      int64_t size = 0;
+
+      for (auto &pair : tree) {
+        auto location = pair.second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+        size = size + 1;
+      }
 
-    EXPECT_EQ(size, 1);
+      EXPECT_EQ(size, 1);
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -286,37 +292,39 @@ void DeleteTest2Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-
-    // sequential insert
-    std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
-    InsertHelper(&tree, keys, 1);
-
-    std::vector<int64_t> remove_keys = {1, 4, 3, 2, 5, 6};
-    LaunchParallelTest(2, 1, DeleteHelperSplit, &tree, remove_keys, 2);
-
-    int64_t start_key = 7;
-    int64_t current_key = start_key;
-    int64_t size = 0;
-
-    for (auto &pair : tree) {
-      auto location = pair.second;
-      EXPECT_EQ(location.GetPageId(), 0);
-      EXPECT_EQ(location.GetSlotNum(), current_key);
-      current_key = current_key + 1;
-      size = size + 1;
-    }
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // sequential insert
+      std::vector<int64_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+      InsertHelper(&tree, keys, 1);
+
+      std::vector<int64_t> remove_keys = {1, 4, 3, 2, 5, 6};
+      LaunchParallelTest(2, 1, DeleteHelperSplit, &tree, remove_keys, 2);
+
+      int64_t start_key = 7;
+      int64_t current_key = start_key;
+      int64_t size = 0;
+
+      for (auto &pair : tree) {
+        auto location = pair.second;
+        EXPECT_EQ(location.GetPageId(), 0);
+        EXPECT_EQ(location.GetSlotNum(), current_key);
+        current_key = current_key + 1;
+        size = size + 1;
+      }
 
-    EXPECT_EQ(size, 4);
+      EXPECT_EQ(size, 4);
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -331,54 +339,56 @@ void MixTest1Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-    // first, populate index
-    std::vector<int64_t> for_insert;
-    std::vector<int64_t> for_delete;
-    size_t sieve = 2; // divide evenly
-    size_t total_keys = 1000;
-    for (size_t i = 1; i <= total_keys; i++) {
-      if (i % sieve == 0) {
-        for_insert.push_back(i);
-      } else {
-        for_delete.push_back(i);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      // first, populate index
+      std::vector<int64_t> for_insert;
+      std::vector<int64_t> for_delete;
+      size_t sieve = 2;  // divide evenly
+      size_t total_keys = 1000;
+      for (size_t i = 1; i <= total_keys; i++) {
+        if (i % sieve == 0) {
+          for_insert.push_back(i);
+        } else {
+          for_delete.push_back(i);
+        }
+      }
+      // Insert all the keys to delete
+      InsertHelper(&tree, for_delete, 1);
+
+      auto insert_task = [&](int tid) { InsertHelper(&tree, for_insert, tid); };
+      auto delete_task = [&](int tid) { DeleteHelper(&tree, for_delete, tid); };
+      std::vector<std::function<void(int)>> tasks;
+      tasks.emplace_back(insert_task);
+      tasks.emplace_back(delete_task);
+      std::vector<std::thread> threads;
+      size_t num_threads = 10;
+      for (size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+      }
+      for (size_t i = 0; i < num_threads; i++) {
+        threads[i].join();
       }
-    }
-    // Insert all the keys to delete
-    InsertHelper(&tree, for_delete, 1);
-
-    auto insert_task = [&](int tid) { InsertHelper(&tree, for_insert, tid); };
-    auto delete_task = [&](int tid) { DeleteHelper(&tree, for_delete, tid); };
-    std::vector<std::function<void(int)>> tasks;
-    tasks.emplace_back(insert_task);
-    tasks.emplace_back(delete_task);
-    std::vector<std::thread> threads;
-    size_t num_threads = 10;
-    for (size_t i = 0; i < num_threads; i++) {
-      threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
-    }
-    for (size_t i = 0; i < num_threads; i++) {
-      threads[i].join();
-    }
 
-    int64_t size = 0;
+      int64_t size = 0;
 
-    for (auto &pair : tree) {
-      EXPECT_EQ((pair.first).ToString(), for_insert[size]);
-      size++;
-    }
+      for (auto &pair : tree) {
+        EXPECT_EQ((pair.first).ToString(), for_insert[size]);
+        size++;
+      }
 
-    EXPECT_EQ(size, for_insert.size());
+      EXPECT_EQ(size, for_insert.size());
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -393,61 +403,63 @@ void MixTest2Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-
-    // Add perserved_keys
-    std::vector<int64_t> perserved_keys;
-    std::vector<int64_t> dynamic_keys;
-    size_t total_keys = 3000;
-    size_t sieve = 5;
-    for (size_t i = 1; i <= total_keys; i++) {
-      if (i % sieve == 0) {
-        perserved_keys.push_back(i);
-      } else {
-        dynamic_keys.push_back(i);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // Add perserved_keys
+      std::vector<int64_t> perserved_keys;
+      std::vector<int64_t> dynamic_keys;
+      size_t total_keys = 3000;
+      size_t sieve = 5;
+      for (size_t i = 1; i <= total_keys; i++) {
+        if (i % sieve == 0) {
+          perserved_keys.push_back(i);
+        } else {
+          dynamic_keys.push_back(i);
+        }
+      }
+      InsertHelper(&tree, perserved_keys, 1);
+      // Check there are 1000 keys in there
+      size_t size;
+
+      auto insert_task = [&](int tid) { InsertHelper(&tree, dynamic_keys, tid); };
+      auto delete_task = [&](int tid) { DeleteHelper(&tree, dynamic_keys, tid); };
+      auto lookup_task = [&](int tid) { LookupHelper(&tree, perserved_keys, tid); };
+
+      std::vector<std::thread> threads;
+      std::vector<std::function<void(int)>> tasks;
+      tasks.emplace_back(insert_task);
+      tasks.emplace_back(delete_task);
+      tasks.emplace_back(lookup_task);
+
+      size_t num_threads = 6;
+      for (size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+      }
+      for (size_t i = 0; i < num_threads; i++) {
+        threads[i].join();
       }
-    }
-    InsertHelper(&tree, perserved_keys, 1);
-    // Check there are 1000 keys in there
-    size_t size;
-
-    auto insert_task = [&](int tid) { InsertHelper(&tree, dynamic_keys, tid); };
-    auto delete_task = [&](int tid) { DeleteHelper(&tree, dynamic_keys, tid); };
-    auto lookup_task = [&](int tid) { LookupHelper(&tree, perserved_keys, tid); };
-
-    std::vector<std::thread> threads;
-    std::vector<std::function<void(int)>> tasks;
-    tasks.emplace_back(insert_task);
-    tasks.emplace_back(delete_task);
-    tasks.emplace_back(lookup_task);
-
-    size_t num_threads = 6;
-    for (size_t i = 0; i < num_threads; i++) {
-      threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
-    }
-    for (size_t i = 0; i < num_threads; i++) {
-      threads[i].join();
-    }
 
-    // Check all reserved keys exist
-    size = 0;
+      // Check all reserved keys exist
+      size = 0;
 
-    for (auto &pair : tree) {
-      if ((pair.first).ToString() % sieve == 0) {
-        size++;
+      for (auto &pair : tree) {
+        if ((pair.first).ToString() % sieve == 0) {
+          size++;
+        }
       }
-    }
 
-    EXPECT_EQ(size, perserved_keys.size());
+      EXPECT_EQ(size, perserved_keys.size());
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -462,53 +474,55 @@ void MixTest3Call() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-    // first, populate index
-    std::vector<int64_t> for_insert;
-    std::vector<int64_t> for_delete;
-    size_t total_keys = 1000;
-    for (size_t i = 1; i <= total_keys; i++) {
-      if (i > 500) {
-        for_insert.push_back(i);
-      } else {
-        for_delete.push_back(i);
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      // first, populate index
+      std::vector<int64_t> for_insert;
+      std::vector<int64_t> for_delete;
+      size_t total_keys = 1000;
+      for (size_t i = 1; i <= total_keys; i++) {
+        if (i > 500) {
+          for_insert.push_back(i);
+        } else {
+          for_delete.push_back(i);
+        }
+      }
+      // Insert all the keys to delete
+      InsertHelper(&tree, for_delete, 1);
+
+      auto insert_task = [&](int tid) { InsertHelper(&tree, for_insert, tid); };
+      auto delete_task = [&](int tid) { DeleteHelper(&tree, for_delete, tid); };
+      std::vector<std::function<void(int)>> tasks;
+      tasks.emplace_back(insert_task);
+      tasks.emplace_back(delete_task);
+      std::vector<std::thread> threads;
+      size_t num_threads = 10;
+      for (size_t i = 0; i < num_threads; i++) {
+        threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+      }
+      for (size_t i = 0; i < num_threads; i++) {
+        threads[i].join();
       }
-    }
-    // Insert all the keys to delete
-    InsertHelper(&tree, for_delete, 1);
-
-    auto insert_task = [&](int tid) { InsertHelper(&tree, for_insert, tid); };
-    auto delete_task = [&](int tid) { DeleteHelper(&tree, for_delete, tid); };
-    std::vector<std::function<void(int)>> tasks;
-    tasks.emplace_back(insert_task);
-    tasks.emplace_back(delete_task);
-    std::vector<std::thread> threads;
-    size_t num_threads = 10;
-    for (size_t i = 0; i < num_threads; i++) {
-      threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
-    }
-    for (size_t i = 0; i < num_threads; i++) {
-      threads[i].join();
-    }
 
-    int64_t size = 0;
+      int64_t size = 0;
 
-    for (auto &pair : tree) {
-      EXPECT_EQ((pair.first).ToString(), for_insert[size]);
-      size++;
-    }
+      for (auto &pair : tree) {
+        EXPECT_EQ((pair.first).ToString(), for_insert[size]);
+        size++;
+      }
 
-    EXPECT_EQ(size, for_insert.size());
+      EXPECT_EQ(size, for_insert.size());
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
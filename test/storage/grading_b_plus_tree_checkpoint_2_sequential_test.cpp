@@ -25,52 +25,54 @@ TEST(BPlusTreeTests, InsertTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -88,62 +90,64 @@ TEST(BPlusTreeTests, InsertTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {5, 4, 3, 2, 1};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {5, 4, 3, 2, 1};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  start_key = 3;
-  current_key = start_key;
-  index_key.SetFromInteger(start_key);
-  for (auto iterator = tree.Begin(index_key); !iterator.isEnd(); ++iterator) {
-    auto location = (*iterator).second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    start_key = 3;
+    current_key = start_key;
+    index_key.SetFromInteger(start_key);
+    for (auto iterator = tree.Begin(index_key); !iterator.isEnd(); ++iterator) {
+      auto location = (*iterator).second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -163,71 +167,73 @@ TEST(BPlusTreeTests, DeleteTest1) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  std::vector<int64_t> remove_keys = {1, 5};
-  for (auto key : remove_keys) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
-  }
+    std::vector<int64_t> remove_keys = {1, 5};
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
 
-  start_key = 2;
-  current_key = start_key;
-  int64_t size = 0;
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
-  }
+    start_key = 2;
+    current_key = start_key;
+    int64_t size = 0;
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 3);
+    EXPECT_EQ(size, 3);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -245,72 +251,74 @@ TEST(BPlusTreeTests, DeleteTest2) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  std::vector<int64_t> keys = {1, 2, 3, 4, 5};
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys = {1, 2, 3, 4, 5};
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
 
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  index_key.SetFromInteger(start_key);
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-  }
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    index_key.SetFromInteger(start_key);
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+    }
 
-  EXPECT_EQ(current_key, keys.size() + 1);
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  std::vector<int64_t> remove_keys = {1, 5, 3, 4};
-  for (auto key : remove_keys) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
-  }
+    std::vector<int64_t> remove_keys = {1, 5, 3, 4};
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
 
-  start_key = 2;
-  current_key = start_key;
-  int64_t size = 0;
-  for (auto pair : tree) {
-    auto location = pair.second;
-    EXPECT_EQ(location.GetPageId(), 0);
-    EXPECT_EQ(location.GetSlotNum(), current_key);
-    current_key = current_key + 1;
-    size = size + 1;
-  }
+    start_key = 2;
+    current_key = start_key;
+    int64_t size = 0;
+    for (auto pair : tree) {
+      auto location = pair.second;
+      EXPECT_EQ(location.GetPageId(), 0);
+      EXPECT_EQ(location.GetSlotNum(), current_key);
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 1);
+    EXPECT_EQ(size, 1);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -329,75 +337,77 @@ TEST(BPlusTreeTests, ScaleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(30, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-
-  int64_t scale = 10000;
-  std::vector<int64_t> keys;
-  for (int64_t key = 1; key < scale; key++) {
-    keys.push_back(key);
-  }
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    int64_t scale = 10000;
+    std::vector<int64_t> keys;
+    for (int64_t key = 1; key < scale; key++) {
+      keys.push_back(key);
+    }
 
-  for (auto key : keys) {
-    int64_t value = key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(key >> 32), value);
-    index_key.SetFromInteger(key);
-    tree.Insert(index_key, rid, transaction);
-  }
-  std::vector<RID> rids;
-  for (auto key : keys) {
-    rids.clear();
-    index_key.SetFromInteger(key);
-    tree.GetValue(index_key, &rids);
-    EXPECT_EQ(rids.size(), 1);
-
-    int64_t value = key & 0xFFFFFFFF;
-    EXPECT_EQ(rids[0].GetSlotNum(), value);
-  }
+    for (auto key : keys) {
+      int64_t value = key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(key >> 32), value);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid, transaction);
+    }
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      tree.GetValue(index_key, &rids);
+      EXPECT_EQ(rids.size(), 1);
+
+      int64_t value = key & 0xFFFFFFFF;
+      EXPECT_EQ(rids[0].GetSlotNum(), value);
+    }
 
-  int64_t start_key = 1;
-  int64_t current_key = start_key;
-  for (auto pair : tree) {
-    (void)pair;
-    current_key = current_key + 1;
-  }
-  EXPECT_EQ(current_key, keys.size() + 1);
+    int64_t start_key = 1;
+    int64_t current_key = start_key;
+    for (auto pair : tree) {
+      (void)pair;
+      current_key = current_key + 1;
+    }
+    EXPECT_EQ(current_key, keys.size() + 1);
 
-  int64_t remove_scale = 9900;
-  std::vector<int64_t> remove_keys;
-  for (int64_t key = 1; key < remove_scale; key++) {
-    remove_keys.push_back(key);
-  }
-  // std::shuffle(remove_keys.begin(), remove_keys.end());
-  for (auto key : remove_keys) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
-  }
+    int64_t remove_scale = 9900;
+    std::vector<int64_t> remove_keys;
+    for (int64_t key = 1; key < remove_scale; key++) {
+      remove_keys.push_back(key);
+    }
+    // std::shuffle(remove_keys.begin(), remove_keys.end());
+    for (auto key : remove_keys) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
 
-  start_key = 9900;
-  current_key = start_key;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto pair : tree) {
-    (void)pair;
-    current_key = current_key + 1;
-    size = size + 1;
-  }
+    start_key = 9900;
+    current_key = start_key;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
+    for (auto pair : tree) {
+      (void)pair;
+      current_key = current_key + 1;
+      size = size + 1;
+    }
 
-  EXPECT_EQ(size, 100);
+    EXPECT_EQ(size, 100);
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -418,67 +428,69 @@ TEST(BPlusTreeTests, SequentialMixTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
-  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-  GenericKey<8> index_key;
-  RID rid;
-  // create transaction
-  Transaction *transaction = new Transaction(0);
-
-  // create and fetch header_page
-  page_id_t page_id;
-  auto header_page = bpm->NewPage(&page_id);
-  (void)header_page;
-  // first, populate index
-  std::vector<int64_t> for_insert;
-  std::vector<int64_t> for_delete;
-  size_t sieve = 2; // divide evenly
-  size_t total_keys = 1000;
-  for (size_t i = 1; i <= total_keys; i++) {
-    if (i % sieve == 0) {
-      for_insert.push_back(i);
-    } else {
-      for_delete.push_back(i);
+  {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    GenericKey<8> index_key;
+    RID rid;
+    // create transaction
+    Transaction *transaction = new Transaction(0);
+
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    // first, populate index
+    std::vector<int64_t> for_insert;
+    std::vector<int64_t> for_delete;
+    size_t sieve = 2;  // divide evenly
+    size_t total_keys = 1000;
+    for (size_t i = 1; i <= total_keys; i++) {
+      if (i % sieve == 0) {
+        for_insert.push_back(i);
+      } else {
+        for_delete.push_back(i);
+      }
     }
-  }
 
-  // Insert all the keys, including the ones that will remain at the end and
-  // the ones that are going to be removed next.
-  for (size_t i = 0; i < total_keys / 2; i++) {
-    int64_t insert_key = for_insert[i];
-    int64_t insert_value = insert_key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(insert_key >> 32), insert_value);
-    index_key.SetFromInteger(insert_key);
-    tree.Insert(index_key, rid, transaction);
-
-    int64_t delete_key = for_delete[i];
-    int64_t delete_value = delete_key & 0xFFFFFFFF;
-    rid.Set(static_cast<int32_t>(delete_key >> 32), delete_value);
-    index_key.SetFromInteger(delete_key);
-    tree.Insert(index_key, rid, transaction);
-  }
+    // Insert all the keys, including the ones that will remain at the end and
+    // the ones that are going to be removed next.
+    for (size_t i = 0; i < total_keys / 2; i++) {
+      int64_t insert_key = for_insert[i];
+      int64_t insert_value = insert_key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(insert_key >> 32), insert_value);
+      index_key.SetFromInteger(insert_key);
+      tree.Insert(index_key, rid, transaction);
+
+      int64_t delete_key = for_delete[i];
+      int64_t delete_value = delete_key & 0xFFFFFFFF;
+      rid.Set(static_cast<int32_t>(delete_key >> 32), delete_value);
+      index_key.SetFromInteger(delete_key);
+      tree.Insert(index_key, rid, transaction);
+    }
 
-  // Remove the keys in for_delete
-  for (auto key : for_delete) {
-    index_key.SetFromInteger(key);
-    tree.Remove(index_key, transaction);
-  }
+    // Remove the keys in for_delete
+    for (auto key : for_delete) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
 
-  // Only half of the keys should remain
-  int64_t start_key = 2;
-  int64_t size = 0;
-  index_key.SetFromInteger(start_key);
-  for (auto pair : tree) {
-    EXPECT_EQ((pair.first).ToString(), for_insert[size]);
-    size++;
-  }
+    // Only half of the keys should remain
+    int64_t start_key = 2;
+    int64_t size = 0;
+    index_key.SetFromInteger(start_key);
+    for (auto pair : tree) {
+      EXPECT_EQ((pair.first).ToString(), for_insert[size]);
+      size++;
+    }
 
-  EXPECT_EQ(size, for_insert.size());
+    EXPECT_EQ(size, for_insert.size());
 
-  bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete key_schema;
-  delete transaction;
-  delete disk_manager;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete key_schema;
+    delete transaction;
+  }
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -166,42 +166,44 @@ void BPlusTreeBenchmarkCall() {
     DiskManager *disk_manager = new DiskManager("test.db");
     BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
     // create b+ tree
-    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
-    // create and fetch header_page
-    page_id_t page_id;
-    auto header_page = bpm->NewPage(&page_id);
-    (void)header_page;
-
-    // start counting time for insertion, deletion and point look up
-    auto start = std::chrono::high_resolution_clock::now();
-
-    size_t txn_start_id = 0;
-    // insert all the keys
-    LaunchParallelTest(num_threads, txn_start_id, InsertHelperSplit, &tree, insert_keys, num_threads);
-    txn_start_id += num_threads;
-    // delete all even keys
-    LaunchParallelTest(num_threads, txn_start_id, DeleteHelperSplit, &tree, delete_keys, num_threads);
-    txn_start_id += num_threads;
-    // lookup all odd keys
-    LookupHelper(&tree, remain_keys, txn_start_id);
-    // iterate through all the keys in BPlusTree
-    size_t size = 0;
-    for (auto &pair : tree) {
-      if ((pair.first).ToString() % sieve == 1) {
-        size++;
-      } else {
-        success = false;
-        break;
+    {
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // start counting time for insertion, deletion and point look up
+      auto start = std::chrono::high_resolution_clock::now();
+
+      size_t txn_start_id = 0;
+      // insert all the keys
+      LaunchParallelTest(num_threads, txn_start_id, InsertHelperSplit, &tree, insert_keys, num_threads);
+      txn_start_id += num_threads;
+      // delete all even keys
+      LaunchParallelTest(num_threads, txn_start_id, DeleteHelperSplit, &tree, delete_keys, num_threads);
+      txn_start_id += num_threads;
+      // lookup all odd keys
+      LookupHelper(&tree, remain_keys, txn_start_id);
+      // iterate through all the keys in BPlusTree
+      size_t size = 0;
+      for (auto &pair : tree) {
+        if ((pair.first).ToString() % sieve == 1) {
+          size++;
+        } else {
+          success = false;
+          break;
+        }
       }
-    }
-    // Get End time and add to running total
-    auto end = std::chrono::high_resolution_clock::now();
-    time_total += std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+      // Get End time and add to running total
+      auto end = std::chrono::high_resolution_clock::now();
+      time_total += std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
 
-    bpm->UnpinPage(HEADER_PAGE_ID, true);
-    delete key_schema;
-    delete disk_manager;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete key_schema;
+    }
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -0,0 +1,889 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/free_space_map.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/table_scan_cursor.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  FreeSpaceMap free_space_map;
+  EXPECT_EQ(INVALID_PAGE_ID, free_space_map.FindPage(10));
+
+  // enough pages to grow the tree a few times, page i has room for i * 16 bytes
+  for (page_id_t page_id = 0; page_id < 100; page_id++) {
+    free_space_map.Update(page_id, page_id * FSM_CATEGORY_SIZE);
+  }
+  EXPECT_EQ(100, free_space_map.GetNumPages());
+  EXPECT_EQ(1, free_space_map.FindPage(1));
+  EXPECT_EQ(50, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+  // the room of a page is rounded down, the room of a tuple up
+  EXPECT_EQ(51, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE + 1));
+  EXPECT_EQ(INVALID_PAGE_ID, free_space_map.FindPage(100 * FSM_CATEGORY_SIZE));
+
+  // a page that filled up is skipped, a page that was emptied is found first
+  free_space_map.Update(50, 0);
+  EXPECT_EQ(51, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+  free_space_map.Update(3, PAGE_SIZE);
+  EXPECT_EQ(3, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+  EXPECT_EQ(100, free_space_map.GetNumPages());
+
+  // a claimed page is hidden from other inserts until it is released
+  EXPECT_EQ(3, free_space_map.Claim(50 * FSM_CATEGORY_SIZE));
+  EXPECT_EQ(51, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+  EXPECT_EQ(51, free_space_map.Claim(50 * FSM_CATEGORY_SIZE));
+  free_space_map.Update(3, PAGE_SIZE / 2);
+  EXPECT_EQ(52, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+  free_space_map.Release(3);
+  EXPECT_EQ(3, free_space_map.FindPage(50 * FSM_CATEGORY_SIZE));
+
+  free_space_map.AddClaimed(100, PAGE_SIZE);
+  EXPECT_EQ(INVALID_PAGE_ID, free_space_map.FindPage(PAGE_SIZE - FSM_CATEGORY_SIZE));
+  free_space_map.Release(100);
+  EXPECT_EQ(100, free_space_map.FindPage(PAGE_SIZE - FSM_CATEGORY_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ReuseFreeSpaceTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 256)});
+  Tuple large({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue(std::string(200, 'x'))}, &schema);
+  Tuple small({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue("x")}, &schema);
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(large, &rid, txn));
+    rids.push_back(rid);
+  }
+  page_id_t first_page_id = table->GetFirstPageId();
+  EXPECT_NE(first_page_id, rids.back().GetPageId());
+
+  // shrinking the tuples of the first page makes room there again
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == first_page_id) {
+      ASSERT_TRUE(table->UpdateTuple(small, rid, txn));
+    }
+  }
+  // once the page the thread inserts into is full, it goes back to the first page
+  RID rid;
+  page_id_t target_page_id = rids.back().GetPageId();
+  do {
+    ASSERT_TRUE(table->InsertTuple(large, &rid, txn));
+  } while (rid.GetPageId() == target_page_id);
+  EXPECT_EQ(first_page_id, rid.GetPageId());
+
+  // an opened table learns its pages on the first insert
+  auto *opened_table = new TableHeap(bpm, lock_manager, nullptr, first_page_id);
+  ASSERT_TRUE(opened_table->InsertTuple(large, &rid, txn));
+  EXPECT_EQ(first_page_id, rid.GetPageId());
+  delete opened_table;
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, BulkInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT)});
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(Tuple({ValueFactory::GetIntegerValue(-1), ValueFactory::GetBigIntValue(-1)}, &schema),
+                                 &rid, txn));
+
+  const int num_tuples = 5000;
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < num_tuples; i++) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(i)}, &schema);
+  }
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->BulkInsert(tuples, &rids, txn));
+  ASSERT_EQ(num_tuples, rids.size());
+
+  // the batch fills the rest of the first page, then every page it appends
+  EXPECT_EQ(rid.GetPageId(), rids[0].GetPageId());
+  EXPECT_EQ(rid.GetSlotNum() + 1, rids[0].GetSlotNum());
+  size_t num_pages = 1;
+  for (int i = 1; i < num_tuples; i++) {
+    if (rids[i].GetPageId() == rids[i - 1].GetPageId()) {
+      EXPECT_EQ(rids[i - 1].GetSlotNum() + 1, rids[i].GetSlotNum());
+    } else {
+      EXPECT_EQ(0, rids[i].GetSlotNum());
+      num_pages++;
+    }
+  }
+  const size_t tuple_space = tuples[0].GetLength() + 8;
+  EXPECT_EQ((num_tuples + 1) * tuple_space / (PAGE_SIZE - 24) + 1, num_pages);
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(i, tuple.GetValue(&schema, 1).GetAs<int64_t>());
+  }
+
+  // a tuple that fits no page fails the whole batch
+  Schema wide_schema({Column("a", TypeId::VARCHAR, PAGE_SIZE)});
+  std::vector<Tuple> too_large{tuples[0], Tuple({ValueFactory::GetVarcharValue(std::string(PAGE_SIZE, 'x'))},
+                                                &wide_schema)};
+  rids.clear();
+  EXPECT_FALSE(table->BulkInsert(too_large, &rids, txn));
+  EXPECT_TRUE(rids.empty());
+
+  // single inserts go on after the batch
+  ASSERT_TRUE(table->InsertTuple(tuples[0], &rid, txn));
+  size_t scanned = 0;
+  for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+    scanned++;
+  }
+  EXPECT_EQ(num_tuples + 2, scanned);
+
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, VacuumTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 256)});
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    tuples.emplace_back(
+        std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(200, 'x'))},
+        &schema);
+  }
+  std::vector<RID> rids;
+  ASSERT_TRUE(table->BulkInsert(tuples, &rids, txn));
+  std::vector<page_id_t> page_ids;
+  for (const auto &rid : rids) {
+    if (page_ids.empty() || page_ids.back() != rid.GetPageId()) {
+      page_ids.push_back(rid.GetPageId());
+    }
+  }
+  ASSERT_GE(page_ids.size(), 5);
+
+  // empty the first page and the third and fourth ones, and drop the last tuple of the second one
+  auto is_deleted = [&](const RID &rid) {
+    return rid.GetPageId() == page_ids[0] || rid.GetPageId() == page_ids[2] || rid.GetPageId() == page_ids[3];
+  };
+  std::vector<RID> deleted;
+  RID last_of_second;
+  for (const auto &rid : rids) {
+    if (is_deleted(rid)) {
+      deleted.push_back(rid);
+    }
+    if (rid.GetPageId() == page_ids[1]) {
+      last_of_second = rid;
+    }
+  }
+  deleted.push_back(last_of_second);
+  for (const auto &rid : deleted) {
+    ASSERT_TRUE(lock_manager->LockExclusive(txn, rid));
+  }
+  for (const auto &rid : deleted) {
+    table->ApplyDelete(rid, txn);
+  }
+
+  // the first page stays even though it is empty
+  EXPECT_EQ(2, table->Vacuum());
+  EXPECT_EQ(0, table->Vacuum());
+  std::vector<page_id_t> linked_page_ids;
+  for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+    linked_page_ids.push_back(page_id);
+    auto page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    page_id_t next_page_id = page->GetNextPageId();
+    if (next_page_id != INVALID_PAGE_ID) {
+      auto next_page = static_cast<TablePage *>(bpm->FetchPage(next_page_id));
+      EXPECT_EQ(page_id, next_page->GetPrevPageId());
+      bpm->UnpinPage(next_page_id, false);
+    }
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  EXPECT_EQ(page_ids.size() - 2, linked_page_ids.size());
+  EXPECT_EQ(linked_page_ids.end(), std::find(linked_page_ids.begin(), linked_page_ids.end(), page_ids[2]));
+  EXPECT_EQ(linked_page_ids.end(), std::find(linked_page_ids.begin(), linked_page_ids.end(), page_ids[3]));
+
+  // the other tuples keep their rids
+  size_t scanned = 0;
+  for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+    EXPECT_FALSE(is_deleted(iter->GetRid()));
+    scanned++;
+  }
+  EXPECT_EQ(rids.size() - deleted.size(), scanned);
+  for (size_t i = 0; i < rids.size(); i++) {
+    Tuple tuple;
+    if (is_deleted(rids[i]) || rids[i] == last_of_second) {
+      EXPECT_FALSE(table->GetTuple(rids[i], &tuple, txn));
+      continue;
+    }
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    EXPECT_EQ(static_cast<int32_t>(i), tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+
+  // inserts fill the emptied first page, the freed pages are gone for good
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(tuples[0], &rid, txn));
+  EXPECT_EQ(page_ids[0], rid.GetPageId());
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(table->InsertTuple(tuples[0], &rid, txn));
+    EXPECT_NE(page_ids[2], rid.GetPageId());
+    EXPECT_NE(page_ids[3], rid.GetPageId());
+  }
+
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, PaxTableTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 64), Column("c", TypeId::BIGINT)});
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn, TableFormat::PAX, &schema);
+  EXPECT_EQ(TableFormat::PAX, table->GetFormat());
+
+  auto make_tuple = [&](int i, size_t length) {
+    return Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(length, 'a' + i % 26)),
+                  ValueFactory::GetBigIntValue(i * 10)},
+                 &schema);
+  };
+  auto check_tuple = [&](const Tuple &tuple, int i, size_t length) {
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(std::string(length, 'a' + i % 26), tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(i * 10, tuple.GetValue(&schema, 2).GetAs<int64_t>());
+  };
+
+  // strings of every length up to twice the room set aside for them, across many pages
+  const int num_tuples = 1000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, i % 64), &rid, txn));
+    rids.push_back(rid);
+  }
+  std::vector<Tuple> batch;
+  for (int i = num_tuples; i < 2 * num_tuples; i++) {
+    batch.push_back(make_tuple(i, i % 64));
+  }
+  ASSERT_TRUE(table->BulkInsert(batch, &rids, txn));
+  for (int i = 0; i < 2 * num_tuples; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    check_tuple(tuple, i, i % 64);
+  }
+
+  // the columns are read straight from the minipages
+  auto page = static_cast<PaxPage *>(bpm->FetchPage(rids[0].GetPageId()));
+  EXPECT_EQ(PaxPage::ComputeCapacity(schema), page->GetCapacity());
+  EXPECT_EQ(3, page->GetColumnCount());
+  for (uint32_t slot_num = 0; slot_num < page->GetTupleCount(); slot_num++) {
+    ASSERT_TRUE(page->IsVisible(slot_num));
+    EXPECT_EQ(slot_num, reinterpret_cast<const int32_t *>(page->GetColumnData(0))[slot_num]);
+    EXPECT_EQ(slot_num * 10, page->GetValue(&schema, slot_num, 2).GetAs<int64_t>());
+    EXPECT_EQ(std::string(slot_num % 64, 'a' + slot_num % 26), page->GetValue(&schema, slot_num, 1).ToString());
+  }
+  bpm->UnpinPage(rids[0].GetPageId(), false);
+
+  // a filtered cursor reads the column of the filter and the requested columns only
+  {
+    std::vector<int32_t> expected;
+    for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+      int32_t a = iter->GetValue(&schema, 0).GetAs<int32_t>();
+      if (a % 7 == 0) {
+        expected.push_back(a);
+      }
+    }
+    std::vector<int32_t> scanned;
+    TableScanCursor cursor(table, txn, &schema);
+    cursor.SetFilter(0, [](const Value &value) { return value.GetAs<int32_t>() % 7 == 0; });
+    std::vector<Value> values;
+    while (cursor.Next()) {
+      ASSERT_TRUE(cursor.GetValues({2, 0}, &values));
+      ASSERT_EQ(2, values.size());
+      scanned.push_back(values[1].GetAs<int32_t>());
+      EXPECT_EQ(scanned.back() * 10, values[0].GetAs<int64_t>());
+    }
+    EXPECT_EQ((2 * num_tuples + 6) / 7, expected.size());
+    EXPECT_EQ(expected, scanned);
+  }
+
+  // growing and shrinking the strings moves the other payloads of the page
+  for (int i = 0; i < num_tuples; i += 2) {
+    ASSERT_TRUE(table->UpdateTuple(make_tuple(i, 5), rids[i], txn));
+  }
+  for (int i = 1; i < num_tuples; i += 2) {
+    if (table->UpdateTuple(make_tuple(i, 60), rids[i], txn)) {
+      Tuple tuple;
+      ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+      check_tuple(tuple, i, 60);
+    }
+  }
+  for (int i = 0; i < num_tuples; i += 2) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    check_tuple(tuple, i, 5);
+  }
+
+  // delete the bulk loaded tuples, vacuum frees their pages
+  std::vector<RID> deleted;
+  for (int i = num_tuples; i < 2 * num_tuples; i++) {
+    if (rids[i].GetPageId() != rids[num_tuples - 1].GetPageId()) {
+      deleted.push_back(rids[i]);
+      ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+    }
+  }
+  for (const auto &rid : deleted) {
+    ASSERT_TRUE(lock_manager->LockExclusive(txn, rid));
+  }
+  for (const auto &rid : deleted) {
+    table->ApplyDelete(rid, txn);
+  }
+  EXPECT_GT(table->Vacuum(), 0);
+
+  // an opened table appends pages of the same layout
+  auto *opened_table = new TableHeap(bpm, lock_manager, nullptr, table->GetFirstPageId(), TableFormat::PAX);
+  RID rid;
+  for (int i = 0; i < 200; i++) {
+    ASSERT_TRUE(opened_table->InsertTuple(make_tuple(i, 64), &rid, txn));
+  }
+  Tuple tuple;
+  ASSERT_TRUE(opened_table->GetTuple(rid, &tuple, txn));
+  check_tuple(tuple, 199, 64);
+  size_t scanned = 0;
+  for (auto iter = opened_table->Begin(txn); iter != opened_table->End(); ++iter) {
+    scanned++;
+  }
+  EXPECT_EQ(2 * num_tuples - deleted.size() + 200, scanned);
+
+  delete opened_table;
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, CompressedTableTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::BIGINT),
+                 Column("d", TypeId::DECIMAL), Column("e", TypeId::BOOLEAN)});
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn, TableFormat::COMPRESSED, &schema);
+  auto *row_table = new TableHeap(bpm, lock_manager, nullptr, txn, TableFormat::ROW, &schema);
+  EXPECT_EQ(TableFormat::COMPRESSED, table->GetFormat());
+
+  // a few distinct strings, long runs in c, and a null now and then in a
+  const std::vector<std::string> colors = {"red", "green", "blue"};
+  auto make_tuple = [&](int i) {
+    return Tuple({i % 10 == 9 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+                  ValueFactory::GetVarcharValue(colors[i % 3]), ValueFactory::GetBigIntValue(1000000 + i / 100),
+                  ValueFactory::GetDecimalValue(i * 0.5), ValueFactory::GetBooleanValue(i % 2 == 0)},
+                 &schema);
+  };
+  auto check_tuple = [&](const Tuple &tuple, int i) {
+    if (i % 10 == 9) {
+      EXPECT_TRUE(tuple.IsNull(&schema, 0));
+    } else {
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    EXPECT_EQ(colors[i % 3], tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(1000000 + i / 100, tuple.GetValue(&schema, 2).GetAs<int64_t>());
+    EXPECT_EQ(i * 0.5, tuple.GetValue(&schema, 3).GetAs<double>());
+    EXPECT_EQ(i % 2 == 0, tuple.GetValue(&schema, 4).GetAs<int8_t>() != 0);
+  };
+
+  const int num_tuples = 2000;
+  std::vector<RID> rids;
+  std::unordered_set<page_id_t> pages;
+  std::unordered_set<page_id_t> row_pages;
+  for (int i = 0; i < num_tuples; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, txn));
+    rids.push_back(rid);
+    pages.insert(rid.GetPageId());
+    ASSERT_TRUE(row_table->InsertTuple(make_tuple(i), &rid, txn));
+    row_pages.insert(rid.GetPageId());
+  }
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    check_tuple(tuple, i);
+  }
+  // the same tuples in far fewer pages
+  EXPECT_LT(pages.size() * 2, row_pages.size());
+
+  // each column gets its encoding, and is read without assembling the tuple
+  auto page = static_cast<CompressedPage *>(bpm->FetchPage(rids[0].GetPageId()));
+  EXPECT_EQ(5, page->GetColumnCount());
+  EXPECT_EQ(ColumnEncoding::FRAME_OF_REFERENCE, page->GetColumnEncoding(0));
+  EXPECT_EQ(ColumnEncoding::DICTIONARY, page->GetColumnEncoding(1));
+  EXPECT_EQ(CodeLayout::PACKED, page->GetCodeLayout(1));
+  EXPECT_EQ(ColumnEncoding::FRAME_OF_REFERENCE, page->GetColumnEncoding(2));
+  EXPECT_EQ(CodeLayout::RUNS, page->GetCodeLayout(2));
+  EXPECT_EQ(ColumnEncoding::PLAIN, page->GetColumnEncoding(3));
+  uint32_t tuple_count = page->GetTupleCount();
+  for (uint32_t slot_num = 0; slot_num < tuple_count; slot_num++) {
+    EXPECT_EQ(colors[slot_num % 3], page->GetValue(slot_num, 1).ToString());
+    EXPECT_EQ(1000000 + slot_num / 100, page->GetValue(slot_num, 2).GetAs<int64_t>());
+  }
+
+  // predicates on the encoded columns
+  std::vector<bool> matches;
+  page->MatchColumn(1, [](const Value &value) { return value.ToString() == "green"; }, &matches);
+  ASSERT_EQ(tuple_count, matches.size());
+  for (uint32_t slot_num = 0; slot_num < tuple_count; slot_num++) {
+    EXPECT_EQ(slot_num % 3 == 1, matches[slot_num]);
+  }
+  page->MatchColumn(
+      2, [](const Value &value) { return value.GetAs<int64_t>() >= 1000001; }, &matches);
+  for (uint32_t slot_num = 0; slot_num < tuple_count; slot_num++) {
+    EXPECT_EQ(slot_num >= 100, matches[slot_num]);
+  }
+  page->MatchColumn(
+      0, [](const Value &value) { return !value.IsNull() && value.GetAs<int32_t>() < 50; }, &matches);
+  for (uint32_t slot_num = 0; slot_num < tuple_count; slot_num++) {
+    EXPECT_EQ(slot_num % 10 != 9 && slot_num < 50, matches[slot_num]);
+  }
+  bpm->UnpinPage(rids[0].GetPageId(), false);
+
+  // deleted tuples are neither read nor matched, vacuum encodes the pages without them
+  std::vector<RID> deleted;
+  for (int i = 0; i < num_tuples; i += 4) {
+    deleted.push_back(rids[i]);
+    ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+  }
+  for (const auto &rid : deleted) {
+    ASSERT_TRUE(lock_manager->LockExclusive(txn, rid));
+  }
+  for (const auto &rid : deleted) {
+    table->ApplyDelete(rid, txn);
+  }
+  table->Vacuum();
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple;
+    ASSERT_EQ(i % 4 != 0, table->GetTuple(rids[i], &tuple, txn));
+    if (i % 4 != 0) {
+      check_tuple(tuple, i);
+    }
+  }
+  page = static_cast<CompressedPage *>(bpm->FetchPage(rids[1].GetPageId()));
+  page->MatchColumn(4, [](const Value &value) { return value.GetAs<int8_t>() != 0; }, &matches);
+  for (uint32_t slot_num = 0; slot_num < page->GetTupleCount(); slot_num++) {
+    EXPECT_EQ(slot_num % 2 == 0 && slot_num % 4 != 0, matches[slot_num]);
+  }
+  bpm->UnpinPage(rids[1].GetPageId(), false);
+
+  // an update with a new string re-encodes the page
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(num_tuples + 3), rids[3], txn));
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[3], &tuple, txn));
+  check_tuple(tuple, num_tuples + 3);
+  ASSERT_TRUE(table->GetTuple(rids[5], &tuple, txn));
+  check_tuple(tuple, 5);
+
+  // a bulk load fills the pages as densely as the inserts
+  std::vector<Tuple> batch;
+  for (int i = 0; i < num_tuples; i++) {
+    batch.push_back(make_tuple(i));
+  }
+  std::vector<RID> batch_rids;
+  ASSERT_TRUE(table->BulkInsert(batch, &batch_rids, txn));
+  std::unordered_set<page_id_t> batch_pages;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(table->GetTuple(batch_rids[i], &tuple, txn));
+    check_tuple(tuple, i);
+    batch_pages.insert(batch_rids[i].GetPageId());
+  }
+  EXPECT_LE(batch_pages.size(), pages.size() + 1);
+
+  // an opened table appends pages of the same column types
+  auto *opened_table = new TableHeap(bpm, lock_manager, nullptr, table->GetFirstPageId(), TableFormat::COMPRESSED);
+  RID rid;
+  for (int i = 0; i < 500; i++) {
+    ASSERT_TRUE(opened_table->InsertTuple(make_tuple(i), &rid, txn));
+  }
+  ASSERT_TRUE(opened_table->GetTuple(rid, &tuple, txn));
+  check_tuple(tuple, 499);
+
+  // a filtered scan only visits the matching tuples
+  size_t expected = 0;
+  for (auto iter = opened_table->Begin(txn); iter != opened_table->End(); ++iter) {
+    expected += iter->GetValue(&schema, 1).ToString() == "blue" ? 1 : 0;
+  }
+  size_t scanned = 0;
+  {
+    TableScanCursor cursor(opened_table, txn);
+    cursor.SetFilter(1, [](const Value &value) { return value.ToString() == "blue"; });
+    while (cursor.Next()) {
+      ASSERT_TRUE(cursor.View([&](const Tuple &view) { EXPECT_EQ("blue", view.GetValue(&schema, 1).ToString()); }));
+      scanned++;
+    }
+  }
+  EXPECT_GT(expected, 0);
+  EXPECT_EQ(expected, scanned);
+
+  // a tuple that fits in a page but not encoded in an empty one is rejected
+  Transaction large_txn(1);
+  Schema large_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, PAGE_SIZE)});
+  auto *large_table = new TableHeap(bpm, lock_manager, nullptr, &large_txn, TableFormat::COMPRESSED, &large_schema);
+  Tuple large_tuple({ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue(std::string(PAGE_SIZE - 64, 'x'))},
+                    &large_schema);
+  EXPECT_FALSE(large_table->InsertTuple(large_tuple, &rid, &large_txn));
+  std::vector<RID> large_rids;
+  EXPECT_FALSE(large_table->BulkInsert({large_tuple}, &large_rids, &large_txn));
+  EXPECT_TRUE(large_rids.empty());
+
+  delete large_table;
+  delete opened_table;
+  delete row_table;
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ViewTupleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+
+  for (auto format : {TableFormat::ROW, TableFormat::PAX, TableFormat::COMPRESSED}) {
+    auto *table = new TableHeap(bpm, lock_manager, nullptr, txn, format, &schema);
+    std::vector<RID> rids;
+    for (int i = 0; i < 500; i++) {
+      RID rid;
+      ASSERT_TRUE(table->InsertTuple(
+          Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i))}, &schema), &rid,
+          txn));
+      rids.push_back(rid);
+    }
+
+    // the iterator walks the rids without reading the tuples
+    size_t i = 0;
+    for (auto iter = table->Begin(txn); iter != table->End(); ++iter, ++i) {
+      ASSERT_EQ(rids[i], iter.GetRid());
+      bool viewed = table->ViewTuple(iter.GetRid(), txn, [&](const Tuple &view) {
+        // a row tuple is read in place, a PAX one is gathered from the minipages and a compressed one decoded
+        EXPECT_EQ(format != TableFormat::ROW, const_cast<Tuple &>(view).IsAllocated());
+        EXPECT_EQ(static_cast<int32_t>(i), view.GetValue(&schema, 0).GetAs<int32_t>());
+        EXPECT_EQ(std::to_string(i), view.GetValue(&schema, 1).ToString());
+      });
+      ASSERT_TRUE(viewed);
+      EXPECT_EQ(static_cast<int32_t>(i), iter->GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    EXPECT_EQ(rids.size(), i);
+
+    ASSERT_TRUE(table->MarkDelete(rids[0], txn));
+    EXPECT_FALSE(table->ViewTuple(rids[0], txn, [](const Tuple &view) { FAIL(); }));
+    delete table;
+  }
+
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ScanCursorTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+
+  for (auto format : {TableFormat::ROW, TableFormat::PAX, TableFormat::COMPRESSED}) {
+    auto *table = new TableHeap(bpm, lock_manager, nullptr, txn, format, &schema);
+    std::vector<RID> rids;
+    for (int i = 0; i < 1000; i++) {
+      RID rid;
+      ASSERT_TRUE(table->InsertTuple(
+          Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i))}, &schema), &rid,
+          txn));
+      rids.push_back(rid);
+    }
+    // the tuples of the second page and every third tuple are gone
+    page_id_t second_page_id = rids[0].GetPageId();
+    for (const auto &rid : rids) {
+      if (rid.GetPageId() != rids[0].GetPageId()) {
+        second_page_id = rid.GetPageId();
+        break;
+      }
+    }
+    std::vector<int> expected;
+    for (size_t i = 0; i < rids.size(); i++) {
+      if (rids[i].GetPageId() == second_page_id || i % 3 == 0) {
+        ASSERT_TRUE(table->MarkDelete(rids[i], txn));
+      } else {
+        expected.push_back(static_cast<int>(i));
+      }
+    }
+
+    std::vector<int> scanned;
+    {
+      TableScanCursor cursor(table, txn);
+      while (cursor.Next()) {
+        ASSERT_TRUE(cursor.View([&](const Tuple &tuple) {
+          scanned.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+          EXPECT_EQ(rids[scanned.back()], cursor.GetRid());
+        }));
+      }
+      EXPECT_EQ(RID(INVALID_PAGE_ID, 0), cursor.GetRid());
+      EXPECT_FALSE(cursor.Next());
+    }
+    EXPECT_EQ(expected, scanned);
+
+    // a cursor dropped in the middle of the scan gives its page back
+    {
+      TableScanCursor cursor(table, txn);
+      ASSERT_TRUE(cursor.Next());
+    }
+    for (const auto &rid : {rids.front(), rids.back()}) {
+      auto page = bpm->FetchPage(rid.GetPageId());
+      EXPECT_EQ(1, page->GetPinCount());
+      bpm->UnpinPage(rid.GetPageId(), false);
+    }
+    delete table;
+  }
+
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, OverflowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *txn = new Transaction(0);
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::VARCHAR, 16)});
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, txn, TableFormat::ROW, &schema);
+  auto make_tuple = [&](int i, const std::string &b, const std::string &c) {
+    return Tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(b),
+                  ValueFactory::GetVarcharValue(c)},
+                 &schema);
+  };
+  // several pages worth of value, and one just over the threshold
+  std::string large(5 * PAGE_SIZE + 123, 'x');
+  for (size_t i = 0; i < large.size(); i++) {
+    large[i] = static_cast<char>('a' + i % 26);
+  }
+  std::string medium(TOAST_TUPLE_THRESHOLD, 'm');
+
+  std::vector<RID> rids;
+  for (int i = 0; i < 20; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, i % 2 == 0 ? large : "small", medium), &rid, txn));
+    rids.push_back(rid);
+  }
+  std::vector<Tuple> batch;
+  for (int i = 20; i < 30; i++) {
+    batch.push_back(make_tuple(i, large, "small"));
+  }
+  ASSERT_TRUE(table->BulkInsert(batch, &rids, txn));
+
+  for (size_t i = 0; i < rids.size(); i++) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, txn));
+    // the large values are not in the tuple, they are read from the overflow pages when asked for
+    EXPECT_LE(tuple.GetLength(), static_cast<uint32_t>(TOAST_TUPLE_THRESHOLD));
+    EXPECT_EQ(static_cast<int32_t>(i), tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    bool is_large = i >= 20 || i % 2 == 0;
+    EXPECT_EQ(is_large ? large : "small", tuple.GetValue(&schema, 1).ToString());
+    EXPECT_EQ(i < 20 ? medium : "small", tuple.GetValue(&schema, 2).ToString());
+  }
+
+  // the tuple gets new overflow pages
+  std::string updated(2 * PAGE_SIZE, 'u');
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(0, updated, "small"), rids[0], txn));
+  size_t scanned = 0;
+  {
+    TableScanCursor cursor(table, txn);
+    while (cursor.Next()) {
+      ASSERT_TRUE(cursor.View([&](const Tuple &tuple) {
+        if (cursor.GetRid() == rids[0]) {
+          EXPECT_EQ(updated, tuple.GetValue(&schema, 1).ToString());
+        } else if (cursor.GetRid() == rids[2]) {
+          EXPECT_EQ(large, tuple.GetValue(&schema, 1).ToString());
+        }
+      }));
+      scanned++;
+    }
+  }
+  EXPECT_EQ(rids.size(), scanned);
+
+  // deleting the tuples frees their overflow pages
+  for (const auto &rid : rids) {
+    lock_manager->LockExclusive(txn, rid);
+  }
+  for (const auto &rid : rids) {
+    ASSERT_TRUE(table->MarkDelete(rid, txn));
+    table->ApplyDelete(rid, txn);
+  }
+  for (int i = 0; i < 20; i++) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, large, "small"), &rid, txn));
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rid, &tuple, txn));
+    EXPECT_EQ(large, tuple.GetValue(&schema, 1).ToString());
+  }
+
+  // a copy of a tuple still reads its values from the table
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(table->Begin(txn).GetRid(), &tuple, txn));
+  Tuple copy(tuple);
+  EXPECT_EQ(large, copy.GetValue(&schema, 1).ToString());
+
+  // an opened table moves and frees large values like the one that created it
+  Transaction opened_txn(1);
+  auto *opened_table = new TableHeap(bpm, lock_manager, nullptr, table->GetFirstPageId(), TableFormat::ROW, &schema);
+  RID opened_rid;
+  ASSERT_TRUE(opened_table->InsertTuple(make_tuple(30, large, "small"), &opened_rid, &opened_txn));
+  Tuple opened_tuple;
+  ASSERT_TRUE(opened_table->GetTuple(opened_rid, &opened_tuple, &opened_txn));
+  EXPECT_LE(opened_tuple.GetLength(), static_cast<uint32_t>(TOAST_TUPLE_THRESHOLD));
+  EXPECT_EQ(large, opened_tuple.GetValue(&schema, 1).ToString());
+  lock_manager->LockExclusive(&opened_txn, opened_rid);
+  ASSERT_TRUE(opened_table->MarkDelete(opened_rid, &opened_txn));
+  opened_table->ApplyDelete(opened_rid, &opened_txn);
+  delete opened_table;
+
+  delete table;
+  delete txn;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ConcurrentInsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  Transaction create_txn(0);
+  auto *table = new TableHeap(bpm, lock_manager, nullptr, &create_txn);
+
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT)});
+  const int num_threads = 4;
+  const int per_thread = 2000;
+  std::vector<std::vector<RID>> rids(num_threads);
+  std::vector<std::thread> threads;
+  for (int thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    threads.emplace_back([&, thread_itr]() {
+      Transaction txn(thread_itr + 1);
+      for (int i = 0; i < per_thread; i++) {
+        Tuple tuple({ValueFactory::GetIntegerValue(thread_itr), ValueFactory::GetBigIntValue(i)}, &schema);
+        RID rid;
+        EXPECT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+        rids[thread_itr].push_back(rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every thread filled its own pages
+  std::unordered_set<int64_t> seen;
+  std::unordered_map<page_id_t, int> page_owners;
+  for (int thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+    for (int i = 0; i < per_thread; i++) {
+      const RID &rid = rids[thread_itr][i];
+      EXPECT_TRUE(seen.insert(rid.Get()).second);
+      EXPECT_EQ(thread_itr, page_owners.emplace(rid.GetPageId(), thread_itr).first->second);
+      Tuple tuple;
+      ASSERT_TRUE(table->GetTuple(rid, &tuple, &create_txn));
+      EXPECT_EQ(thread_itr, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(i, tuple.GetValue(&schema, 1).GetAs<int64_t>());
+    }
+  }
+  size_t scanned = 0;
+  for (auto iter = table->Begin(&create_txn); iter != table->End(); ++iter) {
+    scanned++;
+  }
+  EXPECT_EQ(num_threads * per_thread, scanned);
+
+  delete table;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -86,6 +86,65 @@ TEST(TypeTests, MinValueTest) {
   EXPECT_EQ(val1.CompareEquals(val2), CmpBool::CmpTrue);
 }
 
+// NOLINTNEXTLINE
+TEST(TypeTests, CompareTest) {
+  // the same type, mixed numeric types, and types compared by their Type
+  Value one(TypeId::INTEGER, 1);
+  Value two(TypeId::INTEGER, 2);
+  EXPECT_EQ(CmpBool::CmpTrue, one.CompareLessThan(two));
+  EXPECT_EQ(CmpBool::CmpFalse, one.CompareGreaterThanEquals(two));
+  EXPECT_EQ(CmpBool::CmpTrue, one.CompareNotEquals(two));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::BIGINT, int64_t{1}).CompareEquals(one));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::TINYINT, int8_t{3}).CompareGreaterThan(two));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::DECIMAL, 1.5).CompareLessThan(two));
+  EXPECT_EQ(CmpBool::CmpTrue, two.CompareGreaterThan(Value(TypeId::DECIMAL, 1.5)));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::TIMESTAMP, uint64_t{7}).CompareLessThanEquals(
+                                  Value(TypeId::TIMESTAMP, uint64_t{7})));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::BOOLEAN, int8_t{1}).CompareGreaterThan(Value(TypeId::BOOLEAN, int8_t{0})));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::VARCHAR, "32").CompareEquals(Value(TypeId::INTEGER, 32)));
+  // nulls
+  EXPECT_EQ(CmpBool::CmpNull, one.CompareEquals(Value(TypeId::INTEGER, BUSTUB_INT32_NULL)));
+  EXPECT_EQ(CmpBool::CmpNull, Value(TypeId::VARCHAR, nullptr, 0, false).CompareLessThan(Value(TypeId::VARCHAR, "a")));
+
+  // short and long strings
+  std::string long_prefix(100, 'x');
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::VARCHAR, "abc").CompareLessThan(Value(TypeId::VARCHAR, "abd")));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::VARCHAR, "ab").CompareLessThan(Value(TypeId::VARCHAR, "abc")));
+  EXPECT_EQ(CmpBool::CmpTrue,
+            Value(TypeId::VARCHAR, long_prefix + "b").CompareGreaterThan(Value(TypeId::VARCHAR, long_prefix + "a")));
+  EXPECT_EQ(CmpBool::CmpTrue, Value(TypeId::VARCHAR, "ab").CompareNotEquals(Value(TypeId::VARCHAR, long_prefix)));
+}
+
+// NOLINTNEXTLINE
+TEST(TypeTests, VarcharCopyTest) {
+  // a short string is copied with the value, a long one is shared by the copies
+  auto *short_value = new Value(TypeId::VARCHAR, "short");
+  auto *long_value = new Value(TypeId::VARCHAR, std::string(100, 'x'));
+  Value short_copy = *short_value;
+  Value long_copy = *long_value;
+  std::vector<Value> more_copies(10, *long_value);
+  EXPECT_NE(short_value->GetData(), short_copy.GetData());
+  EXPECT_EQ(long_value->GetData(), long_copy.GetData());
+  delete short_value;
+  delete long_value;
+  EXPECT_EQ("short", short_copy.ToString());
+  EXPECT_EQ(std::string(100, 'x'), long_copy.ToString());
+  more_copies.clear();
+  Value assigned(TypeId::VARCHAR, "other");
+  assigned = long_copy;
+  EXPECT_EQ(std::string(100, 'x'), assigned.ToString());
+
+  // a view borrows the data of the storage space, a deserialized value copies it
+  char storage[64];
+  Value(TypeId::VARCHAR, "serialized string").SerializeTo(storage);
+  Value view = Value::ViewFrom(storage, TypeId::VARCHAR);
+  Value deserialized = Value::DeserializeFrom(storage, TypeId::VARCHAR);
+  EXPECT_EQ(storage + sizeof(uint32_t), view.GetData());
+  EXPECT_NE(storage + sizeof(uint32_t), deserialized.GetData());
+  EXPECT_EQ(CmpBool::CmpTrue, view.CompareEquals(deserialized));
+  EXPECT_EQ(deserialized.GetLength(), view.GetLength());
+}
+
 // NOLINTNEXTLINE
 TEST(TypeTests, TemplateTest) {
   std::string temp = "32";